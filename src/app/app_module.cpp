@@ -24,6 +24,7 @@
 
 #include <QtCore/QDataStream>
 #include <QtCore/QDir>
+#include <QtCore/QStandardPaths>
 #include <QtCore/QtDebug>
 
 #include <fmt/format.h>
@@ -402,6 +403,44 @@ void AppModule::computeBRepMesh(const TDF_Label& labelEntity, TaskProgress* prog
         this->computeBRepMesh(XCaf::shape(labelEntity), progress);
 }
 
+void AppModule::computeBRepMesh(const TDF_Label& labelEntity, const FilePath& sourceFilepath, TaskProgress* progress)
+{
+    if (!XCaf::isShape(labelEntity))
+        return;
+
+    if (!m_props.meshingCacheEnabled.value() || sourceFilepath.empty()) {
+        this->computeBRepMesh(labelEntity, progress);
+        return;
+    }
+
+    const TopoDS_Shape shape = XCaf::shape(labelEntity);
+    const OccBRepMeshParameters params = this->brepMeshParameters(shape);
+    const std::string cacheKey = BRepMeshCache::key(sourceFilepath, params, shape);
+    {
+        std::lock_guard<std::mutex> lock(m_mutexBRepMeshCache);
+        if (m_brepMeshCache.directory().empty()) {
+            const QString dirCache = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+            m_brepMeshCache.setDirectory(filepathFrom(dirCache) / "brep_mesh");
+        }
+
+        m_brepMeshCache.setMaxSize(std::uintmax_t(m_props.meshingCacheMaxSize.value()) * 1024 * 1024);
+        m_brepMeshCache.setMaxAge(std::chrono::hours(24 * m_props.meshingCacheMaxAge.value()));
+        if (m_brepMeshCache.restore(cacheKey, shape)) {
+            if (progress)
+                progress->setValue(100);
+
+            return;
+        }
+    }
+
+    // Meshing isn't serialized, only accesses to the cache are
+    BRepUtils::computeMesh(shape, params, progress);
+    if (!TaskProgress::isAbortRequested(progress)) {
+        std::lock_guard<std::mutex> lock(m_mutexBRepMeshCache);
+        m_brepMeshCache.store(cacheKey, shape);
+    }
+}
+
 void AppModule::addPropertiesProvider(std::unique_ptr<DocumentTreeNodePropertiesProvider> ptr)
 {
     m_vecDocTreeNodePropsProvider.push_back(std::move(ptr));
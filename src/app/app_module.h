@@ -10,6 +10,7 @@
 #include "qstring_utils.h"
 
 #include "../base/application.h"
+#include "../base/brep_mesh_cache.h"
 #include "../base/document_tree_node_properties_provider.h"
 #include "../base/io_parameters_provider.h"
 #include "../base/io_system.h"
@@ -98,6 +99,11 @@ public:
     OccBRepMeshParameters brepMeshParameters(const TopoDS_Shape& shape) const;
     void computeBRepMesh(const TopoDS_Shape& shape, TaskProgress* progress = nullptr);
     void computeBRepMesh(const TDF_Label& labelEntity, TaskProgress* progress = nullptr);
+    // Same as computeBRepMesh(labelEntity) but reuses/stores meshes from the on-disk cache if enabled
+    // (see AppModuleProperties::meshingCacheEnabled, off by default)
+    // 'sourceFilepath' is the file from which 'labelEntity' was read
+    // Safe to call concurrently, accesses to the cache are serialized
+    void computeBRepMesh(const TDF_Label& labelEntity, const FilePath& sourceFilepath, TaskProgress* progress = nullptr);
 
     // Providers to query document tree node properties
     void addPropertiesProvider(std::unique_ptr<DocumentTreeNodePropertiesProvider> ptr);
@@ -129,6 +135,8 @@ private:
     Settings* m_settings = nullptr;
     IO::System m_ioSystem;
     AppModuleProperties m_props;
+    BRepMeshCache m_brepMeshCache;
+    std::mutex m_mutexBRepMeshCache;
     std::vector<Message> m_messageLog;
     std::mutex m_mutexMessageLog;
     std::locale m_stdLocale;
@@ -62,6 +62,15 @@ AppModuleProperties::AppModuleProperties(Settings* settings)
     settings->addSetting(&this->meshingChordalDeflection, groupId_meshing);
     settings->addSetting(&this->meshingAngularDeflection, groupId_meshing);
     settings->addSetting(&this->meshingRelative, groupId_meshing);
+    settings->addSetting(&this->meshingCacheEnabled, groupId_meshing);
+    settings->addSetting(&this->meshingCacheMaxSize, groupId_meshing);
+    settings->addSetting(&this->meshingCacheMaxAge, groupId_meshing);
+    this->meshingCacheMaxSize.setRange(1, 1024 * 1024);
+    this->meshingCacheMaxSize.setSingleStep(100);
+    this->meshingCacheMaxSize.setConstraintsEnabled(true);
+    this->meshingCacheMaxAge.setRange(1, 3650);
+    this->meshingCacheMaxAge.setSingleStep(1);
+    this->meshingCacheMaxAge.setConstraintsEnabled(true);
 
     // Graphics
     settings->addSetting(&this->navigationStyle, groupId_graphics);
@@ -108,6 +117,9 @@ AppModuleProperties::AppModuleProperties(Settings* settings)
         this->meshingChordalDeflection.setQuantity(1 * Quantity_Millimeter);
         this->meshingAngularDeflection.setQuantity(20 * Quantity_Degree);
         this->meshingRelative.setValue(false);
+        this->meshingCacheEnabled.setValue(false);
+        this->meshingCacheMaxSize.setValue(1024);
+        this->meshingCacheMaxAge.setValue(30);
     });
     settings->addResetFunction(sectionId_graphicsClipPlanes, [=]{
         this->clipPlanesCappingOn.setValue(true);
@@ -214,6 +226,19 @@ void AppModuleProperties::retranslate()
                  "`ChordalDeflection` &#215; `SizeOfEdge`. The deflection used for the faces will be "
                  "the maximum deflection of their edges.")
     );
+    this->meshingCacheEnabled.setDescription(
+        textIdTr("Store computed meshes of BRep shapes on disk, so opening again an unchanged file "
+                 "with the same meshing parameters doesn't require meshing\n\n"
+                 "Disabled by default. Cache files are written in the cache directory of the user. "
+                 "Not used by the command-line interface")
+    );
+    this->meshingCacheMaxSize.setDescription(
+        textIdTr("Maximum size(in MB) of the mesh cache on disk, least recently used entries are "
+                 "removed when exceeded")
+    );
+    this->meshingCacheMaxAge.setDescription(
+        textIdTr("Number of days after which unused entries of the mesh cache are removed")
+    );
 
     // Graphics
     this->navigationStyle.setDescription(
@@ -259,6 +284,10 @@ void AppModuleProperties::onPropertyChanged(Property* prop)
         this->meshingAngularDeflection.setEnabled(isUserDefined);
         this->meshingRelative.setEnabled(isUserDefined);
     }
+    else if (prop == &this->meshingCacheEnabled) {
+        this->meshingCacheMaxSize.setEnabled(this->meshingCacheEnabled.value());
+        this->meshingCacheMaxAge.setEnabled(this->meshingCacheEnabled.value());
+    }
 
     PropertyGroup::onPropertyChanged(prop);
 }
@@ -69,6 +69,10 @@ public:
     PropertyLength meshingChordalDeflection{ this, textId("meshingChordalDeflection") };
     PropertyAngle meshingAngularDeflection{ this, textId("meshingAngularDeflection") };
     PropertyBool meshingRelative{ this, textId("meshingRelative") };
+    // On-disk cache of BRep meshes, opt-in and used by the GUI only(see AppModule::computeBRepMesh())
+    PropertyBool meshingCacheEnabled{ this, textId("meshingCacheEnabled") };
+    PropertyInt meshingCacheMaxSize{ this, textId("meshingCacheMaxSize") };
+    PropertyInt meshingCacheMaxAge{ this, textId("meshingCacheMaxAge") };
     // Graphics
     const Settings::GroupIndex groupId_graphics;
     PropertyEnum<View3dNavigationStyle> navigationStyle{ this, textId("navigationStyle") };
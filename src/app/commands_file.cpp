@@ -192,8 +192,8 @@ void FileCommandTools::openDocumentsFromList(IAppContext* context, Span<const Fi
                         .targetDocument(app->findDocumentByIdentifier(newDocId))
                         .withFilepath(fp)
                         .withParametersProvider(appModule)
-                        .withEntityPostProcess([=](TDF_Label labelEntity, TaskProgress* progress) {
-                            appModule->computeBRepMesh(labelEntity, progress);
+                        .withEntityPostProcess([=](TDF_Label labelEntity, const FilePath& filepath, TaskProgress* progress) {
+                            appModule->computeBRepMesh(labelEntity, filepath, progress);
                         })
                         .withEntityPostProcessRequiredIf(&IO::formatProvidesBRep)
                         .withEntityPostProcessInfoProgress(20, Command::textIdTr("Mesh BRep shapes"))
@@ -234,8 +234,8 @@ void FileCommandTools::importInDocument(
                                   .targetDocument(doc)
                                   .withFilepaths(listFilePaths)
                                   .withParametersProvider(appModule)
-                                  .withEntityPostProcess([=](TDF_Label labelEntity, TaskProgress* progress) {
-                                      appModule->computeBRepMesh(labelEntity, progress);
+                                  .withEntityPostProcess([=](TDF_Label labelEntity, const FilePath& filepath, TaskProgress* progress) {
+                                      appModule->computeBRepMesh(labelEntity, filepath, progress);
                                   })
                                   .withEntityPostProcessRequiredIf(&IO::formatProvidesBRep)
                                   .withEntityPostProcessInfoProgress(20, Command::textIdTr("Mesh BRep shapes"))
@@ -446,6 +446,10 @@ void CommandExportSelectedApplicationItems::execute()
 
     lastSettings.openDir = filepathFrom(strFilepath);
     const IO::Format format = formatFromFilter(lastSettings.selectedFilter);
+    // Model trees can't be expanded by the export task, it runs concurrently with the GUI
+    const Span<const ApplicationItem> spanSelectedItem = this->guiApp()->selectionModel()->selectedItems();
+    const std::vector<ApplicationItem> vecItem(spanSelectedItem.begin(), spanSelectedItem.end());
+    IO::System::deepExpandItems(vecItem);
     const TaskId taskId = this->taskMgr()->newTask([=](TaskProgress* progress) {
         QElapsedTimer chrono;
         chrono.start();
@@ -453,7 +457,7 @@ void CommandExportSelectedApplicationItems::execute()
                 appModule->ioSystem()->exportApplicationItems()
                 .targetFile(filepathFrom(strFilepath))
                 .targetFormat(format)
-                .withItems(this->guiApp()->selectionModel()->selectedItems())
+                .withItems(vecItem)
                 .withParameters(appModule->findWriterParameters(format))
                 .withMessenger(appModule)
                 .withTaskProgress(progress)
@@ -59,19 +59,22 @@
 #  include <XCAFDoc_VisMaterialTool.hxx>
 #endif
 
+#include <QtCore/QAbstractItemModel>
 #include <QtCore/QBuffer>
+#include <QtCore/QItemSelectionModel>
 #include <QtCore/QFileInfo>
 
 #include <algorithm>
 #include <sstream>
 #include <unordered_map>
+#include <vector>
 
 namespace Mayo {
 
 namespace Internal {
 
-enum TreeWidgetItemRole {
-    TreeWidgetItem_TdfLabelRole = Qt::UserRole + 1
+enum LabelTreeModelRole {
+    LabelTreeModel_TdfLabelRole = Qt::UserRole + 1
 };
 
 static QStringUtils::TextOptions appDefaultTextOptions()
@@ -774,25 +777,139 @@ static void loadLabelGeomToleranceProperties(const TDF_Label& label, QTreeWidget
     treeItem->addChildren(listItemProp);
 }
 
-static void loadLabel(const TDF_Label& label, QTreeWidgetItem* treeItem)
-{
-    treeItem->setData(0, TreeWidgetItem_TdfLabelRole, QVariant::fromValue(label));
-    treeItem->setText(0, to_QString(CafUtils::labelTag(label)));
+// Provides a Qt item model of the TDF label hierarchy of a document
+// Child items are created only when their parent item gets expanded(see fetchMore()), texts are
+// computed only when requested by the view, ie for visible items
+class LabelTreeModel : public QAbstractItemModel {
+public:
+    LabelTreeModel(const TDF_Label& labelRoot, QObject* parent = nullptr)
+        : QAbstractItemModel(parent)
+    {
+        if (!labelRoot.IsNull())
+            m_vecNode.push_back(Node{ labelRoot });
+    }
 
-    const QString stdName = to_QString(CafUtils::labelAttrStdName(label));
-    if (!stdName.isEmpty())
-        treeItem->setText(0, treeItem->text(0) + " " + stdName);
-}
+    TDF_Label label(const QModelIndex& index) const {
+        return index.isValid() ? this->node(index).label : TDF_Label();
+    }
 
-static void deepLoadChildrenLabels(const TDF_Label& label, QTreeWidgetItem* treeItem)
-{
-    for (TDF_ChildIterator it(label, false/*!allLevels*/); it.More(); it.Next()) {
-        const TDF_Label childLabel = it.Value();
-        auto childTreeItem = new QTreeWidgetItem(treeItem);
-        loadLabel(childLabel, childTreeItem);
-        deepLoadChildrenLabels(childLabel, childTreeItem);
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override
+    {
+        if (!this->hasIndex(row, column, parent))
+            return {};
+
+        if (!parent.isValid())
+            return this->createIndex(row, column, quintptr(0));
+
+        const Node& parentNode = this->node(parent);
+        return this->createIndex(row, column, quintptr(parentNode.vecChildId.at(row)));
     }
-}
+
+    QModelIndex parent(const QModelIndex& index) const override
+    {
+        if (!index.isValid())
+            return {};
+
+        const Node& node = this->node(index);
+        if (node.parentId < 0)
+            return {};
+
+        return this->createIndex(m_vecNode.at(node.parentId).row, 0, quintptr(node.parentId));
+    }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override
+    {
+        if (!parent.isValid())
+            return m_vecNode.empty() ? 0 : 1;
+
+        return parent.column() == 0 ? int(this->node(parent).vecChildId.size()) : 0;
+    }
+
+    int columnCount(const QModelIndex& /*parent*/ = QModelIndex()) const override {
+        return 1;
+    }
+
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override
+    {
+        if (!parent.isValid())
+            return !m_vecNode.empty();
+
+        return this->node(parent).label.HasChild();
+    }
+
+    bool canFetchMore(const QModelIndex& parent) const override
+    {
+        if (!parent.isValid())
+            return false;
+
+        const Node& node = this->node(parent);
+        return !node.isFetched && node.label.HasChild();
+    }
+
+    void fetchMore(const QModelIndex& parent) override
+    {
+        if (!this->canFetchMore(parent))
+            return;
+
+        const int parentId = int(parent.internalId());
+        std::vector<TDF_Label> vecChildLabel;
+        for (TDF_ChildIterator it(m_vecNode.at(parentId).label, false/*!allLevels*/); it.More(); it.Next())
+            vecChildLabel.push_back(it.Value());
+
+        m_vecNode.at(parentId).isFetched = true;
+        if (vecChildLabel.empty())
+            return;
+
+        this->beginInsertRows(parent, 0, int(vecChildLabel.size()) - 1);
+        m_vecNode.reserve(m_vecNode.size() + vecChildLabel.size());
+        for (const TDF_Label& childLabel : vecChildLabel) {
+            Node childNode{ childLabel };
+            childNode.parentId = parentId;
+            childNode.row = int(m_vecNode.at(parentId).vecChildId.size());
+            m_vecNode.at(parentId).vecChildId.push_back(int(m_vecNode.size()));
+            m_vecNode.push_back(std::move(childNode));
+        }
+
+        this->endInsertRows();
+    }
+
+    QVariant data(const QModelIndex& index, int role) const override
+    {
+        if (!index.isValid())
+            return {};
+
+        const TDF_Label& label = this->node(index).label;
+        if (role == Qt::DisplayRole) {
+            QString text = to_QString(CafUtils::labelTag(label));
+            const QString stdName = to_QString(CafUtils::labelAttrStdName(label));
+            if (!stdName.isEmpty())
+                text += " " + stdName;
+
+            return text;
+        }
+
+        if (role == LabelTreeModel_TdfLabelRole)
+            return QVariant::fromValue(label);
+
+        return {};
+    }
+
+private:
+    struct Node {
+        TDF_Label label;
+        int parentId = -1;
+        int row = 0;
+        std::vector<int> vecChildId;
+        bool isFetched = false;
+    };
+
+    const Node& node(const QModelIndex& index) const {
+        return m_vecNode.at(index.internalId());
+    }
+
+    // Nodes are referenced by their index in this vector(stored as QModelIndex::internalId())
+    std::vector<Node> m_vecNode;
+};
 
 } // namespace Internal
 
@@ -803,10 +920,7 @@ DialogInspectXde::DialogInspectXde(QWidget* parent)
     m_ui->setupUi(this);
     m_ui->splitter->setStretchFactor(0, 1);
     m_ui->splitter->setStretchFactor(1, 4);
-    QObject::connect(
-        m_ui->treeWidget_Document, &QTreeWidget::itemClicked,
-        this, &DialogInspectXde::onLabelTreeWidgetItemClicked
-    );
+    m_ui->treeView_Document->setUniformRowHeights(true);
 }
 
 DialogInspectXde::~DialogInspectXde()
@@ -823,18 +937,19 @@ void DialogInspectXde::load(const OccHandle<TDocStd_Document>& doc)
     }
 
     if (!doc.IsNull()) {
-        const TDF_Label label = doc->Main();
-        auto treeItem = new QTreeWidgetItem;
-        Internal::loadLabel(label, treeItem);
-        Internal::deepLoadChildrenLabels(label, treeItem);
-        m_ui->treeWidget_Document->addTopLevelItem(treeItem);
-        treeItem->setExpanded(true);
+        auto model = new Internal::LabelTreeModel(doc->Main(), this);
+        m_ui->treeView_Document->setModel(model);
+        m_ui->treeView_Document->expand(model->index(0, 0));
+        QObject::connect(
+            m_ui->treeView_Document->selectionModel(), &QItemSelectionModel::currentChanged,
+            this, &DialogInspectXde::onLabelTreeViewCurrentChanged
+        );
     }
 }
 
-void DialogInspectXde::onLabelTreeWidgetItemClicked(QTreeWidgetItem* item, int /*column*/)
+void DialogInspectXde::onLabelTreeViewCurrentChanged(const QModelIndex& index)
 {
-    const QVariant varLabel = item->data(0, Internal::TreeWidgetItem_TdfLabelRole);
+    const QVariant varLabel = index.data(Internal::LabelTreeModel_TdfLabelRole);
     if (varLabel.isValid()) {
         m_ui->treeWidget_LabelProps->clear();
         const TDF_Label label = varLabel.value<TDF_Label>();
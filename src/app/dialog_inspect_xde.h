@@ -9,7 +9,7 @@
 #include "../base/occ_handle.h"
 #include <QtWidgets/QDialog>
 #include <TDocStd_Document.hxx>
-class QTreeWidgetItem;
+class QModelIndex;
 
 namespace Mayo {
 
@@ -22,7 +22,7 @@ public:
     void load(const OccHandle<TDocStd_Document>& doc);
 
 private:
-    void onLabelTreeWidgetItemClicked(QTreeWidgetItem* item, int column);
+    void onLabelTreeViewCurrentChanged(const QModelIndex& index);
 
     class Ui_DialogInspectXde* m_ui = nullptr;
     OccHandle<TDocStd_Document> m_doc;
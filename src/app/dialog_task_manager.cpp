@@ -110,7 +110,8 @@ void DialogTaskManager::TaskWidget::onUnboundedProgressTimeout()
 DialogTaskManager::DialogTaskManager(TaskManager* taskMgr, QWidget* parent)
     : QDialog(parent),
       m_ui(new Ui_DialogTaskManager),
-      m_taskMgr(taskMgr)
+      m_taskMgr(taskMgr),
+      m_progressFlushTimer(new QTimer(this))
 {
     m_ui->setupUi(this);
     this->setWindowFlags(Qt::Dialog | Qt::CustomizeWindowHint | Qt::WindowTitleHint);
@@ -120,6 +121,10 @@ DialogTaskManager::DialogTaskManager(TaskManager* taskMgr, QWidget* parent)
     taskMgr->signalEnded.connectSlot(&DialogTaskManager::onTaskEnded, this);
     taskMgr->signalProgressChanged.connectSlot(&DialogTaskManager::onTaskProgress, this);
     taskMgr->signalProgressStep.connectSlot(&DialogTaskManager::onTaskProgressStep, this);
+
+    // Progress notifications are throttled, make sure last values of running tasks are emitted
+    m_progressFlushTimer->setInterval(1000 / TaskProgress::NotifyMaxRate);
+    QObject::connect(m_progressFlushTimer, &QTimer::timeout, this, [=]{ taskMgr->flushPendingProgress(); });
 }
 
 DialogTaskManager::~DialogTaskManager()
@@ -132,6 +137,9 @@ void DialogTaskManager::onTaskStarted(TaskId taskId)
     if (!m_isRunning)
         this->show();
 
+    if (!m_progressFlushTimer->isActive())
+        m_progressFlushTimer->start();
+
     auto widget = new TaskWidget(m_ui->scrollAreaContents);
     widget->m_interruptBtn->setProperty(TaskWidget::TaskIdProp, quint64(taskId));
     QObject::connect(
@@ -158,6 +166,7 @@ void DialogTaskManager::onTaskEnded(TaskId taskId)
 
     --m_taskCount;
     if (m_taskCount == 0) {
+        m_progressFlushTimer->stop();
         m_isRunning = false;
         this->accept();
     }
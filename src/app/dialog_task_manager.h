@@ -11,6 +11,8 @@
 #include <QtWidgets/QDialog>
 #include <unordered_map>
 
+class QTimer;
+
 namespace Mayo {
 
 class TaskManager;
@@ -33,6 +35,7 @@ private:
 
     class Ui_DialogTaskManager* m_ui = nullptr;
     TaskManager* m_taskMgr = nullptr;
+    QTimer* m_progressFlushTimer = nullptr;
     std::unordered_map<TaskId, TaskWidget*> m_taskIdToWidget;
     bool m_isRunning = false;
     unsigned m_taskCount = 0;
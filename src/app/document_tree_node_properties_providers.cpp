@@ -25,6 +25,8 @@
 #include <TDataStd_Name.hxx>
 #include <QtCore/QStringList>
 
+#include <cmath>
+
 namespace Mayo {
 
 class XCaf_DocumentTreeNodePropertiesProvider::Properties : public PropertyGroupSignals {
@@ -226,8 +228,13 @@ public:
 
         m_propertyNodeCount.setValue(!mesh.IsNull() ? mesh->NbNodes() : 0);
         m_propertyTriangleCount.setValue(!mesh.IsNull() ? mesh->NbTriangles() : 0);
-        m_propertyArea.setQuantity(MeshUtils::triangulationArea(mesh) * Quantity_SquareMillimeter);
-        m_propertyVolume.setQuantity(MeshUtils::triangulationVolume(mesh) * Quantity_CubicMillimeter);
+        // Metrics are cached along with the mesh, so selecting it again doesn't recompute them
+        TriangulationAnnexDataPtr annexData;
+        treeNode.label().FindAttribute(TriangulationAnnexData::GetID(), annexData);
+        const MeshUtils::TriangulationMetrics metrics =
+                annexData ? annexData->triangulationMetrics(mesh) : MeshUtils::triangulationMetrics(mesh);
+        m_propertyArea.setQuantity(metrics.area * Quantity_SquareMillimeter);
+        m_propertyVolume.setQuantity(std::abs(metrics.signedVolume) * Quantity_CubicMillimeter);
         for (Property* property : this->properties())
             property->setUserReadOnly(true);
     }
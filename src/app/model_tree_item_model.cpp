@@ -0,0 +1,495 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "model_tree_item_model.h"
+
+#include "../base/application_item_selection_model.h"
+#include "../base/document.h"
+#include "../gui/gui_application.h"
+#include "../qtcommon/qtcore_utils.h"
+#include "widget_model_tree_builder.h"
+
+#include <QtGui/QIcon>
+#include <algorithm>
+#include <iterator>
+
+namespace Mayo {
+
+ModelTreeItemModel::ModelTreeItemModel(QObject* parent)
+    : QAbstractItemModel(parent)
+{
+}
+
+ModelTreeItemModel::~ModelTreeItemModel()
+{
+    for (auto& docEntry : m_mapDocEntry)
+        docEntry.second.connModelTreeCompacted.disconnect();
+}
+
+void ModelTreeItemModel::setBuilders(std::vector<WidgetModelTreeBuilder*> vecBuilder)
+{
+    m_vecBuilder = std::move(vecBuilder);
+}
+
+void ModelTreeItemModel::appendDocument(const DocumentPtr& doc)
+{
+    if (m_mapDocEntry.find(doc.get()) != m_mapDocEntry.cend())
+        return; // Already in the model
+
+    const int row = int(m_vecDocItemId.size());
+    this->beginInsertRows(QModelIndex(), row, row);
+    Item docItem;
+    docItem.doc = doc;
+    docItem.builder = this->findSupportBuilder(doc);
+    docItem.row = row;
+    docItem.isFetched = true; // Entity items are added explicitly with appendEntity()
+    DocumentEntry& entry = m_mapDocEntry[doc.get()];
+    entry.itemId = this->newItem(std::move(docItem));
+    const Document* docPtr = doc.get();
+    entry.connModelTreeCompacted = doc->signalModelTreeCompacted.connectSlot(
+        [=](const std::vector<TreeNodeId>& vecOldToNewId) {
+            this->onModelTreeCompacted(docPtr, vecOldToNewId);
+        }
+    );
+    m_vecDocItemId.push_back(entry.itemId);
+    this->endInsertRows();
+}
+
+void ModelTreeItemModel::removeDocument(const DocumentPtr& doc)
+{
+    auto itEntry = m_mapDocEntry.find(doc.get());
+    if (itEntry == m_mapDocEntry.end())
+        return;
+
+    itEntry->second.connModelTreeCompacted.disconnect();
+    this->removeChildRow(-1, m_vecItem.at(itEntry->second.itemId).row);
+    m_mapDocEntry.erase(doc.get());
+}
+
+void ModelTreeItemModel::appendEntity(const DocumentPtr& doc, TreeNodeId entityId)
+{
+    auto itEntry = m_mapDocEntry.find(doc.get());
+    if (itEntry == m_mapDocEntry.end())
+        return;
+
+    const int docItemId = itEntry->second.itemId;
+    const int row = int(m_vecItem.at(docItemId).vecChildId.size());
+    this->beginInsertRows(this->indexOfItem(docItemId), row, row);
+    Item entityItem;
+    entityItem.doc = doc;
+    entityItem.nodeId = entityId;
+    entityItem.builder = this->findSupportBuilder(DocumentTreeNode(doc, entityId));
+    entityItem.parentId = docItemId;
+    entityItem.row = row;
+    const int entityItemId = this->newItem(std::move(entityItem));
+    m_vecItem.at(docItemId).vecChildId.push_back(entityItemId);
+    this->endInsertRows();
+}
+
+void ModelTreeItemModel::removeEntity(const DocumentPtr& doc, TreeNodeId entityId)
+{
+    const int itemId = this->findItemId(DocumentTreeNode(doc, entityId));
+    if (itemId >= 0) {
+        const Item& item = m_vecItem.at(itemId);
+        this->removeChildRow(item.parentId, item.row);
+    }
+}
+
+ApplicationItem ModelTreeItemModel::applicationItem(const QModelIndex& index) const
+{
+    if (!index.isValid())
+        return {};
+
+    const Item& item = this->item(index);
+    if (item.nodeId == 0)
+        return ApplicationItem(item.doc);
+
+    return ApplicationItem(DocumentTreeNode(item.doc, item.nodeId));
+}
+
+QModelIndex ModelTreeItemModel::indexOf(const ApplicationItem& appItem, bool fetch)
+{
+    if (appItem.isDocument()) {
+        auto itEntry = m_mapDocEntry.find(appItem.document().get());
+        return itEntry != m_mapDocEntry.cend() ? this->indexOfItem(itEntry->second.itemId) : QModelIndex();
+    }
+
+    if (!appItem.isDocumentTreeNode())
+        return {};
+
+    const DocumentTreeNode& node = appItem.documentTreeNode();
+    int itemId = this->findItemId(node);
+    if (itemId < 0 && fetch) {
+        // Fetch children of the ancestor items, from top to bottom
+        const DocumentPtr& doc = node.document();
+        const Tree<TDF_Label>& modelTree = doc->modelTree();
+        std::vector<TreeNodeId> vecAncestorId;
+        for (TreeNodeId id = modelTree.nodeParent(node.id()); id != 0; id = modelTree.nodeParent(id))
+            vecAncestorId.push_back(id);
+
+        for (auto it = vecAncestorId.rbegin(); it != vecAncestorId.rend(); ++it) {
+            const int ancestorItemId = this->findItemId(DocumentTreeNode(doc, *it));
+            if (ancestorItemId >= 0)
+                this->fetchMore(this->indexOfItem(ancestorItemId));
+        }
+
+        itemId = this->findItemId(node);
+    }
+
+    return itemId >= 0 ? this->indexOfItem(itemId) : QModelIndex();
+}
+
+QString ModelTreeItemModel::itemText(const DocumentTreeNode& node) const
+{
+    if (!node.isValid())
+        return {};
+
+    const int itemId = this->findItemId(node);
+    if (itemId >= 0)
+        return m_vecItem.at(itemId).builder->itemText(node);
+
+    const TreeNodeId entityId = node.document()->modelTree().nodeRoot(node.id());
+    return this->findSupportBuilder(DocumentTreeNode(node.document(), entityId))->itemText(node);
+}
+
+void ModelTreeItemModel::refreshItemTexts(const DocumentPtr& doc)
+{
+    auto itEntry = m_mapDocEntry.find(doc.get());
+    if (itEntry != m_mapDocEntry.cend()) {
+        const QModelIndex indexDoc = this->indexOfItem(itEntry->second.itemId);
+        emit this->dataChanged(indexDoc, indexDoc, { Qt::DisplayRole });
+        this->emitDataChangedForChildren(itEntry->second.itemId, { Qt::DisplayRole });
+    }
+}
+
+void ModelTreeItemModel::refreshItemTexts()
+{
+    for (const auto& docEntry : m_mapDocEntry)
+        this->refreshItemTexts(m_vecItem.at(docEntry.second.itemId).doc);
+}
+
+void ModelTreeItemModel::refreshItemCheckStates(
+        const DocumentPtr& doc, const GuiDocument::MapVisibilityByTreeNodeId& mapNodeId
+    )
+{
+    auto itEntry = m_mapDocEntry.find(doc.get());
+    if (itEntry == m_mapDocEntry.cend())
+        return;
+
+    // Only items created so far are concerned, others will query check state when fetched
+    const auto& mapNodeItemId = itEntry->second.mapNodeItemId;
+    for (const auto& nodeVisibility : mapNodeId) {
+        auto itItem = mapNodeItemId.find(nodeVisibility.first);
+        if (itItem != mapNodeItemId.cend()) {
+            const QModelIndex index = this->indexOfItem(itItem->second);
+            emit this->dataChanged(index, index, { Qt::CheckStateRole });
+        }
+    }
+}
+
+QModelIndex ModelTreeItemModel::index(int row, int column, const QModelIndex& parent) const
+{
+    if (!this->hasIndex(row, column, parent))
+        return {};
+
+    if (!parent.isValid())
+        return this->createIndex(row, column, quintptr(m_vecDocItemId.at(row)));
+
+    const Item& parentItem = this->item(parent);
+    return this->createIndex(row, column, quintptr(parentItem.vecChildId.at(row)));
+}
+
+QModelIndex ModelTreeItemModel::parent(const QModelIndex& index) const
+{
+    if (!index.isValid())
+        return {};
+
+    const Item& item = this->item(index);
+    return item.parentId >= 0 ? this->indexOfItem(item.parentId) : QModelIndex();
+}
+
+int ModelTreeItemModel::rowCount(const QModelIndex& parent) const
+{
+    if (!parent.isValid())
+        return int(m_vecDocItemId.size());
+
+    return parent.column() == 0 ? int(this->item(parent).vecChildId.size()) : 0;
+}
+
+int ModelTreeItemModel::columnCount(const QModelIndex& /*parent*/) const
+{
+    return 1;
+}
+
+bool ModelTreeItemModel::hasChildren(const QModelIndex& parent) const
+{
+    if (!parent.isValid())
+        return !m_vecDocItemId.empty();
+
+    const Item& item = this->item(parent);
+    if (item.isFetched)
+        return !item.vecChildId.empty();
+
+    return item.builder->hasChildNodes(DocumentTreeNode(item.doc, item.nodeId));
+}
+
+bool ModelTreeItemModel::canFetchMore(const QModelIndex& parent) const
+{
+    if (!parent.isValid())
+        return false;
+
+    const Item& item = this->item(parent);
+    return !item.isFetched && item.builder->hasChildNodes(DocumentTreeNode(item.doc, item.nodeId));
+}
+
+void ModelTreeItemModel::fetchMore(const QModelIndex& parent)
+{
+    if (!this->canFetchMore(parent))
+        return;
+
+    const int parentId = int(parent.internalId());
+    const DocumentPtr doc = m_vecItem.at(parentId).doc;
+    WidgetModelTreeBuilder* builder = m_vecItem.at(parentId).builder;
+    const std::vector<TreeNodeId> vecChildNodeId = builder->childNodes(
+        DocumentTreeNode(doc, m_vecItem.at(parentId).nodeId)
+    );
+    m_vecItem.at(parentId).isFetched = true;
+    if (vecChildNodeId.empty())
+        return;
+
+    this->beginInsertRows(parent, 0, int(vecChildNodeId.size()) - 1);
+    m_vecItem.at(parentId).vecChildId.reserve(vecChildNodeId.size());
+    for (TreeNodeId childNodeId : vecChildNodeId) {
+        Item childItem;
+        childItem.doc = doc;
+        childItem.nodeId = childNodeId;
+        childItem.builder = builder;
+        childItem.parentId = parentId;
+        childItem.row = int(m_vecItem.at(parentId).vecChildId.size());
+        const int childItemId = this->newItem(std::move(childItem));
+        m_vecItem.at(parentId).vecChildId.push_back(childItemId);
+    }
+
+    this->endInsertRows();
+}
+
+Qt::ItemFlags ModelTreeItemModel::flags(const QModelIndex& index) const
+{
+    Qt::ItemFlags itemFlags = QAbstractItemModel::flags(index);
+    if (index.isValid() && this->item(index).nodeId != 0)
+        itemFlags |= Qt::ItemIsUserCheckable;
+
+    return itemFlags;
+}
+
+QVariant ModelTreeItemModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid())
+        return {};
+
+    const Item& item = this->item(index);
+    const bool isDocumentItem = item.nodeId == 0;
+    const DocumentTreeNode node(item.doc, item.nodeId);
+    switch (role) {
+    case Qt::DisplayRole:
+        return isDocumentItem ? item.builder->itemText(item.doc) : item.builder->itemText(node);
+    case Qt::DecorationRole: {
+        const QIcon icon = isDocumentItem ? item.builder->itemIcon(item.doc) : item.builder->itemIcon(node);
+        return !icon.isNull() ? QVariant(icon) : QVariant();
+    }
+    case Qt::ToolTipRole:
+        return isDocumentItem ? item.builder->itemToolTip(item.doc) : QVariant();
+    case Qt::CheckStateRole: {
+        if (isDocumentItem)
+            return {};
+
+        const GuiDocument* guiDoc = m_guiApp ? m_guiApp->findGuiDocument(item.doc) : nullptr;
+        return guiDoc ? QtCoreUtils::toQtCheckState(guiDoc->nodeVisibleState(item.nodeId)) : Qt::Checked;
+    }
+    case ItemTypeRole: {
+        if (isDocumentItem)
+            return ItemType_Document;
+
+        return item.parentId >= 0 && m_vecItem.at(item.parentId).nodeId == 0 ?
+                    ItemType_DocumentEntity : ItemType_DocumentTreeNode;
+    }
+    } // endswitch
+
+    return {};
+}
+
+bool ModelTreeItemModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+    if (!index.isValid() || role != Qt::CheckStateRole)
+        return false;
+
+    const Item& item = this->item(index);
+    const auto checkState = QtCoreUtils::toCheckState(Qt::CheckState(value.toInt()));
+    if (item.nodeId == 0 || checkState == CheckState::Partially)
+        return false;
+
+    GuiDocument* guiDoc = m_guiApp ? m_guiApp->findGuiDocument(item.doc) : nullptr;
+    if (!guiDoc)
+        return false;
+
+    // Checking/unchecking a selected item applies to all the selected tree nodes(bulk operation)
+    // Node identifiers are collected per document so GuiDocument::setNodesVisible() is called once
+    // per document, hence a single signalNodesVisibilityChanged and a single redraw
+    std::unordered_map<GuiDocument*, std::vector<TreeNodeId>> mapGuiDocNodeIds;
+    const ApplicationItemSelectionModel* selectionModel = m_guiApp->selectionModel();
+    const DocumentTreeNode node(item.doc, item.nodeId);
+    if (selectionModel->isSelected(ApplicationItem(node))) {
+        for (const ApplicationItem& appItem : selectionModel->selectedItems()) {
+            if (!appItem.isDocumentTreeNode())
+                continue;
+
+            const DocumentTreeNode& selectedNode = appItem.documentTreeNode();
+            GuiDocument* selectedGuiDoc = m_guiApp->findGuiDocument(selectedNode.document());
+            if (selectedGuiDoc)
+                mapGuiDocNodeIds[selectedGuiDoc].push_back(selectedNode.id());
+        }
+    }
+    else {
+        mapGuiDocNodeIds[guiDoc].push_back(item.nodeId);
+    }
+
+    // Views are notified by refreshItemCheckStates() on GuiDocument::signalNodesVisibilityChanged
+    for (const auto& [selectedGuiDoc, vecNodeId] : mapGuiDocNodeIds)
+        selectedGuiDoc->setNodesVisible(vecNodeId, checkState == CheckState::On);
+
+    return true;
+}
+
+const ModelTreeItemModel::Item& ModelTreeItemModel::item(const QModelIndex& index) const
+{
+    return m_vecItem.at(index.internalId());
+}
+
+QModelIndex ModelTreeItemModel::indexOfItem(int itemId) const
+{
+    return this->createIndex(m_vecItem.at(itemId).row, 0, quintptr(itemId));
+}
+
+int ModelTreeItemModel::findItemId(const DocumentTreeNode& node) const
+{
+    auto itEntry = m_mapDocEntry.find(node.document().get());
+    if (itEntry == m_mapDocEntry.cend())
+        return -1;
+
+    const auto& mapNodeItemId = itEntry->second.mapNodeItemId;
+    auto itItem = mapNodeItemId.find(node.id());
+    return itItem != mapNodeItemId.cend() ? itItem->second : -1;
+}
+
+int ModelTreeItemModel::newItem(Item&& item)
+{
+    int itemId = -1;
+    if (!m_vecFreeItemId.empty()) {
+        itemId = m_vecFreeItemId.back();
+        m_vecFreeItemId.pop_back();
+        m_vecItem.at(itemId) = std::move(item);
+    }
+    else {
+        itemId = int(m_vecItem.size());
+        m_vecItem.push_back(std::move(item));
+    }
+
+    const Item& newItem = m_vecItem.at(itemId);
+    if (newItem.nodeId != 0)
+        m_mapDocEntry[newItem.doc.get()].mapNodeItemId.insert_or_assign(newItem.nodeId, itemId);
+
+    return itemId;
+}
+
+void ModelTreeItemModel::deleteItem(int itemId)
+{
+    // Note: m_vecItem isn't resized here, so reference 'item' stays valid
+    Item& item = m_vecItem.at(itemId);
+    for (int childItemId : item.vecChildId)
+        this->deleteItem(childItemId);
+
+    if (item.nodeId != 0) {
+        auto itEntry = m_mapDocEntry.find(item.doc.get());
+        if (itEntry != m_mapDocEntry.end())
+            itEntry->second.mapNodeItemId.erase(item.nodeId);
+    }
+
+    item = Item{};
+    m_vecFreeItemId.push_back(itemId);
+}
+
+void ModelTreeItemModel::removeChildRow(int parentId, int row)
+{
+    std::vector<int>& vecSiblingId = parentId >= 0 ? m_vecItem.at(parentId).vecChildId : m_vecDocItemId;
+    this->beginRemoveRows(parentId >= 0 ? this->indexOfItem(parentId) : QModelIndex(), row, row);
+    const int itemId = vecSiblingId.at(row);
+    vecSiblingId.erase(vecSiblingId.begin() + row);
+    for (int i = row; i < int(vecSiblingId.size()); ++i)
+        m_vecItem.at(vecSiblingId.at(i)).row = i;
+
+    this->deleteItem(itemId);
+    this->endRemoveRows();
+}
+
+void ModelTreeItemModel::emitDataChangedForChildren(int parentId, const QVector<int>& roles)
+{
+    const std::vector<int>& vecChildId = m_vecItem.at(parentId).vecChildId;
+    if (vecChildId.empty())
+        return;
+
+    // One notification for each range of sibling items
+    emit this->dataChanged(
+        this->indexOfItem(vecChildId.front()), this->indexOfItem(vecChildId.back()), roles
+    );
+    for (int childItemId : vecChildId)
+        this->emitDataChangedForChildren(childItemId, roles);
+}
+
+void ModelTreeItemModel::onModelTreeCompacted(
+        const Document* doc, const std::vector<TreeNodeId>& vecOldToNewId
+    )
+{
+    auto itEntry = m_mapDocEntry.find(doc);
+    if (itEntry == m_mapDocEntry.end())
+        return;
+
+    auto& mapNodeItemId = itEntry->second.mapNodeItemId;
+    mapNodeItemId.clear();
+    for (int itemId = 0; itemId < int(m_vecItem.size()); ++itemId) {
+        Item& item = m_vecItem.at(itemId);
+        if (item.doc.get() != doc || item.nodeId == 0)
+            continue;
+
+        item.nodeId = item.nodeId < vecOldToNewId.size() ? vecOldToNewId.at(item.nodeId) : 0;
+        if (item.nodeId != 0)
+            mapNodeItemId.insert_or_assign(item.nodeId, itemId);
+    }
+}
+
+WidgetModelTreeBuilder* ModelTreeItemModel::findSupportBuilder(const DocumentPtr& doc) const
+{
+    Expects(!m_vecBuilder.empty());
+    auto it = std::find_if(
+        std::next(m_vecBuilder.cbegin()),
+        m_vecBuilder.cend(),
+        [=](const WidgetModelTreeBuilder* builder) { return builder->supportsDocument(doc); }
+    );
+    return it != m_vecBuilder.cend() ? *it : m_vecBuilder.front();
+}
+
+WidgetModelTreeBuilder* ModelTreeItemModel::findSupportBuilder(const DocumentTreeNode& entityNode) const
+{
+    Expects(!m_vecBuilder.empty());
+    Expects(entityNode.isValid());
+    auto it = std::find_if(
+        std::next(m_vecBuilder.cbegin()),
+        m_vecBuilder.cend(),
+        [=](const WidgetModelTreeBuilder* builder) { return builder->supportsDocumentTreeNode(entityNode); }
+    );
+    return it != m_vecBuilder.cend() ? *it : m_vecBuilder.front();
+}
+
+} // namespace Mayo
@@ -0,0 +1,124 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/application_item.h"
+#include "../base/document_ptr.h"
+#include "../base/document_tree_node.h"
+#include "../base/signal.h"
+#include "../gui/gui_document.h"
+
+#include <QtCore/QAbstractItemModel>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+class GuiApplication;
+class WidgetModelTreeBuilder;
+
+// Provides a Qt item model of documents along with their model tree(see Document::modelTree())
+// Items of tree nodes are created only when their parent item gets expanded(see fetchMore()), item
+// data(text, icon, check state) is computed on demand by the WidgetModelTreeBuilder object
+// supporting the document or entity
+// Mapping between items and document tree nodes is done in constant time both ways
+class ModelTreeItemModel : public QAbstractItemModel {
+public:
+    enum Role {
+        ItemTypeRole = Qt::UserRole + 1
+    };
+
+    enum ItemType {
+        ItemType_Unknown = 0,
+        ItemType_Document = 0x01,
+        ItemType_DocumentTreeNode = 0x02,
+        ItemType_DocumentEntity = 0x10 | ItemType_DocumentTreeNode
+    };
+
+    ModelTreeItemModel(QObject* parent = nullptr);
+    ~ModelTreeItemModel();
+
+    // Provides the visibility state of tree nodes(check state of items)
+    GuiApplication* guiApplication() const { return m_guiApp; }
+    void setGuiApplication(GuiApplication* guiApp) { m_guiApp = guiApp; }
+
+    // The first builder is the fallback one, used when no other builder supports an item
+    void setBuilders(std::vector<WidgetModelTreeBuilder*> vecBuilder);
+
+    void appendDocument(const DocumentPtr& doc);
+    void removeDocument(const DocumentPtr& doc);
+    void appendEntity(const DocumentPtr& doc, TreeNodeId entityId);
+    void removeEntity(const DocumentPtr& doc, TreeNodeId entityId);
+
+    ApplicationItem applicationItem(const QModelIndex& index) const;
+
+    // Returns the index of the item associated to 'appItem'
+    // If 'fetch' is true then parent items are fetched as needed, otherwise an invalid index is
+    // returned if the item isn't created yet
+    QModelIndex indexOf(const ApplicationItem& appItem, bool fetch = false);
+
+    // Text of the item associated to 'node', even if that item isn't created yet
+    QString itemText(const DocumentTreeNode& node) const;
+
+    // Notifies views that texts of the items created so far have to be refreshed
+    void refreshItemTexts(const DocumentPtr& doc);
+    void refreshItemTexts();
+
+    // Notifies views that check states of items associated to tree nodes have changed
+    void refreshItemCheckStates(const DocumentPtr& doc, const GuiDocument::MapVisibilityByTreeNodeId& mapNodeId);
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& index) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    // Check state change of a selected item is applied to all the selected tree nodes
+    bool setData(const QModelIndex& index, const QVariant& value, int role) override;
+
+private:
+    struct Item {
+        DocumentPtr doc;
+        TreeNodeId nodeId = 0; // 0 for document items
+        WidgetModelTreeBuilder* builder = nullptr;
+        int parentId = -1;
+        int row = 0;
+        std::vector<int> vecChildId;
+        bool isFetched = false;
+    };
+
+    struct DocumentEntry {
+        int itemId = -1;
+        std::unordered_map<TreeNodeId, int> mapNodeItemId;
+        SignalConnectionHandle connModelTreeCompacted;
+    };
+
+    const Item& item(const QModelIndex& index) const;
+    QModelIndex indexOfItem(int itemId) const;
+    int findItemId(const DocumentTreeNode& node) const;
+    int newItem(Item&& item);
+    void deleteItem(int itemId);
+    void removeChildRow(int parentId, int row);
+    void emitDataChangedForChildren(int parentId, const QVector<int>& roles);
+    void onModelTreeCompacted(const Document* doc, const std::vector<TreeNodeId>& vecOldToNewId);
+
+    WidgetModelTreeBuilder* findSupportBuilder(const DocumentPtr& doc) const;
+    WidgetModelTreeBuilder* findSupportBuilder(const DocumentTreeNode& entityNode) const;
+
+    GuiApplication* m_guiApp = nullptr;
+    std::vector<WidgetModelTreeBuilder*> m_vecBuilder;
+    // Items are referenced by their index in this vector(stored as QModelIndex::internalId())
+    std::vector<Item> m_vecItem;
+    std::vector<int> m_vecFreeItemId;
+    std::vector<int> m_vecDocItemId;
+    std::unordered_map<const Document*, DocumentEntry> m_mapDocEntry;
+};
+
+} // namespace Mayo
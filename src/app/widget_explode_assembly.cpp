@@ -9,25 +9,48 @@
 #include "../gui/gui_document.h"
 
 #include <QtCore/QSignalBlocker>
+#include <QtCore/QTimer>
+#include <QtGui/QGuiApplication>
+#include <QtGui/QScreen>
+
+#include <algorithm>
+#include <cmath>
 
 namespace Mayo {
 
 WidgetExplodeAssembly::WidgetExplodeAssembly(GuiDocument* guiDoc, QWidget* parent)
     : QWidget(parent),
       m_ui(new Ui_WidgetExplodeAssembly),
-      m_guiDoc(guiDoc)
+      m_guiDoc(guiDoc),
+      m_timerExploding(new QTimer(this))
 {
     m_ui->setupUi(this);
+    m_ui->check_Hierarchical->setChecked(
+                guiDoc->explodingMode() == GuiDocument::ExplodingMode::Hierarchical
+    );
+
+    const QScreen* screen = QGuiApplication::primaryScreen();
+    const double refreshRate = screen && screen->refreshRate() > 0 ? screen->refreshRate() : 60.;
+    m_timerExploding->setSingleShot(true);
+    m_timerExploding->setInterval(std::max(1, int(std::lround(1000. / refreshRate))));
 
     QObject::connect(m_ui->slider_Factor, &QSlider::valueChanged, this, [=](int pct) {
         QSignalBlocker sigBlock(m_ui->edit_Factor);
         m_ui->edit_Factor->setValue(pct);
-        m_guiDoc->setExplodingFactor(pct / 100.);
+        this->requestExplodingFactorUpdate();
     });
     QObject::connect(m_ui->edit_Factor, qOverload<int>(&QSpinBox::valueChanged), this, [=](int pct) {
         QSignalBlocker sigBlock(m_ui->slider_Factor);
         m_ui->slider_Factor->setValue(pct);
-        m_guiDoc->setExplodingFactor(pct / 100.);
+        this->requestExplodingFactorUpdate();
+    });
+    QObject::connect(m_timerExploding, &QTimer::timeout, this, [=]{
+        m_guiDoc->setExplodingFactor(m_ui->edit_Factor->value() / 100.);
+    });
+    QObject::connect(m_ui->check_Hierarchical, &QCheckBox::toggled, this, [=](bool on) {
+        m_guiDoc->setExplodingMode(
+                    on ? GuiDocument::ExplodingMode::Hierarchical : GuiDocument::ExplodingMode::Flat
+        );
     });
 }
 
@@ -36,4 +59,11 @@ WidgetExplodeAssembly::~WidgetExplodeAssembly()
     delete m_ui;
 }
 
+void WidgetExplodeAssembly::requestExplodingFactorUpdate()
+{
+    // Factor is read from the widgets when the timer fires, so intermediate values are dropped
+    if (!m_timerExploding->isActive())
+        m_timerExploding->start();
+}
+
 } // namespace Mayo
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <QtWidgets/QWidget>
+class QTimer;
 
 namespace Mayo {
 
@@ -20,8 +21,12 @@ public:
     ~WidgetExplodeAssembly();
 
 private:
+    void requestExplodingFactorUpdate();
+
     class Ui_WidgetExplodeAssembly* m_ui= nullptr;
     GuiDocument* m_guiDoc = nullptr;
+    // Coalesces factor changes so exploding is applied at most once per display frame
+    QTimer* m_timerExploding = nullptr;
 };
 
 } // namespace Mayo
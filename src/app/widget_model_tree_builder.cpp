@@ -13,41 +13,53 @@
 #include "widget_model_tree.h"
 #include "theme.h"
 
-#include <QtWidgets/QTreeWidget>
-#include <QtWidgets/QTreeWidgetItem>
-
 namespace Mayo {
 
 WidgetModelTreeBuilder::~WidgetModelTreeBuilder()
 {
 }
 
-void WidgetModelTreeBuilder::refreshTextTreeItem(const DocumentPtr& doc, QTreeWidgetItem* treeItem)
+QString WidgetModelTreeBuilder::itemText(const DocumentPtr& doc) const
+{
+    return WidgetModelTreeBuilder::labelText(to_QString(doc->name()));
+}
+
+QIcon WidgetModelTreeBuilder::itemIcon(const DocumentPtr& /*doc*/) const
 {
-    treeItem->setText(0, WidgetModelTreeBuilder::labelText(to_QString(doc->name())));
+    return mayoTheme()->icon(Theme::Icon::File);
 }
 
-void WidgetModelTreeBuilder::refreshTextTreeItem(const DocumentTreeNode& node, QTreeWidgetItem* treeItem)
+QString WidgetModelTreeBuilder::itemToolTip(const DocumentPtr& doc) const
 {
-    treeItem->setText(0, WidgetModelTreeBuilder::labelText(node.label()));
+    return filepathTo<QString>(doc->filePath());
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder::createTreeItem(const DocumentPtr& doc)
+QString WidgetModelTreeBuilder::itemText(const DocumentTreeNode& node) const
 {
-    auto treeItem = new QTreeWidgetItem;
-    treeItem->setText(0, WidgetModelTreeBuilder::labelText(to_QString(doc->name())));
-    treeItem->setIcon(0, mayoTheme()->icon(Theme::Icon::File));
-    treeItem->setToolTip(0, filepathTo<QString>(doc->filePath()));
-    return treeItem;
+    return WidgetModelTreeBuilder::labelText(node.label());
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder::createTreeItem(const DocumentTreeNode& node)
+QIcon WidgetModelTreeBuilder::itemIcon(const DocumentTreeNode& /*node*/) const
 {
-    auto treeItem = new QTreeWidgetItem;
-    treeItem->setText(0, WidgetModelTreeBuilder::labelText(node.label()));
-    treeItem->setFlags(treeItem->flags() | Qt::ItemIsUserCheckable);
-    treeItem->setCheckState(0, Qt::Checked);
-    return treeItem;
+    return QIcon();
+}
+
+bool WidgetModelTreeBuilder::hasChildNodes(const DocumentTreeNode& node) const
+{
+    const DocumentPtr& doc = node.document();
+    return !doc->modelTree().nodeIsLeaf(node.id()) || doc->isModelTreeNodeCollapsed(node.id());
+}
+
+std::vector<TreeNodeId> WidgetModelTreeBuilder::childNodes(const DocumentTreeNode& node) const
+{
+    const DocumentPtr& doc = node.document();
+    doc->expandModelTreeNode(node.id());
+    const Tree<TDF_Label>& modelTree = doc->modelTree();
+    std::vector<TreeNodeId> vecChildId;
+    for (TreeNodeId id = modelTree.nodeChildFirst(node.id()); id != 0; id = modelTree.nodeSiblingNext(id))
+        vecChildId.push_back(id);
+
+    return vecChildId;
 }
 
 std::unique_ptr<WidgetModelTreeBuilder> WidgetModelTreeBuilder::clone() const
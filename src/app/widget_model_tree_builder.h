@@ -12,13 +12,14 @@
 #include "widget_model_tree.h"
 #include <vector>
 #include <QtCore/QString>
+#include <QtGui/QIcon>
 class QAction;
 class QObject;
-class QTreeWidget;
-class QTreeWidgetItem;
 
 namespace Mayo {
 
+class ModelTreeItemModel;
+
 // TODO Rename Builder -> Extension ?
 class WidgetModelTreeBuilder {
 public:
@@ -27,14 +28,20 @@ public:
     virtual bool supportsDocument(const DocumentPtr&) const { return true; }
     virtual bool supportsDocumentTreeNode(const DocumentTreeNode&) const { return true; }
 
-    virtual void refreshTextTreeItem(const DocumentPtr& doc, QTreeWidgetItem* treeItem);
-    virtual void refreshTextTreeItem(const DocumentTreeNode& node, QTreeWidgetItem* treeItem);
+    virtual QString itemText(const DocumentPtr& doc) const;
+    virtual QIcon itemIcon(const DocumentPtr& doc) const;
+    virtual QString itemToolTip(const DocumentPtr& doc) const;
+
+    virtual QString itemText(const DocumentTreeNode& node) const;
+    virtual QIcon itemIcon(const DocumentTreeNode& node) const;
 
-    virtual QTreeWidgetItem* createTreeItem(const DocumentPtr& doc);
-    virtual QTreeWidgetItem* createTreeItem(const DocumentTreeNode& node);
+    // Whether the item of 'node' has child items, must be cheap(no model tree expansion)
+    virtual bool hasChildNodes(const DocumentTreeNode& node) const;
+    // Tree nodes to be displayed as child items of 'node', model tree is expanded as needed
+    virtual std::vector<TreeNodeId> childNodes(const DocumentTreeNode& node) const;
 
-    QTreeWidget* treeWidget() const { return m_treeWidget; }
-    void setTreeWidget(QTreeWidget* tree) { m_treeWidget = tree; }
+    ModelTreeItemModel* itemModel() const { return m_itemModel; }
+    void setItemModel(ModelTreeItemModel* model) { m_itemModel = model; }
 
     virtual WidgetModelTree_UserActions createUserActions(QObject* /*parent*/) { return {}; }
 
@@ -46,7 +53,7 @@ protected:
     static QString labelText(const TDF_Label& label);
 
 private:
-    QTreeWidget* m_treeWidget = nullptr;
+    ModelTreeItemModel* m_itemModel = nullptr;
 };
 
 } // namespace Mayo
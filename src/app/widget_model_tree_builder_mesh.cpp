@@ -10,8 +10,6 @@
 #include "theme.h"
 #include "widget_model_tree.h"
 
-#include <QtWidgets/QTreeWidgetItem>
-
 namespace Mayo {
 
 bool WidgetModelTreeBuilder_Mesh::supportsDocumentTreeNode(const DocumentTreeNode& node) const
@@ -19,13 +17,9 @@ bool WidgetModelTreeBuilder_Mesh::supportsDocumentTreeNode(const DocumentTreeNod
     return GraphicsMeshObjectDriver::meshSupportStatus(node.label()) == GraphicsObjectDriver::Support::Complete;
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder_Mesh::createTreeItem(const DocumentTreeNode& node)
+QIcon WidgetModelTreeBuilder_Mesh::itemIcon(const DocumentTreeNode& /*node*/) const
 {
-    Expects(this->supportsDocumentTreeNode(node));
-
-    auto treeItem = WidgetModelTreeBuilder::createTreeItem(node);
-    treeItem->setIcon(0, mayoTheme()->icon(Theme::Icon::ItemMesh));
-    return treeItem;
+    return mayoTheme()->icon(Theme::Icon::ItemMesh);
 }
 
 std::unique_ptr<WidgetModelTreeBuilder> WidgetModelTreeBuilder_Mesh::clone() const
@@ -11,16 +11,13 @@
 #include "../qtcommon/qstring_conv.h"
 #include "../qtcommon/qtcore_utils.h"
 #include "app_module.h"
+#include "model_tree_item_model.h"
 #include "theme.h"
 #include "widget_model_tree.h"
 
 #include <QActionGroup> // WARNING Qt5 <QtWidgets/...> / Qt6 <QtGui/...>
-#include <QtWidgets/QTreeWidget>
-#include <QtWidgets/QTreeWidgetItemIterator>
 
 #include <fmt/format.h>
-#include <unordered_map>
-#include <unordered_set>
 
 namespace Mayo {
 
@@ -85,35 +82,52 @@ bool WidgetModelTreeBuilder_Xde::supportsDocumentTreeNode(const DocumentTreeNode
     return GraphicsShapeObjectDriver::shapeSupportStatus(node.label()) == GraphicsObjectDriver::Support::Complete;
 }
 
-void WidgetModelTreeBuilder_Xde::refreshTextTreeItem(
-        const DocumentTreeNode& node, QTreeWidgetItem* treeItem)
+// With merging of XDE referred shapes, a reference node and its product node are displayed as a
+// single item: the one of the reference node, which children are those of the product node
+
+QString WidgetModelTreeBuilder_Xde::itemText(const DocumentTreeNode& node) const
 {
-    const TDF_Label labelNode = node.label();
-    TDF_LabelSequence seqLabelRefresh;
-    if (XCaf::isShapeReference(labelNode)
-            && Module::get()->instanceNameTemplate().contains("%product"))
-    {
-        XCAFDoc_ShapeTool::GetUsers(
-                    XCaf::shapeReferred(labelNode),
-                    seqLabelRefresh,
-                    false /* don't get sub children */
-        );
-    }
-    else {
-        seqLabelRefresh.Append(labelNode);
-    }
+    const TDF_Label label = node.label();
+    if (m_isMergeXdeReferredShapeOn && XCaf::isShapeReference(label))
+        return this->referenceItemText(label, XCaf::shapeReferred(label));
 
-    for (const TDF_Label& labelRefresh : seqLabelRefresh) {
-        QTreeWidgetItem* treeItemLabel = this->findTreeItem(treeItem, labelRefresh);
-        if (treeItemLabel)
-            this->refreshXdeAssemblyNodeItemText(treeItemLabel);
-    }
+    return to_QString(CafUtils::labelAttrStdName(label));
+}
+
+QIcon WidgetModelTreeBuilder_Xde::itemIcon(const DocumentTreeNode& node) const
+{
+    const TDF_Label label = node.label();
+    if (m_isMergeXdeReferredShapeOn && XCaf::isShapeReference(label))
+        return Module::shapeIcon(XCaf::shapeReferred(label));
+
+    return Module::shapeIcon(label);
+}
+
+bool WidgetModelTreeBuilder_Xde::hasChildNodes(const DocumentTreeNode& node) const
+{
+    if (!m_isMergeXdeReferredShapeOn || !XCaf::isShapeReference(node.label()))
+        return WidgetModelTreeBuilder::hasChildNodes(node);
+
+    const Tree<TDF_Label>& modelTree = node.document()->modelTree();
+    const TreeNodeId productId = modelTree.nodeChildFirst(node.id());
+    if (productId == 0)
+        return XCaf::isShapeAssembly(XCaf::shapeReferred(node.label()));
+
+    return !modelTree.nodeIsLeaf(productId);
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder_Xde::createTreeItem(const DocumentTreeNode& node)
+std::vector<TreeNodeId> WidgetModelTreeBuilder_Xde::childNodes(const DocumentTreeNode& node) const
 {
-    Expects(this->supportsDocumentTreeNode(node));
-    return this->buildXdeTree(nullptr, node);
+    if (!m_isMergeXdeReferredShapeOn || !XCaf::isShapeReference(node.label()))
+        return WidgetModelTreeBuilder::childNodes(node);
+
+    const DocumentPtr& doc = node.document();
+    doc->expandModelTreeNode(node.id());
+    const TreeNodeId productId = doc->modelTree().nodeChildFirst(node.id());
+    if (productId == 0)
+        return {};
+
+    return WidgetModelTreeBuilder::childNodes(DocumentTreeNode(doc, productId));
 }
 
 WidgetModelTree_UserActions WidgetModelTreeBuilder_Xde::createUserActions(QObject *parent)
@@ -144,74 +158,6 @@ WidgetModelTree_UserActions WidgetModelTreeBuilder_Xde::createUserActions(QObjec
     return userActions;
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder_Xde::guiCreateXdeTreeNode(
-        QTreeWidgetItem* guiParentNode, const DocumentTreeNode& node
-    )
-{
-    auto guiNode = new QTreeWidgetItem(guiParentNode);
-    const QString stdName = to_QString(CafUtils::labelAttrStdName(node.label()));
-    guiNode->setText(0, stdName);
-    WidgetModelTree::setDocumentTreeNode(guiNode, node);
-    const QIcon icon = Module::shapeIcon(node.label());
-    if (!icon.isNull())
-        guiNode->setIcon(0, icon);
-
-    return guiNode;
-}
-
-QTreeWidgetItem* WidgetModelTreeBuilder_Xde::buildXdeTree(
-        QTreeWidgetItem* treeItem, const DocumentTreeNode& node
-    )
-{
-    Expects(node.isEntity());
-
-    std::unordered_map<TreeNodeId, QTreeWidgetItem*> mapNodeIdToTreeItem;
-    std::unordered_set<TreeNodeId> setReferenceNodeId;
-    const DocumentPtr doc = node.document();
-    const Tree<TDF_Label>& modelTree = doc->modelTree();
-    traverseTree(node.id(), modelTree, [&](TreeNodeId itNodeId) {
-        const TreeNodeId nodeParentId = modelTree.nodeParent(itNodeId);
-        auto itParentFound = mapNodeIdToTreeItem.find(nodeParentId);
-        QTreeWidgetItem* guiParentNode =
-                itParentFound != mapNodeIdToTreeItem.end() ? itParentFound->second : treeItem;
-        if (m_isMergeXdeReferredShapeOn) {
-            const TDF_Label& nodeLabel = modelTree.nodeData(itNodeId);
-            if (XCaf::isShapeReference(nodeLabel)) {
-                mapNodeIdToTreeItem[itNodeId] = guiParentNode;
-                setReferenceNodeId.insert(itNodeId);
-            }
-            else {
-                auto guiNode = new QTreeWidgetItem(guiParentNode);
-                QString guiNodeText = to_QString(CafUtils::labelAttrStdName(nodeLabel));
-                TreeNodeId guiNodeId = itNodeId;
-                if (setReferenceNodeId.find(nodeParentId) != setReferenceNodeId.cend()) {
-                    const TDF_Label& refLabel = modelTree.nodeData(nodeParentId);
-                    guiNodeText = this->referenceItemText(refLabel, nodeLabel);
-                    guiNodeId = nodeParentId;
-                    if (!guiParentNode)
-                        mapNodeIdToTreeItem[nodeParentId] = guiNode;
-                }
-
-                guiNode->setText(0, guiNodeText);
-                WidgetModelTree::setDocumentTreeNode(guiNode, DocumentTreeNode(doc, guiNodeId));
-                const QIcon icon = Module::shapeIcon(nodeLabel);
-                if (!icon.isNull())
-                    guiNode->setIcon(0, icon);
-
-                guiNode->setFlags(guiNode->flags() | Qt::ItemIsUserCheckable);
-                guiNode->setCheckState(0, Qt::Checked);
-                mapNodeIdToTreeItem[itNodeId] = guiNode;
-            }
-        }
-        else {
-            auto guiNode = ThisType::guiCreateXdeTreeNode(guiParentNode, { doc, itNodeId });
-            mapNodeIdToTreeItem[itNodeId] = guiNode;
-        }
-    });
-
-    return mapNodeIdToTreeItem.find(node.id())->second;
-}
-
 QByteArray WidgetModelTreeBuilder_Xde::instanceNameFormat() const
 {
     return QtCoreUtils::QByteArray_fromRawData(Module::get()->instanceNameFormat.valueName());
@@ -223,10 +169,8 @@ void WidgetModelTreeBuilder_Xde::setInstanceNameFormat(const QByteArray& format)
         return;
 
     Module::get()->instanceNameFormat.setValueByName(format.constData());
-    for (QTreeWidgetItemIterator it(this->treeWidget()); *it; ++it) {
-        if (WidgetModelTree::holdsDocumentTreeNode(*it))
-            this->refreshXdeAssemblyNodeItemText(*it);
-    }
+    if (this->itemModel())
+        this->itemModel()->refreshItemTexts();
 }
 
 std::unique_ptr<WidgetModelTreeBuilder> WidgetModelTreeBuilder_Xde::clone() const
@@ -236,21 +180,6 @@ std::unique_ptr<WidgetModelTreeBuilder> WidgetModelTreeBuilder_Xde::clone() cons
     return builder;
 }
 
-void WidgetModelTreeBuilder_Xde::refreshXdeAssemblyNodeItemText(QTreeWidgetItem* item)
-{
-    const DocumentTreeNode docTreeNode = WidgetModelTree::documentTreeNode(item);
-    const TDF_Label label = docTreeNode.label();
-    if (XCaf::isShapeReference(label)) {
-        const TDF_Label& instanceLabel = label;
-        const TDF_Label productLabel = XCaf::shapeReferred(instanceLabel);
-        const QString itemText = this->referenceItemText(instanceLabel, productLabel);
-        item->setText(0, itemText);
-    }
-    else {
-        item->setText(0, to_QString(CafUtils::labelAttrStdName(label)));
-    }
-}
-
 QString WidgetModelTreeBuilder_Xde::referenceItemText(
         const TDF_Label& instanceLabel, const TDF_Label& productLabel
     ) const
@@ -264,20 +193,4 @@ QString WidgetModelTreeBuilder_Xde::referenceItemText(
     return itemText;
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder_Xde::findTreeItem(
-        QTreeWidgetItem* parentTreeItem, const TDF_Label& label
-    ) const
-{
-    if (!parentTreeItem)
-        return nullptr;
-
-    for (QTreeWidgetItemIterator it(parentTreeItem); *it; ++it) {
-        const DocumentTreeNode node = WidgetModelTree::documentTreeNode(*it);
-        if (node.label() == label)
-            return *it;
-    }
-
-    return nullptr;
-}
-
 } // namespace Mayo
@@ -6,80 +6,90 @@
 
 #include "application_item_selection_model.h"
 
-namespace Mayo {
-
-namespace Internal {
-
-static bool hasApplicationItem(Span<ApplicationItem> vec, const ApplicationItem& item)
-{
-    auto itFound = std::find(vec.begin(), vec.end(), item);
-    return itFound != vec.end();
-}
-
-static std::vector<ApplicationItem>::iterator findApplicationItem(
-        std::vector<ApplicationItem>& vec, const ApplicationItem& item)
-{
-    return std::find(vec.begin(), vec.end(), item);
-}
+#include <algorithm>
 
-} // namespace Internal
+namespace Mayo {
 
 Span<const ApplicationItem> ApplicationItemSelectionModel::selectedItems() const
 {
     return m_vecSelectedItem;
 }
 
-bool ApplicationItemSelectionModel::isSelected(const ApplicationItem& item)
+bool ApplicationItemSelectionModel::isSelected(const ApplicationItem& item) const
 {
-    return Internal::hasApplicationItem(m_vecSelectedItem, item);
+    return m_setSelectedItem.find(item) != m_setSelectedItem.cend();
 }
 
 void ApplicationItemSelectionModel::add(const ApplicationItem& item)
 {
-    if (!Internal::hasApplicationItem(m_vecSelectedItem, item)) {
+    if (m_setSelectedItem.insert(item).second) {
         m_vecSelectedItem.push_back(item);
         std::vector<ApplicationItem> vecItem = { item };
         this->signalChanged.send(vecItem, {});
     }
 }
 
-void ApplicationItemSelectionModel::add(Span<ApplicationItem> vecItem)
+void ApplicationItemSelectionModel::add(Span<const ApplicationItem> vecItem)
 {
-    std::vector<ApplicationItem> signalVecItem;
-    for (const ApplicationItem& item : vecItem) {
-        if (!Internal::hasApplicationItem(m_vecSelectedItem, item)) {
-            m_vecSelectedItem.push_back(item);
-            signalVecItem.push_back(item);
-        }
-    }
-
-    if (!signalVecItem.empty())
-        this->signalChanged.send(signalVecItem, {});
+    this->change(vecItem, {});
 }
 
 void ApplicationItemSelectionModel::remove(const ApplicationItem& item)
 {
-    auto itFound = Internal::findApplicationItem(m_vecSelectedItem, item);
-    if (itFound != m_vecSelectedItem.end()) {
+    if (m_setSelectedItem.erase(item) != 0) {
+        auto itFound = std::find(m_vecSelectedItem.begin(), m_vecSelectedItem.end(), item);
         m_vecSelectedItem.erase(itFound);
         std::vector<ApplicationItem> vecItem = { item };
         this->signalChanged.send({}, vecItem);
     }
 }
 
-void ApplicationItemSelectionModel::remove(Span<ApplicationItem> vecItem)
+void ApplicationItemSelectionModel::remove(Span<const ApplicationItem> vecItem)
+{
+    this->change({}, vecItem);
+}
+
+void ApplicationItemSelectionModel::change(
+        Span<const ApplicationItem> vecSelected, Span<const ApplicationItem> vecDeselected
+    )
 {
-    std::vector<ApplicationItem> signalVecItem;
-    for (const ApplicationItem& item : vecItem) {
-        auto itFound = Internal::findApplicationItem(m_vecSelectedItem, item);
-        if (itFound != m_vecSelectedItem.end()) {
-            m_vecSelectedItem.erase(itFound);
-            signalVecItem.push_back(item);
+    std::vector<ApplicationItem> signalVecDeselected;
+    for (const ApplicationItem& item : vecDeselected) {
+        if (m_setSelectedItem.erase(item) != 0)
+            signalVecDeselected.push_back(item);
+    }
+
+    // Compact the ordered vector once for the whole batch
+    if (!signalVecDeselected.empty()) {
+        auto itEnd = std::remove_if(
+            m_vecSelectedItem.begin(), m_vecSelectedItem.end(),
+            [=](const ApplicationItem& item) { return !this->isSelected(item); }
+        );
+        m_vecSelectedItem.erase(itEnd, m_vecSelectedItem.end());
+    }
+
+    std::vector<ApplicationItem> signalVecSelected;
+    for (const ApplicationItem& item : vecSelected) {
+        if (m_setSelectedItem.insert(item).second) {
+            m_vecSelectedItem.push_back(item);
+            signalVecSelected.push_back(item);
         }
     }
 
-    if (!signalVecItem.empty())
-        this->signalChanged.send({}, signalVecItem);
+    if (!signalVecSelected.empty() || !signalVecDeselected.empty())
+        this->signalChanged.send(signalVecSelected, signalVecDeselected);
+}
+
+void ApplicationItemSelectionModel::replace(Span<const ApplicationItem> vecItem)
+{
+    const std::unordered_set<ApplicationItem> setItem(vecItem.begin(), vecItem.end());
+    std::vector<ApplicationItem> vecDeselected;
+    for (const ApplicationItem& item : m_vecSelectedItem) {
+        if (setItem.find(item) == setItem.cend())
+            vecDeselected.push_back(item);
+    }
+
+    this->change(vecItem, vecDeselected);
 }
 
 void ApplicationItemSelectionModel::clear()
@@ -88,8 +98,23 @@ void ApplicationItemSelectionModel::clear()
         // Warning: slots connected to changed() signal may indirectly access m_vecSelectedItem
         const auto vecDeselectedItem = m_vecSelectedItem;
         m_vecSelectedItem.clear();
+        m_setSelectedItem.clear();
         this->signalChanged.send({}, vecDeselectedItem);
     }
 }
 
+void ApplicationItemSelectionModel::remap(const std::function<ApplicationItem(const ApplicationItem&)>& fnRemap)
+{
+    std::vector<ApplicationItem> vecSelectedItem;
+    vecSelectedItem.reserve(m_vecSelectedItem.size());
+    m_setSelectedItem.clear();
+    for (const ApplicationItem& item : m_vecSelectedItem) {
+        ApplicationItem newItem = fnRemap(item);
+        if (newItem.isValid() && m_setSelectedItem.insert(newItem).second)
+            vecSelectedItem.push_back(std::move(newItem));
+    }
+
+    m_vecSelectedItem = std::move(vecSelectedItem);
+}
+
 } // namespace Mayo
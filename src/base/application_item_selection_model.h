@@ -10,28 +10,48 @@
 #include "signal.h"
 #include "span.h"
 
+#include <functional>
+#include <unordered_set>
+#include <vector>
+
 namespace Mayo {
 
 // Keeps track of the items selected in an Application object
+// Selected items are kept in insertion order, membership lookup is done in constant time
+// Bulk functions emit signalChanged() once per call
 class ApplicationItemSelectionModel {
 public:
     Span<const ApplicationItem> selectedItems() const;
 
-    bool isSelected(const ApplicationItem& item);
+    bool isSelected(const ApplicationItem& item) const;
 
     void add(const ApplicationItem& item);
-    void add(Span<ApplicationItem> vecItem);
+    void add(Span<const ApplicationItem> vecItem);
     void remove(const ApplicationItem& item);
-    void remove(Span<ApplicationItem> vecItem);
+    void remove(Span<const ApplicationItem> vecItem);
 //    void toggle(const ApplicationItem& item);
 //    void toggle(Span<ApplicationItem> item);
 
+    // Removes items 'vecDeselected' then adds items 'vecSelected'
+    void change(Span<const ApplicationItem> vecSelected, Span<const ApplicationItem> vecDeselected);
+
+    // Selection becomes exactly items 'vecItem'
+    void replace(Span<const ApplicationItem> vecItem);
+
     void clear();
 
+    // Replaces each selected item by 'fnRemap(item)', items remapped to an invalid item are dropped
+    // signalChanged isn't emitted: this is intended for identifier changes(eg compaction of a
+    // document model tree), the selection itself is unchanged
+    void remap(const std::function<ApplicationItem(const ApplicationItem&)>& fnRemap);
+
+    // 1st arg: items added to selection
+    // 2nd arg: items removed from selection
     Signal<Span<const ApplicationItem>, Span<const ApplicationItem>> signalChanged;
 
 private:
     std::vector<ApplicationItem> m_vecSelectedItem;
+    std::unordered_set<ApplicationItem> m_setSelectedItem;
 };
 
 } // namespace Mayo
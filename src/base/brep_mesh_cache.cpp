@@ -0,0 +1,629 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "brep_mesh_cache.h"
+
+#include "file_memory_map.h"
+#include "mesh_utils.h"
+#include "occ_handle.h"
+
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <OSD_Parallel.hxx>
+#include <Poly_PolygonOnTriangulation.hxx>
+#include <TColStd_Array1OfInteger.hxx>
+#include <TColStd_Array1OfReal.hxx>
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Edge.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Mayo {
+
+namespace {
+
+// Binary format of cache files
+//     Header: magic number, version, face count
+//     For each face: node count, triangle count, UV flag, deflection, nodes, triangles, UV nodes,
+//                    edge count, polygons on triangulation of the edges
+//     For each edge: node count, parameters flag, deflection, node indices, parameters
+constexpr std::uint32_t CacheFileMagic = 0x4d424d43; // "CMBM"
+constexpr std::uint32_t CacheFileVersion = 2;
+constexpr std::string_view CacheFileExtension = ".brepmesh";
+
+// Minimum delay between two evictions triggered by BRepMeshCache::store()
+constexpr std::chrono::seconds EvictInterval(60);
+
+// FNV-1a based hashing, processing 8-byte words
+// std::hash<> isn't used as its result isn't guaranteed to be stable across runs/platforms
+constexpr std::uint64_t HashOffsetBasis = 14695981039346656037ULL;
+constexpr std::uint64_t HashPrime = 1099511628211ULL;
+
+std::uint64_t hashCombine(std::uint64_t hash, std::uint64_t word)
+{
+    return (hash ^ word) * HashPrime;
+}
+
+std::uint64_t hashBytes(std::string_view bytes)
+{
+    std::uint64_t hash = HashOffsetBasis;
+    const std::size_t wordCount = bytes.size() / sizeof(std::uint64_t);
+    for (std::size_t i = 0; i < wordCount; ++i) {
+        std::uint64_t word;
+        std::memcpy(&word, bytes.data() + i * sizeof(std::uint64_t), sizeof(std::uint64_t));
+        hash = hashCombine(hash, word);
+    }
+
+    for (std::size_t i = wordCount * sizeof(std::uint64_t); i < bytes.size(); ++i)
+        hash = hashCombine(hash, static_cast<unsigned char>(bytes[i]));
+
+    return hash;
+}
+
+std::uint64_t hashDouble(std::uint64_t hash, double value)
+{
+    std::uint64_t word;
+    std::memcpy(&word, &value, sizeof(double));
+    return hashCombine(hash, word);
+}
+
+// Returns the faces of 'shape' without location, each underlying TShape is visited only once
+std::vector<TopoDS_Face> uniqueFaces(const TopoDS_Shape& shape)
+{
+    TopTools_IndexedMapOfShape mapFace;
+    TopExp::MapShapes(shape, TopAbs_FACE, mapFace);
+    std::vector<TopoDS_Face> vecFace;
+    vecFace.reserve(mapFace.Extent());
+    std::unordered_set<const TopoDS_TShape*> setTShape;
+    for (int i = 1; i <= mapFace.Extent(); ++i) {
+        const TopoDS_Shape& face = mapFace.FindKey(i);
+        if (setTShape.insert(face.TShape().get()).second) {
+            TopoDS_Face faceNoLoc = TopoDS::Face(face);
+            faceNoLoc.Location(TopLoc_Location());
+            vecFace.push_back(faceNoLoc);
+        }
+    }
+
+    return vecFace;
+}
+
+// Cheap identification of a shape: count of faces and positions of vertices
+std::uint64_t shapeFingerprint(const TopoDS_Shape& shape)
+{
+    std::uint64_t hash = hashCombine(HashOffsetBasis, uniqueFaces(shape).size());
+    TopTools_IndexedMapOfShape mapVertex;
+    TopExp::MapShapes(shape, TopAbs_VERTEX, mapVertex);
+    for (int i = 1; i <= mapVertex.Extent(); ++i) {
+        const gp_Pnt pnt = BRep_Tool::Pnt(TopoDS::Vertex(mapVertex.FindKey(i)));
+        hash = hashDouble(hash, pnt.X());
+        hash = hashDouble(hash, pnt.Y());
+        hash = hashDouble(hash, pnt.Z());
+    }
+
+    return hash;
+}
+
+template<typename T> void writeValue(std::ostream& ostr, T value)
+{
+    ostr.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T> bool readValue(std::istream& istr, T* value)
+{
+    return static_cast<bool>(istr.read(reinterpret_cast<char*>(value), sizeof(T)));
+}
+
+template<typename T> void writeArray(std::ostream& ostr, const std::vector<T>& vec)
+{
+    ostr.write(reinterpret_cast<const char*>(vec.data()), vec.size() * sizeof(T));
+}
+
+template<typename T> bool readArray(std::istream& istr, std::vector<T>* vec, std::size_t count)
+{
+    vec->resize(count);
+    return static_cast<bool>(istr.read(reinterpret_cast<char*>(vec->data()), count * sizeof(T)));
+}
+
+OccHandle<Poly_Triangulation> readTriangulation(std::istream& istr)
+{
+    std::int32_t nodeCount = 0;
+    std::int32_t triangleCount = 0;
+    std::uint8_t hasUvNodes = 0;
+    double deflection = 0;
+    if (!readValue(istr, &nodeCount)
+        || !readValue(istr, &triangleCount)
+        || !readValue(istr, &hasUvNodes)
+        || !readValue(istr, &deflection)
+        || nodeCount < 0
+        || triangleCount < 0)
+    {
+        throw std::runtime_error("Corrupted face header");
+    }
+
+    if (nodeCount == 0)
+        return {}; // Face without triangulation
+
+    std::vector<double> vecCoord;
+    std::vector<std::int32_t> vecIndex;
+    std::vector<double> vecUv;
+    if (!readArray(istr, &vecCoord, 3 * std::size_t(nodeCount))
+        || !readArray(istr, &vecIndex, 3 * std::size_t(triangleCount))
+        || (hasUvNodes && !readArray(istr, &vecUv, 2 * std::size_t(nodeCount))))
+    {
+        throw std::runtime_error("Truncated face data");
+    }
+
+    auto triangulation = makeOccHandle<Poly_Triangulation>(nodeCount, triangleCount, hasUvNodes != 0);
+    triangulation->Deflection(deflection);
+    for (int i = 0; i < nodeCount; ++i) {
+        const double* coords = &vecCoord.at(3 * i);
+        MeshUtils::setNode(triangulation, i + 1, { coords[0], coords[1], coords[2] });
+    }
+
+    for (int i = 0; i < triangleCount; ++i) {
+        const std::int32_t* indices = &vecIndex.at(3 * i);
+        for (int j = 0; j < 3; ++j) {
+            if (indices[j] < 1 || indices[j] > nodeCount)
+                throw std::runtime_error("Invalid triangle node index");
+        }
+
+        MeshUtils::setTriangle(triangulation, i + 1, { indices[0], indices[1], indices[2] });
+    }
+
+    for (int i = 0; hasUvNodes && i < nodeCount; ++i)
+        MeshUtils::setUvNode(triangulation, i + 1, vecUv.at(2 * i), vecUv.at(2 * i + 1));
+
+    return triangulation;
+}
+
+// Edges of 'face' in exploration order, seam edges appear twice(once per orientation)
+std::vector<TopoDS_Edge> faceEdges(const TopoDS_Face& face)
+{
+    std::vector<TopoDS_Edge> vecEdge;
+    for (TopExp_Explorer exp(face, TopAbs_EDGE); exp.More(); exp.Next())
+        vecEdge.push_back(TopoDS::Edge(exp.Current()));
+
+    return vecEdge;
+}
+
+OccHandle<Poly_PolygonOnTriangulation> readPolygonOnTriangulation(std::istream& istr, int triangulationNodeCount)
+{
+    std::int32_t nodeCount = 0;
+    std::uint8_t hasParameters = 0;
+    double deflection = 0;
+    if (!readValue(istr, &nodeCount)
+        || !readValue(istr, &hasParameters)
+        || !readValue(istr, &deflection)
+        || nodeCount < 0)
+    {
+        throw std::runtime_error("Corrupted edge header");
+    }
+
+    if (nodeCount == 0)
+        return {}; // Edge without polygon
+
+    std::vector<std::int32_t> vecNodeIndex;
+    std::vector<double> vecParameter;
+    if (!readArray(istr, &vecNodeIndex, std::size_t(nodeCount))
+        || (hasParameters && !readArray(istr, &vecParameter, std::size_t(nodeCount))))
+    {
+        throw std::runtime_error("Truncated edge data");
+    }
+
+    TColStd_Array1OfInteger arrayNodeIndex(1, nodeCount);
+    for (int i = 0; i < nodeCount; ++i) {
+        if (vecNodeIndex.at(i) < 1 || vecNodeIndex.at(i) > triangulationNodeCount)
+            throw std::runtime_error("Invalid edge node index");
+
+        arrayNodeIndex.ChangeValue(i + 1) = vecNodeIndex.at(i);
+    }
+
+    OccHandle<Poly_PolygonOnTriangulation> polygon;
+    if (hasParameters) {
+        TColStd_Array1OfReal arrayParameter(1, nodeCount);
+        for (int i = 0; i < nodeCount; ++i)
+            arrayParameter.ChangeValue(i + 1) = vecParameter.at(i);
+
+        polygon = makeOccHandle<Poly_PolygonOnTriangulation>(arrayNodeIndex, arrayParameter);
+    }
+    else {
+        polygon = makeOccHandle<Poly_PolygonOnTriangulation>(arrayNodeIndex);
+    }
+
+    polygon->Deflection(deflection);
+    return polygon;
+}
+
+void writePolygonOnTriangulation(std::ostream& ostr, const OccHandle<Poly_PolygonOnTriangulation>& polygon)
+{
+    if (!polygon) {
+        writeValue<std::int32_t>(ostr, 0);
+        writeValue<std::uint8_t>(ostr, 0);
+        writeValue<double>(ostr, 0.);
+        return;
+    }
+
+    const int nodeCount = polygon->NbNodes();
+    const bool hasParameters = polygon->HasParameters();
+    writeValue<std::int32_t>(ostr, nodeCount);
+    writeValue<std::uint8_t>(ostr, hasParameters ? 1 : 0);
+    writeValue<double>(ostr, polygon->Deflection());
+    std::vector<std::int32_t> vecNodeIndex;
+    vecNodeIndex.reserve(nodeCount);
+    for (int i = 1; i <= nodeCount; ++i) {
+#if OCC_VERSION_HEX >= 0x070600
+        vecNodeIndex.push_back(polygon->Node(i));
+#else
+        vecNodeIndex.push_back(polygon->Nodes().Value(i));
+#endif
+    }
+
+    writeArray(ostr, vecNodeIndex);
+    if (hasParameters) {
+        std::vector<double> vecParameter;
+        vecParameter.reserve(nodeCount);
+        for (int i = 1; i <= nodeCount; ++i) {
+#if OCC_VERSION_HEX >= 0x070600
+            vecParameter.push_back(polygon->Parameter(i));
+#else
+            vecParameter.push_back(polygon->Parameters()->Value(i));
+#endif
+        }
+
+        writeArray(ostr, vecParameter);
+    }
+}
+
+void writeTriangulation(std::ostream& ostr, const OccHandle<Poly_Triangulation>& triangulation)
+{
+    if (!triangulation) {
+        writeValue<std::int32_t>(ostr, 0);
+        writeValue<std::int32_t>(ostr, 0);
+        writeValue<std::uint8_t>(ostr, 0);
+        writeValue<double>(ostr, 0.);
+        return;
+    }
+
+    const int nodeCount = triangulation->NbNodes();
+    const int triangleCount = triangulation->NbTriangles();
+    const bool hasUvNodes = triangulation->HasUVNodes();
+    writeValue<std::int32_t>(ostr, nodeCount);
+    writeValue<std::int32_t>(ostr, triangleCount);
+    writeValue<std::uint8_t>(ostr, hasUvNodes ? 1 : 0);
+    writeValue<double>(ostr, triangulation->Deflection());
+
+    std::vector<double> vecCoord;
+    vecCoord.reserve(3 * nodeCount);
+    for (int i = 1; i <= nodeCount; ++i) {
+        const gp_Pnt pnt = triangulation->Node(i);
+        vecCoord.insert(vecCoord.end(), { pnt.X(), pnt.Y(), pnt.Z() });
+    }
+
+    std::vector<std::int32_t> vecIndex;
+    vecIndex.reserve(3 * triangleCount);
+    for (const Poly_Triangle& triangle : MeshUtils::triangles(triangulation)) {
+        int n1, n2, n3;
+        triangle.Get(n1, n2, n3);
+        vecIndex.insert(vecIndex.end(), { n1, n2, n3 });
+    }
+
+    writeArray(ostr, vecCoord);
+    writeArray(ostr, vecIndex);
+    if (hasUvNodes) {
+        std::vector<double> vecUv;
+        vecUv.reserve(2 * nodeCount);
+        for (int i = 1; i <= nodeCount; ++i) {
+            const gp_Pnt2d uv = triangulation->UVNode(i);
+            vecUv.insert(vecUv.end(), { uv.X(), uv.Y() });
+        }
+
+        writeArray(ostr, vecUv);
+    }
+}
+
+} // namespace
+
+BRepMeshCache::BRepMeshCache(const FilePath& dirPath)
+    : m_dirPath(dirPath)
+{
+}
+
+void BRepMeshCache::setDirectory(const FilePath& dirPath)
+{
+    m_dirPath = dirPath;
+}
+
+std::string BRepMeshCache::key(
+        const FilePath& sourceFilepath, const OccBRepMeshParameters& params, const TopoDS_Shape& shape
+    )
+{
+    const std::uint64_t contentsHash = BRepMeshCache::fileContentsHash(sourceFilepath);
+    if (contentsHash == 0)
+        return {};
+
+    std::uint64_t paramsHash = HashOffsetBasis;
+    paramsHash = hashDouble(paramsHash, params.Deflection);
+    paramsHash = hashDouble(paramsHash, params.Angle);
+    paramsHash = hashCombine(paramsHash, params.Relative ? 1 : 0);
+#if OCC_VERSION_HEX >= 0x070400
+    paramsHash = hashDouble(paramsHash, params.DeflectionInterior);
+    paramsHash = hashDouble(paramsHash, params.AngleInterior);
+    paramsHash = hashDouble(paramsHash, params.MinSize);
+    paramsHash = hashCombine(paramsHash, params.InternalVerticesMode ? 1 : 0);
+    paramsHash = hashCombine(paramsHash, params.ControlSurfaceDeflection ? 1 : 0);
+#endif
+
+    return fmt::format("{:016x}-{:016x}-{:016x}", contentsHash, paramsHash, shapeFingerprint(shape));
+}
+
+bool BRepMeshCache::restore(const std::string& key, const TopoDS_Shape& shape)
+{
+    if (key.empty() || m_dirPath.empty())
+        return false;
+
+    const FilePath filepath = this->entryFilepath(key);
+    std::ifstream ifs(filepath, std::ios::binary);
+    if (!ifs.is_open())
+        return false;
+
+    const std::vector<TopoDS_Face> vecFace = uniqueFaces(shape);
+    std::vector<OccHandle<Poly_Triangulation>> vecTriangulation;
+    // Indexed by face, then by edge as returned by faceEdges()
+    std::vector<std::vector<OccHandle<Poly_PolygonOnTriangulation>>> vecFacePolygons;
+    try {
+        std::uint32_t magic = 0;
+        std::uint32_t version = 0;
+        std::uint32_t faceCount = 0;
+        if (!readValue(ifs, &magic) || !readValue(ifs, &version) || !readValue(ifs, &faceCount))
+            return false;
+
+        if (magic != CacheFileMagic || version != CacheFileVersion || faceCount != vecFace.size())
+            return false;
+
+        vecTriangulation.reserve(faceCount);
+        vecFacePolygons.resize(faceCount);
+        for (std::uint32_t i = 0; i < faceCount; ++i) {
+            const OccHandle<Poly_Triangulation> triangulation = readTriangulation(ifs);
+            const int triangulationNodeCount = triangulation ? triangulation->NbNodes() : 0;
+            std::uint32_t edgeCount = 0;
+            if (!readValue(ifs, &edgeCount) || edgeCount != faceEdges(vecFace.at(i)).size())
+                return false;
+
+            for (std::uint32_t j = 0; j < edgeCount; ++j)
+                vecFacePolygons.at(i).push_back(readPolygonOnTriangulation(ifs, triangulationNodeCount));
+
+            vecTriangulation.push_back(triangulation);
+        }
+    }
+    catch (...) {
+        return false; // Corrupted file, will be overwritten by next store()
+    }
+
+    // All data is valid, attach triangulations to faces and polygons to edges
+    BRep_Builder builder;
+    for (std::size_t i = 0; i < vecFace.size(); ++i) {
+        const TopoDS_Face& face = vecFace.at(i);
+        const OccHandle<Poly_Triangulation>& triangulation = vecTriangulation.at(i);
+        if (!triangulation)
+            continue;
+
+        builder.UpdateFace(face, triangulation);
+        const TopLoc_Location locTriangulation = face.Location();
+        const std::vector<TopoDS_Edge> vecEdge = faceEdges(face);
+        const auto& vecPolygon = vecFacePolygons.at(i);
+        for (std::size_t j = 0; j < vecEdge.size(); ++j) {
+            const TopoDS_Edge& edge = vecEdge.at(j);
+            const bool isSeamEdge = BRep_Tool::IsClosed(edge, face);
+            if (!vecPolygon.at(j) || (isSeamEdge && edge.Orientation() == TopAbs_REVERSED))
+                continue; // Reversed occurrence of a seam edge is handled with the forward one
+
+            if (isSeamEdge) {
+                // Polygon of the reversed occurrence is the second one of the seam edge
+                OccHandle<Poly_PolygonOnTriangulation> polygonReversed;
+                for (std::size_t k = 0; k < vecEdge.size() && !polygonReversed; ++k) {
+                    if (k != j && vecEdge.at(k).IsSame(edge))
+                        polygonReversed = vecPolygon.at(k);
+                }
+
+                if (polygonReversed)
+                    builder.UpdateEdge(edge, vecPolygon.at(j), polygonReversed, triangulation, locTriangulation);
+            }
+            else {
+                builder.UpdateEdge(edge, vecPolygon.at(j), triangulation, locTriangulation);
+            }
+        }
+    }
+
+    // Keep recently used entries from being evicted first
+    std::error_code ec;
+    std_filesystem::last_write_time(filepath, std_filesystem::file_time_type::clock::now(), ec);
+    return true;
+}
+
+bool BRepMeshCache::store(const std::string& key, const TopoDS_Shape& shape)
+{
+    if (key.empty() || m_dirPath.empty())
+        return false;
+
+    std::error_code ec;
+    std_filesystem::create_directories(m_dirPath, ec);
+    const FilePath filepath = this->entryFilepath(key);
+    FilePath tempFilepath = filepath;
+    tempFilepath += ".tmp";
+    {
+        std::ofstream ofs(tempFilepath, std::ios::binary | std::ios::trunc);
+        if (!ofs.is_open())
+            return false;
+
+        const std::vector<TopoDS_Face> vecFace = uniqueFaces(shape);
+        writeValue<std::uint32_t>(ofs, CacheFileMagic);
+        writeValue<std::uint32_t>(ofs, CacheFileVersion);
+        writeValue<std::uint32_t>(ofs, static_cast<std::uint32_t>(vecFace.size()));
+        for (const TopoDS_Face& face : vecFace) {
+            TopLoc_Location loc;
+            const OccHandle<Poly_Triangulation> triangulation = BRep_Tool::Triangulation(face, loc);
+            writeTriangulation(ofs, triangulation);
+            const std::vector<TopoDS_Edge> vecEdge = faceEdges(face);
+            writeValue<std::uint32_t>(ofs, static_cast<std::uint32_t>(vecEdge.size()));
+            for (const TopoDS_Edge& edge : vecEdge) {
+                OccHandle<Poly_PolygonOnTriangulation> polygon;
+                if (triangulation)
+                    polygon = BRep_Tool::PolygonOnTriangulation(edge, triangulation, loc);
+
+                writePolygonOnTriangulation(ofs, polygon);
+            }
+        }
+
+        if (!ofs.good()) {
+            ofs.close();
+            std_filesystem::remove(tempFilepath, ec);
+            return false;
+        }
+    }
+
+    // Rename is atomic so concurrent readers never see partially written files
+    std_filesystem::rename(tempFilepath, filepath, ec);
+    if (ec) {
+        std_filesystem::remove(tempFilepath, ec);
+        return false;
+    }
+
+    this->evictIfDue();
+    return true;
+}
+
+void BRepMeshCache::evict()
+{
+    std::lock_guard<std::mutex> lock(m_mutexEvict);
+    this->evictUnlocked();
+}
+
+void BRepMeshCache::evictIfDue()
+{
+    // Skip if some other thread is already evicting
+    std::unique_lock<std::mutex> lock(m_mutexEvict, std::try_to_lock);
+    if (!lock.owns_lock())
+        return;
+
+    const auto now = std::chrono::steady_clock::now();
+    if (m_lastEvictTime != std::chrono::steady_clock::time_point{} && now - m_lastEvictTime < EvictInterval)
+        return;
+
+    this->evictUnlocked();
+}
+
+void BRepMeshCache::evictUnlocked()
+{
+    m_lastEvictTime = std::chrono::steady_clock::now();
+    if (m_dirPath.empty())
+        return;
+
+    struct CacheFile {
+        FilePath path;
+        std::uintmax_t size = 0;
+        std_filesystem::file_time_type time;
+    };
+    std::vector<CacheFile> vecFile;
+    std::error_code ec;
+    const std::uintmax_t maxSize = m_maxSize;
+    const std::chrono::seconds maxAge = m_maxAge;
+    const auto now = std_filesystem::file_time_type::clock::now();
+    for (const auto& entry : std_filesystem::directory_iterator(m_dirPath, ec)) {
+        if (!entry.is_regular_file(ec) || entry.path().extension() != CacheFileExtension)
+            continue; // Skip
+
+        CacheFile file;
+        file.path = entry.path();
+        file.size = entry.file_size(ec);
+        file.time = entry.last_write_time(ec);
+        if (now - file.time > maxAge)
+            std_filesystem::remove(file.path, ec);
+        else
+            vecFile.push_back(std::move(file));
+    }
+
+    std::uintmax_t totalSize = 0;
+    for (const CacheFile& file : vecFile)
+        totalSize += file.size;
+
+    if (totalSize <= maxSize)
+        return;
+
+    std::sort(vecFile.begin(), vecFile.end(), [](const CacheFile& lhs, const CacheFile& rhs) {
+        return lhs.time < rhs.time;
+    });
+    for (const CacheFile& file : vecFile) {
+        if (totalSize <= maxSize)
+            break;
+
+        if (std_filesystem::remove(file.path, ec))
+            totalSize -= file.size;
+    }
+}
+
+std::uint64_t BRepMeshCache::fileContentsHash(const FilePath& filepath)
+{
+    struct FileHash {
+        std::uintmax_t size = 0;
+        std_filesystem::file_time_type time;
+        std::uint64_t hash = 0;
+    };
+    static std::mutex mutexFileHash;
+    static std::unordered_map<std::string, FileHash> mapFileHash;
+
+    const std::string strFilepath = filepath.u8string();
+    const std::uintmax_t fileSize = filepathFileSize(filepath);
+    const auto fileTime = filepathLastWriteTime(filepath);
+    {
+        std::lock_guard<std::mutex> lock(mutexFileHash);
+        auto it = mapFileHash.find(strFilepath);
+        if (it != mapFileHash.end() && it->second.size == fileSize && it->second.time == fileTime)
+            return it->second.hash;
+    }
+
+    FileMemoryMap fileMap;
+    if (!fileMap.open(filepath))
+        return 0;
+
+    // Hash chunks of the file in parallel, then combine chunk hashes in order
+    const std::string_view contents = fileMap.contents();
+    constexpr std::size_t ChunkSize = 16 * 1024 * 1024;
+    const std::size_t chunkCount = (contents.size() + ChunkSize - 1) / ChunkSize;
+    std::vector<std::uint64_t> vecChunkHash(chunkCount);
+    OSD_Parallel::For(0, static_cast<int>(chunkCount), [&](int i) {
+        vecChunkHash.at(i) = hashBytes(contents.substr(i * ChunkSize, ChunkSize));
+    });
+
+    std::uint64_t hash = hashCombine(HashOffsetBasis, contents.size());
+    for (std::uint64_t chunkHash : vecChunkHash)
+        hash = hashCombine(hash, chunkHash);
+
+    hash = std::max<std::uint64_t>(hash, 1); // 0 is reserved for errors
+    std::lock_guard<std::mutex> lock(mutexFileHash);
+    mapFileHash.insert_or_assign(strFilepath, FileHash{ fileSize, fileTime, hash });
+    return hash;
+}
+
+FilePath BRepMeshCache::entryFilepath(const std::string& key) const
+{
+    FilePath filepath = m_dirPath / key;
+    filepath += CacheFileExtension;
+    return filepath;
+}
+
+} // namespace Mayo
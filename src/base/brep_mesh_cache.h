@@ -0,0 +1,81 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "filepath.h"
+#include "occ_brep_mesh_parameters.h"
+
+#include <TopoDS_Shape.hxx>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace Mayo {
+
+// Persistent on-disk cache of BRep shape tessellations
+//
+// Triangulations of the faces of a shape, along with the polygons of the edges on these
+// triangulations, are stored in a binary file, keyed by the contents of the source file the shape
+// was read from, the BRep mesh parameters and a fingerprint of the shape
+// On cache hit, triangulations and polygons are attached back to the shape so meshing can be skipped
+//
+// Eviction of the cache files is done by store() at most once per minute, according to their age
+// and the maximum size of the cache
+class BRepMeshCache {
+public:
+    BRepMeshCache() = default;
+    explicit BRepMeshCache(const FilePath& dirPath);
+
+    // Directory where cache files are stored
+    const FilePath& directory() const { return m_dirPath; }
+    void setDirectory(const FilePath& dirPath);
+
+    // Maximum size in bytes of all cache files
+    std::uintmax_t maxSize() const { return m_maxSize; }
+    void setMaxSize(std::uintmax_t size) { m_maxSize = size; }
+
+    // Cache files older than this duration are evicted
+    std::chrono::seconds maxAge() const { return m_maxAge; }
+    void setMaxAge(std::chrono::seconds age) { m_maxAge = age; }
+
+    // Computes the key identifying the mesh of 'shape' read from 'sourceFilepath'
+    // Returns empty string if the source file can't be read
+    static std::string key(
+            const FilePath& sourceFilepath, const OccBRepMeshParameters& params, const TopoDS_Shape& shape
+    );
+
+    // Attaches cached triangulations to the faces of 'shape' and polygons to their edges
+    // Returns false(and 'shape' is untouched) if there is no valid cache entry for 'key'
+    bool restore(const std::string& key, const TopoDS_Shape& shape);
+
+    // Writes the current triangulations of 'shape' faces and polygons of their edges to cache
+    // entry 'key'
+    // Evicts old cache entries afterwards, if not already done recently
+    bool store(const std::string& key, const TopoDS_Shape& shape);
+
+    // Removes cache files exceeding maximum age, then oldest files until maximum size is honored
+    void evict();
+
+    // Hash of the contents of file at 'filepath', result is memoized per file path/size/time
+    static std::uint64_t fileContentsHash(const FilePath& filepath);
+
+private:
+    FilePath entryFilepath(const std::string& key) const;
+    void evictIfDue();
+    void evictUnlocked(); // Requires m_mutexEvict to be locked
+
+    FilePath m_dirPath;
+    std::atomic<std::uintmax_t> m_maxSize = 1024 * 1024 * 1024;
+    std::atomic<std::chrono::seconds> m_maxAge = std::chrono::seconds(std::chrono::hours(24 * 30));
+    std::mutex m_mutexEvict;
+    std::chrono::steady_clock::time_point m_lastEvictTime; // Protected by m_mutexEvict
+};
+
+} // namespace Mayo
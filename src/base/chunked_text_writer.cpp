@@ -0,0 +1,69 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "chunked_text_writer.h"
+
+#include <OSD_Parallel.hxx>
+
+#include <algorithm>
+#include <ostream>
+
+namespace Mayo {
+
+ChunkedTextWriter::ChunkedTextWriter(std::ostream& ostr)
+    : m_ostr(ostr)
+{
+}
+
+void ChunkedTextWriter::setChunkSize(int itemCount)
+{
+    m_chunkSize = std::max(itemCount, 1);
+}
+
+bool ChunkedTextWriter::write(std::string_view text)
+{
+    m_ostr.write(text.data(), static_cast<std::streamsize>(text.size()));
+    return m_ostr.good();
+}
+
+bool ChunkedTextWriter::writeItems(int64_t itemCount, const FormatFunction& fnFormat)
+{
+    if (itemCount <= 0 || !fnFormat)
+        return m_ostr.good();
+
+    // Buffers are created once, they keep their memory between batches and calls to writeItems()
+    if (m_vecBuffer.empty())
+        m_vecBuffer.resize(2 * std::max(OSD_Parallel::NbLogicalProcessors(), 1));
+
+    const int64_t chunkCount = (itemCount + m_chunkSize - 1) / m_chunkSize;
+    const auto batchSize = static_cast<int64_t>(m_vecBuffer.size());
+    for (int64_t iBatchChunk = 0; iBatchChunk < chunkCount; iBatchChunk += batchSize) {
+        const auto batchChunkCount = static_cast<int>(std::min(batchSize, chunkCount - iBatchChunk));
+        OSD_Parallel::For(0, batchChunkCount, [&](int i) {
+            const int64_t first = (iBatchChunk + i) * m_chunkSize;
+            const int64_t last = std::min(first + m_chunkSize, itemCount);
+            Buffer& buffer = m_vecBuffer.at(i);
+            buffer.clear();
+            fnFormat(buffer, first, last);
+        });
+
+        for (int i = 0; i < batchChunkCount; ++i) {
+            const Buffer& buffer = m_vecBuffer.at(i);
+            m_ostr.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        }
+
+        if (!m_ostr.good())
+            return false;
+
+        const int64_t itemsWritten = std::min((iBatchChunk + batchChunkCount) * m_chunkSize, itemCount);
+        if (m_fnProgress && !m_fnProgress(itemsWritten))
+            return false;
+    }
+
+    return true;
+}
+
+} // namespace Mayo
@@ -0,0 +1,59 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <fmt/format.h>
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string_view>
+#include <vector>
+
+namespace Mayo {
+
+// Writes big text outputs(eg ASCII mesh files) to a stream
+//
+// Items to be written are split into chunks which are formatted concurrently into memory buffers
+// with fmt library. Buffers are then written to the stream in item order with big sequential
+// writes. This avoids the overhead of std::ostream::operator<<() called for each single value.
+// Memory usage is bounded: buffers are reused from one batch of chunks to the next one
+class ChunkedTextWriter {
+public:
+    using Buffer = fmt::memory_buffer;
+
+    // Formats items in range [first, last) into 'buffer'
+    // NOTE this function is called concurrently from multiple threads
+    using FormatFunction = std::function<void(Buffer& buffer, int64_t first, int64_t last)>;
+
+    // Called after each batch of chunks written with the count of items written so far(for the
+    // current call to writeItems()). Returns false to stop writing
+    using ProgressFunction = std::function<bool(int64_t itemsWritten)>;
+
+    ChunkedTextWriter(std::ostream& ostr);
+
+    // Count of items formatted into a single buffer
+    int chunkSize() const { return m_chunkSize; }
+    void setChunkSize(int itemCount);
+
+    void setProgressFunction(ProgressFunction fn) { m_fnProgress = std::move(fn); }
+
+    // Writes 'text' as-is
+    bool write(std::string_view text);
+
+    // Writes 'itemCount' items formatted by 'fnFormat'
+    // Returns false if writing to the stream failed or was stopped by the progress function
+    bool writeItems(int64_t itemCount, const FormatFunction& fnFormat);
+
+private:
+    std::ostream& m_ostr;
+    int m_chunkSize = 32 * 1024;
+    ProgressFunction m_fnProgress;
+    std::vector<Buffer> m_vecBuffer;
+};
+
+} // namespace Mayo
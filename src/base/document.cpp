@@ -12,6 +12,8 @@
 #include <TDF_ChildIterator.hxx>
 #include <TDF_TagSource.hxx>
 #include <XCAFDoc_DocumentTool.hxx>
+#include <mutex>
+#include <vector>
 
 namespace Mayo {
 
@@ -106,10 +108,12 @@ DocumentTreeNode Document::entityTreeNode(int index) const
 void Document::rebuildModelTree()
 {
     m_modelTree.clear();
+    m_mapEntityLabelTreeNode.clear();
+    this->invalidateModelTreeLocations();
     const bool xcafIsNull = m_xcaf.isNull();
     if (!xcafIsNull) {
         for (const TDF_Label& label : m_xcaf.topLevelFreeShapes())
-            m_xcaf.deepBuildAssemblyTree(0, label);
+            this->appendEntityTreeNode(label);
     }
 
     constexpr bool allLevels = true;
@@ -118,11 +122,95 @@ void Document::rebuildModelTree()
         if (!CafUtils::isNullOrEmpty(childLabel)
                 && (xcafIsNull || childLabel != this->Main())) // Not XCAF Main label
         {
-            m_modelTree.appendChild(0, childLabel);
+            this->appendEntityTreeNode(childLabel);
         }
     }
 }
 
+bool Document::isModelTreeNodeCollapsed(TreeNodeId nodeId) const
+{
+    return m_xcaf.isAssemblyTreeNodeCollapsed(nodeId);
+}
+
+void Document::expandModelTreeNode(TreeNodeId nodeId)
+{
+    if (m_xcaf.isAssemblyTreeNodeCollapsed(nodeId)) {
+        m_xcaf.expandAssemblyTreeNode(nodeId);
+        this->signalModelTreeNodeExpanded.send(nodeId);
+    }
+}
+
+void Document::deepExpandModelTreeNode(TreeNodeId nodeId)
+{
+    std::vector<TreeNodeId> vecPendingNodeId = { nodeId };
+    while (!vecPendingNodeId.empty()) {
+        const TreeNodeId id = vecPendingNodeId.back();
+        vecPendingNodeId.pop_back();
+        this->expandModelTreeNode(id);
+        for (TreeNodeId it = m_modelTree.nodeChildFirst(id); it != 0; it = m_modelTree.nodeSiblingNext(it))
+            vecPendingNodeId.push_back(it);
+    }
+}
+
+void Document::deepExpandModelTree()
+{
+    // Expansion never creates root nodes, so it's safe to iterate over roots
+    for (TreeNodeId rootId : m_modelTree.roots())
+        this->deepExpandModelTreeNode(rootId);
+}
+
+TopLoc_Location Document::modelTreeNodeAbsoluteLocation(TreeNodeId nodeId) const
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutexTreeNodeAbsoluteLocation);
+        if (nodeId < m_vecTreeNodeAbsoluteLocation.size() && m_vecTreeNodeAbsoluteLocation[nodeId])
+            return *m_vecTreeNodeAbsoluteLocation[nodeId];
+    }
+
+    if (nodeId == 0 || nodeId > m_modelTree.lastNodeId())
+        return {};
+
+    std::unique_lock<std::shared_mutex> lock(m_mutexTreeNodeAbsoluteLocation);
+    auto& vecLoc = m_vecTreeNodeAbsoluteLocation;
+    if (vecLoc.size() <= m_modelTree.lastNodeId())
+        vecLoc.resize(m_modelTree.lastNodeId() + 1);
+
+    // Walk up to the first ancestor having its location cached, then compute locations top-down
+    std::vector<TreeNodeId> vecPendingNodeId;
+    TopLoc_Location loc;
+    for (TreeNodeId id = nodeId; id != 0; id = m_modelTree.nodeParent(id)) {
+        if (vecLoc[id]) {
+            loc = *vecLoc[id];
+            break;
+        }
+
+        vecPendingNodeId.push_back(id);
+    }
+
+    for (auto it = vecPendingNodeId.rbegin(); it != vecPendingNodeId.rend(); ++it) {
+        loc = loc * XCaf::shapeReferenceLocation(m_modelTree.nodeData(*it));
+        vecLoc[*it] = loc;
+    }
+
+    return loc;
+}
+
+void Document::invalidateModelTreeLocations()
+{
+    std::unique_lock<std::shared_mutex> lock(m_mutexTreeNodeAbsoluteLocation);
+    m_vecTreeNodeAbsoluteLocation.clear();
+}
+
+void Document::compactModelTree()
+{
+    const std::vector<TreeNodeId> vecOldToNewId = m_modelTree.compact();
+    for (auto& [label, nodeId] : m_mapEntityLabelTreeNode)
+        nodeId = vecOldToNewId[nodeId];
+
+    this->invalidateModelTreeLocations();
+    this->signalModelTreeCompacted.send(vecOldToNewId);
+}
+
 DocumentPtr Document::findFrom(const TDF_Label& label)
 {
     return DocumentPtr::DownCast(TDocStd_Document::Get(label));
@@ -145,12 +233,21 @@ TDF_Label Document::newEntityShapeLabel()
 
 TreeNodeId Document::findEntity(const TDF_Label& label) const
 {
-    for (int i = 0; i < this->entityCount(); ++i) {
-        if (this->entityLabel(i) == label)
-            return this->entityTreeNodeId(i);
-    }
+    auto it = m_mapEntityLabelTreeNode.find(label);
+    return it != m_mapEntityLabelTreeNode.cend() ? it->second : 0;
+}
 
-    return 0;
+TreeNodeId Document::appendEntityTreeNode(const TDF_Label& label)
+{
+    const TreeNodeId nodeId = m_xcaf.buildAssemblyTree(0, label);
+    m_mapEntityLabelTreeNode.insert({ label, nodeId });
+    return nodeId;
+}
+
+void Document::notifyEntitiesAdded(const std::vector<TreeNodeId>& vecTreeNodeId)
+{
+    for (TreeNodeId treeNodeId : vecTreeNodeId)
+        this->signalEntityAdded.send(treeNodeId);
 }
 
 bool Document::containsLabel(const TDF_Label &label) const
@@ -162,7 +259,7 @@ void Document::addEntityTreeNode(const TDF_Label& label)
 {
     // TODO Allow custom population of the model tree for the new entity
     if (this->containsLabel(label) && this->findEntity(label) == 0) {
-        const TreeNodeId nodeId = m_xcaf.deepBuildAssemblyTree(0, label);
+        const TreeNodeId nodeId = this->appendEntityTreeNode(label);
         this->signalEntityAdded.send(nodeId);
     }
 }
@@ -172,14 +269,22 @@ void Document::addEntityTreeNodeSequence(const TDF_LabelSequence& seqLabel)
     std::vector<TreeNodeId> vecTreeNodeId;
     vecTreeNodeId.reserve(seqLabel.Size());
     for (const TDF_Label& label : seqLabel) {
-        if (this->containsLabel(label) && this->findEntity(label) == 0) {
-            const TreeNodeId treeNodeId = m_xcaf.deepBuildAssemblyTree(0, label);
-            vecTreeNodeId.push_back(treeNodeId);
-        }
+        if (this->containsLabel(label) && this->findEntity(label) == 0)
+            vecTreeNodeId.push_back(this->appendEntityTreeNode(label));
     }
 
-    for (TreeNodeId treeNodeId : vecTreeNodeId)
-        this->signalEntityAdded.send(treeNodeId);
+    this->notifyEntitiesAdded(vecTreeNodeId);
+}
+
+void Document::addNewEntityTreeNodeSequence(const TDF_LabelSequence& seqLabel)
+{
+    std::vector<TreeNodeId> vecTreeNodeId;
+    vecTreeNodeId.reserve(seqLabel.Size());
+    m_mapEntityLabelTreeNode.reserve(m_mapEntityLabelTreeNode.size() + seqLabel.Size());
+    for (const TDF_Label& label : seqLabel)
+        vecTreeNodeId.push_back(this->appendEntityTreeNode(label));
+
+    this->notifyEntitiesAdded(vecTreeNodeId);
 }
 
 void Document::destroyEntity(TreeNodeId entityTreeNodeId)
@@ -191,9 +296,22 @@ void Document::destroyEntity(TreeNodeId entityTreeNodeId)
         return;
 
     this->signalEntityAboutToBeDestroyed.send(entityTreeNodeId);
+    m_mapEntityLabelTreeNode.erase(entityLabel);
     entityLabel.ForgetAllAttributes();
     entityLabel.Nullify();
+    {
+        // Identifiers of the removed nodes will be reused, so their cached location is obsolete
+        std::unique_lock<std::shared_mutex> lock(m_mutexTreeNodeAbsoluteLocation);
+        auto& vecLoc = m_vecTreeNodeAbsoluteLocation;
+        traverseTree(entityTreeNodeId, m_modelTree, [&](TreeNodeId id) {
+            if (id < vecLoc.size())
+                vecLoc[id].reset();
+        });
+    }
+
     m_modelTree.removeRoot(entityTreeNodeId);
+    if (m_modelTree.roots().empty())
+        m_modelTree.clear(); // Nothing alive anymore, release all slots
 }
 
 void Document::BeforeClose()
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "application_ptr.h"
+#include "caf_utils.h"
 #include "document_ptr.h"
 #include "document_tree_node.h"
 #include "filepath.h"
@@ -14,8 +15,12 @@
 #include "signal.h"
 #include "xcaf.h"
 
+#include <optional>
+#include <shared_mutex>
 #include <string>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace Mayo {
 
@@ -53,9 +58,41 @@ public:
     TreeNodeId entityTreeNodeId(int index) const;
     DocumentTreeNode entityTreeNode(int index) const;
 
+    // Model tree is built lazily: instance nodes(ie XCAF shape references) are created as leaves and
+    // the sub-tree of the referred product is appended only when the instance node gets expanded
+    // This way the model tree grows with the instances actually visited, not with the total count
+    // of instances
+    // Note: call deepExpandModelTreeNode() before traversing the complete sub-tree of some node
     const Tree<TDF_Label>& modelTree() const { return m_modelTree; }
     void rebuildModelTree();
 
+    // Whether node 'nodeId' has child nodes that aren't yet built in the model tree
+    bool isModelTreeNodeCollapsed(TreeNodeId nodeId) const;
+    // Builds direct child nodes of 'nodeId' if not already done
+    void expandModelTreeNode(TreeNodeId nodeId);
+    // Builds all the nodes under 'nodeId', recursively
+    void deepExpandModelTreeNode(TreeNodeId nodeId);
+    // Builds all the nodes of the model tree
+    void deepExpandModelTree();
+
+    // Absolute location of the shape at model tree node 'nodeId'
+    // Locations are cached in an array indexed by TreeNodeId, location of a node is computed once
+    // from the cached location of its parent. Safe to call concurrently from several threads
+    TopLoc_Location modelTreeNodeAbsoluteLocation(TreeNodeId nodeId) const;
+    // Clears cache of absolute locations, done by rebuildModelTree() and compactModelTree()
+    // Note: changes of XCAFDoc_Location attributes aren't tracked, code modifying the location of
+    // some model tree label has to call this function explicitly
+    void invalidateModelTreeLocations();
+
+    // Removes the slots of deleted nodes from the model tree storage, this changes the node
+    // identifiers. signalModelTreeCompacted is emitted so that identifiers can be remapped
+    // Never called implicitly(eg by destroyEntity()): TreeNodeId and DocumentTreeNode objects held
+    // anywhere are invalid afterwards, unless remapped by a slot of signalModelTreeCompacted
+    // GuiApplication(selection), GuiDocument and ModelTreeItemModel do so, other holders(eg
+    // property editors, exploding data) don't. So caller has to ensure no such holder exists
+    // Note: slots of deleted nodes are reused anyway when new nodes are created
+    void compactModelTree();
+
     static DocumentPtr findFrom(const TDF_Label& label);
 
     // Creates general-purpose entity, not bound to a specific type
@@ -66,6 +103,9 @@ public:
 
     void addEntityTreeNode(const TDF_Label& label);
     void addEntityTreeNodeSequence(const TDF_LabelSequence& seqLabel);
+    // Same as addEntityTreeNodeSequence() but without any check on labels, which must belong to
+    // this document and must not already be entities(eg labels just created by some Reader)
+    void addNewEntityTreeNodeSequence(const TDF_LabelSequence& seqLabel);
     void destroyEntity(TreeNodeId entityTreeNodeId);
 
     // Signals
@@ -73,6 +113,11 @@ public:
     Signal<const FilePath&> signalFilePathChanged;
     Signal<TreeNodeId> signalEntityAdded;
     Signal<TreeNodeId> signalEntityAboutToBeDestroyed;
+    // Argument is the mapping of identifiers: index is the old identifier and value is the new
+    // one(0 for deleted nodes)
+    Signal<const std::vector<TreeNodeId>&> signalModelTreeCompacted;
+    // Emitted when the child nodes of a collapsed node have just been built in the model tree
+    Signal<TreeNodeId> signalModelTreeNodeExpanded;
 
 public: // -- from TDocStd_Document
     void BeforeClose() override;
@@ -91,6 +136,8 @@ private:
     void initXCaf();
     void setIdentifier(Identifier ident) { m_identifier = ident; }
     TreeNodeId findEntity(const TDF_Label& label) const;
+    TreeNodeId appendEntityTreeNode(const TDF_Label& label);
+    void notifyEntitiesAdded(const std::vector<TreeNodeId>& vecTreeNodeId);
     bool containsLabel(const TDF_Label& label) const;
 
     ApplicationPtr m_app;
@@ -99,6 +146,9 @@ private:
     FilePath m_filePath;
     XCaf m_xcaf;
     Tree<TDF_Label> m_modelTree;
+    std::unordered_map<TDF_Label, TreeNodeId> m_mapEntityLabelTreeNode;
+    mutable std::vector<std::optional<TopLoc_Location>> m_vecTreeNodeAbsoluteLocation;
+    mutable std::shared_mutex m_mutexTreeNodeAbsoluteLocation;
 };
 
 } // namespace Mayo
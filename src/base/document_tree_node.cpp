@@ -40,7 +40,7 @@ bool DocumentTreeNode::isEntity() const
 bool DocumentTreeNode::isLeaf() const
 {
     if (this->isValid())
-        return m_document->modelTree().nodeIsLeaf(m_id);
+        return m_document->modelTree().nodeIsLeaf(m_id) && !m_document->isModelTreeNodeCollapsed(m_id);
     else
         return false;
 }
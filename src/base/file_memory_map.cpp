@@ -0,0 +1,121 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "file_memory_map.h"
+
+#ifdef MAYO_OS_WINDOWS
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace Mayo {
+
+FileMemoryMap::FileMemoryMap(const FilePath& filepath)
+{
+    this->open(filepath);
+}
+
+FileMemoryMap::~FileMemoryMap()
+{
+    this->close();
+}
+
+bool FileMemoryMap::open(const FilePath& filepath)
+{
+    this->close();
+#ifdef MAYO_OS_WINDOWS
+    HANDLE hFile = CreateFileW(
+        filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+    );
+    if (hFile == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(hFile, &fileSize)) {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    m_hFile = hFile;
+    m_isOpen = true;
+    if (fileSize.QuadPart == 0)
+        return true; // Empty files can't be mapped
+
+    HANDLE hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!hMapping) {
+        this->close();
+        return false;
+    }
+
+    m_hMapping = hMapping;
+    m_data = static_cast<const char*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_data) {
+        this->close();
+        return false;
+    }
+
+    m_size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+    const int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat fileStat = {};
+    if (::fstat(fd, &fileStat) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    m_isOpen = true;
+    if (fileStat.st_size == 0) {
+        ::close(fd);
+        return true; // Empty files can't be mapped
+    }
+
+    const auto fileSize = static_cast<std::size_t>(fileStat.st_size);
+    void* ptr = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // Mapping stays valid after file descriptor is closed
+    if (ptr == MAP_FAILED) {
+        m_isOpen = false;
+        return false;
+    }
+
+    ::madvise(ptr, fileSize, MADV_SEQUENTIAL);
+    m_data = static_cast<const char*>(ptr);
+    m_size = fileSize;
+#endif
+    return true;
+}
+
+void FileMemoryMap::close()
+{
+#ifdef MAYO_OS_WINDOWS
+    if (m_data)
+        UnmapViewOfFile(m_data);
+
+    if (m_hMapping)
+        CloseHandle(m_hMapping);
+
+    if (m_hFile)
+        CloseHandle(m_hFile);
+
+    m_hMapping = nullptr;
+    m_hFile = nullptr;
+#else
+    if (m_data)
+        ::munmap(const_cast<char*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_isOpen = false;
+}
+
+} // namespace Mayo
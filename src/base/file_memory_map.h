@@ -0,0 +1,51 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "filepath.h"
+#include "global.h"
+
+#include <cstddef>
+#include <string_view>
+
+namespace Mayo {
+
+// Read-only memory mapping of a whole file
+// Contents are loaded on demand by the operating system, which avoids buffered stream overhead
+// when parsing big files
+class FileMemoryMap {
+public:
+    FileMemoryMap() = default;
+    FileMemoryMap(const FilePath& filepath);
+    ~FileMemoryMap();
+
+    // Not copyable
+    FileMemoryMap(const FileMemoryMap&) = delete;
+    FileMemoryMap& operator=(const FileMemoryMap&) = delete;
+
+    // Maps file at 'filepath', previous mapping is released
+    // Returns false if the file can't be opened/mapped
+    bool open(const FilePath& filepath);
+    void close();
+
+    bool isOpen() const { return m_isOpen; }
+
+    // Mapped contents of the file
+    std::string_view contents() const { return { m_data, m_size }; }
+    std::size_t size() const { return m_size; }
+
+private:
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_isOpen = false;
+#ifdef MAYO_OS_WINDOWS
+    void* m_hFile = nullptr;
+    void* m_hMapping = nullptr;
+#endif
+};
+
+} // namespace Mayo
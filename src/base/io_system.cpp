@@ -15,11 +15,16 @@
 #include "messenger.h"
 #include "task_manager.h"
 #include "task_progress.h"
+#include "task_thread_pool.h"
 #include "tkernel_utils.h"
 
 #include <fmt/format.h>
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <locale>
 #include <mutex>
@@ -174,15 +179,15 @@ std::unique_ptr<Writer> System::createWriter(Format format) const
 bool System::importInDocument(const Args_ImportInDocument& args)
 {
     // NOTE
-    // Maybe STEP/IGES CAF ReadFile() can be run concurrently(they should)
-    // But concurrent calls to Transfer() to the same target Document must be serialized
+    // Concurrent calls to Transfer() to the same target Document must be serialized
 
     DocumentPtr doc = args.targetDocument;
     const auto listFilepath = args.filepaths;
     TaskProgress* rootProgress = args.progress ? args.progress : &TaskProgress::null();
     Messenger* messenger = args.messenger ? args.messenger : &Messenger::null();
 
-    bool ok = true;
+    // Errors may be reported concurrently by the stages of a multi-file import
+    std::atomic<bool> ok = true;
 
     using ReaderPtr = std::unique_ptr<Reader>;
     struct TaskData {
@@ -262,7 +267,7 @@ bool System::importInDocument(const Args_ImportInDocument& args)
         const double subPortionSize = 100. / double(taskData.seqTransferredEntity.Size());
         for (const TDF_Label& labelEntity : taskData.seqTransferredEntity) {
             TaskProgress subProgress(&progress, subPortionSize);
-            args.entityPostProcess(labelEntity, &subProgress);
+            args.entityPostProcess(labelEntity, taskData.filepath, &subProgress);
         }
     };
     auto fnAddModelTreeEntities = [&](const TaskData& taskData) {
@@ -270,7 +275,8 @@ bool System::importInDocument(const Args_ImportInDocument& args)
         // for() loop. The former function doesn't interleave update of the model tree and emission
         // of "entity added" signal for each entity. This prevents data race to happen on the
         // Document's model tree within slots connected to signal(and living in other threads)
-        doc->addEntityTreeNodeSequence(taskData.seqTransferredEntity);
+        // Labels returned by Reader::transfer() are new entities, so checks on them can be skipped
+        doc->addNewEntityTreeNodeSequence(taskData.seqTransferredEntity);
     };
 
     if (listFilepath.size() == 1) { // Single file case
@@ -285,43 +291,158 @@ bool System::importInDocument(const Args_ImportInDocument& args)
         }
     }
     else { // Many files case
+        // Files are processed through a pipeline so that the different stages overlap: files are
+        // read while previous ones are transferred
+        //     probe+read(concurrent) -> transfer(current thread) -> post-process(concurrent)
+        //         -> model tree insertion(current thread)
+        // Transfers to the target document are serialized as they are all run by the current thread
+        // Post-process functions access the target document too, so they start only once all the
+        // transfers are done: the document is then just read concurrently
+        // Count of files read but not yet transferred is bounded to limit memory usage of pending
+        // reader data
         std::vector<TaskData> vecTaskData;
         vecTaskData.resize(listFilepath.size());
 
-        TaskManager childTaskManager;
+        // Synchronization objects must outlive childTaskManager: its destructor waits for the
+        // running tasks, which may still access them
+        std::mutex mutexQueue;
+        std::condition_variable condQueue;
+        std::deque<TaskData*> queueRead; // Waiting for transfer
+        std::deque<TaskData*> queuePostProcessed; // Waiting for model tree insertion
+        std::vector<TaskData*> vecPostProcessPending; // Waiting for all transfers to be done
+        size_t postProcessRunningCount = 0;
+        auto fnPushToQueue = [&](std::deque<TaskData*>* queue, TaskData* taskData) {
+            // Notify while holding the lock, the waiting thread may leave the scope of the
+            // synchronization objects as soon as it gets the lock
+            std::lock_guard<std::mutex> lock(mutexQueue);
+            queue->push_back(taskData);
+            condQueue.notify_all();
+        };
+
+        TaskThreadPool* threadPool = args.threadPool ? args.threadPool : &TaskThreadPool::globalInstance();
+        TaskManager childTaskManager(threadPool);
         childTaskManager.signalProgressChanged.connectSlot([&](TaskId, int) {
             rootProgress->setValue(childTaskManager.globalProgress());
         });
 
-        // Read files
         for (TaskData& taskData : vecTaskData) {
             taskData.filepath = listFilepath[&taskData - &vecTaskData.front()];
             taskData.taskId = childTaskManager.newTask([&](TaskProgress* progressChild) {
                 taskData.progress = progressChild;
                 taskData.readSuccess = fnReadFile(taskData);
+                fnPushToQueue(&queueRead, &taskData);
             });
         }
 
-        for (const TaskData& taskData : vecTaskData)
-            childTaskManager.run(taskData.taskId, TaskAutoDestroy::Off);
+        // Waits until 'fnCondition' is satisfied or some stage output is available
+        // If the current thread is a worker of the pool then pending jobs are executed meanwhile:
+        // this is required for the pipeline to progress when all other workers are busy(or when
+        // the pool has a single thread)
+        auto fnWait = [&](const std::function<bool()>& fnCondition) {
+            if (threadPool->isWorkerThread() && threadPool->tryRunPendingJob())
+                return;
+
+            std::unique_lock<std::mutex> lock(mutexQueue);
+            // Timeout is just to regularly check for abort requests and pending jobs
+            condQueue.wait_for(lock, std::chrono::milliseconds(20), [&]{
+                return !queueRead.empty() || !queuePostProcessed.empty() || fnCondition();
+            });
+        };
+
+        const size_t maxReadInFlightCount = 2 * threadPool->maxThreadCount();
+        size_t readStartedCount = 0;
+        auto fnStartNextRead = [&]{
+            if (readStartedCount < vecTaskData.size())
+                childTaskManager.run(vecTaskData.at(readStartedCount++).taskId, TaskAutoDestroy::Off);
+        };
+        while (readStartedCount < maxReadInFlightCount && readStartedCount < vecTaskData.size())
+            fnStartNextRead();
+
+        auto fnStartPostProcess = [&](TaskData* taskData) {
+            {
+                std::lock_guard<std::mutex> lock(mutexQueue);
+                ++postProcessRunningCount;
+            }
 
-        // Transfer to document
-        auto taskDataCount = CppUtils::safeStaticCast<int>(vecTaskData.size());
-        while (taskDataCount > 0 && !rootProgress->isAbortRequested()) {
-            auto it = std::find_if(vecTaskData.begin(), vecTaskData.end(), [&](const TaskData& taskData) {
-                return !taskData.transferred && childTaskManager.waitForDone(taskData.taskId, 25);
+            threadPool->start([&, taskData]{
+                fnPostProcess(*taskData);
+                std::lock_guard<std::mutex> lock(mutexQueue);
+                --postProcessRunningCount;
+                queuePostProcessed.push_back(taskData);
+                condQueue.notify_all();
             });
+        };
 
-            if (it != vecTaskData.end()) {
-                if (it->readSuccess) {
-                    fnTransfer(*it);
-                    fnPostProcess(*it);
-                    fnAddModelTreeEntities(*it);
+        size_t fileDoneCount = 0;
+        size_t transferDoneCount = 0;
+        while (fileDoneCount < vecTaskData.size() && !rootProgress->isAbortRequested()) {
+            TaskData* taskDataRead = nullptr;
+            TaskData* taskDataPostProcessed = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mutexQueue);
+                if (!queuePostProcessed.empty()) {
+                    taskDataPostProcessed = queuePostProcessed.front();
+                    queuePostProcessed.pop_front();
+                }
+                else if (!queueRead.empty()) {
+                    taskDataRead = queueRead.front();
+                    queueRead.pop_front();
                 }
+            }
 
-                --taskDataCount;
+            if (taskDataPostProcessed) {
+                fnAddModelTreeEntities(*taskDataPostProcessed);
+                ++fileDoneCount;
+            }
+            else if (taskDataRead) {
+                fnStartNextRead();
+                if (taskDataRead->readSuccess) {
+                    fnTransfer(*taskDataRead);
+                    taskDataRead->reader.reset(); // Release reader data as soon as possible
+                }
+
+                ++transferDoneCount;
+                if (taskDataRead->readSuccess && fnEntityPostProcessRequired(taskDataRead->fileFormat)) {
+                    vecPostProcessPending.push_back(taskDataRead);
+                }
+                else {
+                    if (taskDataRead->readSuccess)
+                        fnAddModelTreeEntities(*taskDataRead);
+
+                    ++fileDoneCount;
+                }
+
+                if (transferDoneCount == vecTaskData.size()) {
+                    for (TaskData* taskData : vecPostProcessPending)
+                        fnStartPostProcess(taskData);
+
+                    vecPostProcessPending.clear();
+                }
+            }
+            else {
+                fnWait([]{ return false; });
             }
         } // endwhile
+
+        if (fileDoneCount < vecTaskData.size()) { // Aborted
+            for (size_t i = 0; i < readStartedCount; ++i)
+                childTaskManager.requestAbort(vecTaskData.at(i).taskId);
+
+            // Post-process jobs aren't tasks of childTaskManager, wait for them explicitly
+            auto fnPostProcessDone = [&]{ return postProcessRunningCount == 0; };
+            for (;;) {
+                {
+                    std::lock_guard<std::mutex> lock(mutexQueue);
+                    if (fnPostProcessDone())
+                        break;
+                }
+
+                fnWait(fnPostProcessDone);
+            }
+
+            for (size_t i = 0; i < readStartedCount; ++i)
+                childTaskManager.waitForDone(vecTaskData.at(i).taskId);
+        }
     }
 
     return ok;
@@ -467,6 +588,26 @@ void System::traverseUniqueItems(
     });
 }
 
+void System::deepExpandItems(Span<const ApplicationItem> spanItem)
+{
+    System::visitUniqueItems(spanItem, [](const ApplicationItem& item) {
+        if (item.isDocument())
+            item.document()->deepExpandModelTree();
+        else if (item.isDocumentTreeNode())
+            item.document()->deepExpandModelTreeNode(item.documentTreeNode().id());
+    });
+}
+
+bool System::isDeepExpanded(Span<const ApplicationItem> spanItem)
+{
+    bool isExpanded = true;
+    System::traverseUniqueItems(spanItem, [&](const DocumentTreeNode& node) {
+        if (isExpanded && node.document()->isModelTreeNodeCollapsed(node.id()))
+            isExpanded = false;
+    });
+    return isExpanded;
+}
+
 System::Operation_ImportInDocument&
 System::Operation_ImportInDocument::targetDocument(const DocumentPtr& document) {
     m_args.targetDocument = document;
@@ -497,6 +638,12 @@ System::Operation_ImportInDocument::withTaskProgress(TaskProgress* progress) {
     return *this;
 }
 
+System::Operation_ImportInDocument&
+System::Operation_ImportInDocument::withThreadPool(TaskThreadPool* pool) {
+    m_args.threadPool = pool;
+    return *this;
+}
+
 System::Operation_ImportInDocument::Operation&
 System::Operation_ImportInDocument::withFilepath(const FilePath& filepath)
 {
@@ -504,7 +651,7 @@ System::Operation_ImportInDocument::withFilepath(const FilePath& filepath)
 }
 
 System::Operation_ImportInDocument::Operation&
-System::Operation_ImportInDocument::withEntityPostProcess(std::function<void (TDF_Label, TaskProgress*)> fn)
+System::Operation_ImportInDocument::withEntityPostProcess(std::function<void (TDF_Label, const FilePath&, TaskProgress*)> fn)
 {
     m_args.entityPostProcess = std::move(fn);
     return *this;
@@ -25,6 +25,7 @@ namespace Mayo {
 
 class Messenger;
 class TaskProgress;
+class TaskThreadPool;
 
 namespace IO {
 
@@ -76,8 +77,9 @@ public:
         // Optional: function applied to each imported entity. Executed before adding entities into
         // target document
         //     1st arg: CAF label of the entity to "post-process"
-        //     2nd arg: progress indicator of the post-process function
-        std::function<void(TDF_Label, TaskProgress*)> entityPostProcess;
+        //     2nd arg: path of the file from which the entity was read
+        //     3rd arg: progress indicator of the post-process function
+        std::function<void(TDF_Label, const FilePath&, TaskProgress*)> entityPostProcess;
 
         // Optional: predicate telling whether imported entities have to be post-processed(ie whether
         //           `entityPostProcess` function has to be called)
@@ -95,6 +97,10 @@ public:
 
         // Optional: the indicator object used to report progress of the import operation
         TaskProgress* progress = nullptr;
+
+        // Optional: pool executing the concurrent stages when importing many files
+        // If null then TaskThreadPool::globalInstance() is used
+        TaskThreadPool* threadPool = nullptr;
     };
     bool importInDocument(const Args_ImportInDocument& args);
 
@@ -122,6 +128,7 @@ public:
         // Optional: the indicator object used to report progress of the import operation
         TaskProgress* progress = nullptr;
     };
+    // Note: model tree below the items must be complete, see deepExpandItems()
     bool exportApplicationItems(const Args_ExportApplicationItems& args);
 
     //
@@ -137,12 +144,13 @@ public:
         Operation& withFilepaths(Span<const FilePath> filepaths);
         Operation& withParametersProvider(const ParametersProvider* provider);
 
-        Operation& withEntityPostProcess(std::function<void(TDF_Label, TaskProgress*)> fn);
+        Operation& withEntityPostProcess(std::function<void(TDF_Label, const FilePath&, TaskProgress*)> fn);
         Operation& withEntityPostProcessRequiredIf(std::function<bool(Format)> fn);
         Operation& withEntityPostProcessInfoProgress(int progressSize, std::string_view progressStep);
 
         Operation& withMessenger(Messenger* messenger);
         Operation& withTaskProgress(TaskProgress* progress);
+        Operation& withThreadPool(TaskThreadPool* pool);
         bool execute(); // Runs System::importInDocument() function
 
     private:
@@ -189,12 +197,23 @@ public:
 
     // Iterate over `spanItem` and then deep traverse the corresponding tree node to
     // call `fnCallback` for each item. Guarantees that doublon items will be visited only once
+    // Note: tree nodes not yet built(collapsed instances) aren't visited, see deepExpandItems()
     static void traverseUniqueItems(
             Span<const ApplicationItem> spanItem,
             std::function<void(const DocumentTreeNode&)> fnCallback,
             TreeTraversal mode = TreeTraversal::PreOrder
     );
 
+    // Builds the complete model tree below each item of `spanItem`
+    // Model tree of a document isn't thread-safe, so this has to be called by the thread owning the
+    // documents, before items are exported by some worker thread
+    static void deepExpandItems(Span<const ApplicationItem> spanItem);
+
+    // Whether the model tree below each item of `spanItem` is complete(no collapsed tree node)
+    // Writers traversing the model tree should check this and fail instead of silently skipping
+    // instances not yet built
+    static bool isDeepExpanded(Span<const ApplicationItem> spanItem);
+
     // Implementation
 private:
     std::vector<FormatProbe> m_vecFormatProbe;
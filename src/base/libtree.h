@@ -26,7 +26,10 @@ using TreeNodeId = uint32_t;
 //     * has 0..N child tree nodes. A tree node is a leaf in case it has no child
 //     * owns data of any type, though data type is the same for all nodes of the same tree
 //
-// Storage of nodes and associated data is memory efficient : all nodes are stored in a single array
+// Storage of nodes and associated data is memory efficient : nodes are stored in arrays(structure
+// of arrays: links between nodes, data and deletion flags are kept apart so traversal only touches
+// the links). Slots of deleted nodes are reused by next calls to appendChild(), compact() can be
+// called to get rid of deleted slots at the cost of changing node identifiers
 // Use the traverseTree_() family of functions to visit nodes of a Tree object
 //
 // Data type 'T' must be default-constructible(see https://www.cplusplus.com/reference/type_traits/is_default_constructible/)
@@ -65,6 +68,16 @@ public:
     // Read-only array of all the roots
     Span<const TreeNodeId> roots() const;
 
+    // Upper bound of node identifiers, 0 if tree is empty. Identifiers are all in [1, lastNodeId()]
+    // Note: this range includes identifiers of deleted nodes
+    TreeNodeId lastNodeId() const;
+
+    // Count of nodes, deleted nodes excluded
+    size_t nodeCount() const;
+
+    // Count of deleted nodes whose slot is available for reuse
+    size_t deletedNodeCount() const;
+
     // Removes all nodes, tree will become empty
     void clear();
 
@@ -72,18 +85,22 @@ public:
     TreeNodeId appendChild(TreeNodeId parentId, const T& data);
     TreeNodeId appendChild(TreeNodeId parentId, T&& data);
 
-    // Remove root node identified by 'id'
+    // Remove root node identified by 'id' and all its deep children nodes
+    // Slots of the removed nodes will be reused by next calls to appendChild()
     void removeRoot(TreeNodeId id);
 
+    // Removes the deleted slots from node storage, nodes are renumbered in pre-order
+    // Returns the mapping of identifiers: index is the old identifier and value is the new one(0
+    // for deleted nodes)
+    std::vector<TreeNodeId> compact();
+
 private:
-    struct TreeNode {
+    struct TreeNodeLinks {
         TreeNodeId siblingPrevious;
         TreeNodeId siblingNext;
         TreeNodeId childFirst;
         TreeNodeId childLast;
         TreeNodeId parent;
-        T data;
-        bool isDeleted;
     };
 
     template<typename U, typename FN>
@@ -98,13 +115,17 @@ private:
     template<typename U, typename FN>
     friend void visitDirectChildren(TreeNodeId id, const Tree<U>& tree, const FN& callback);
 
-    TreeNodeId lastNodeId() const;
-    TreeNode* ptrNode(TreeNodeId id);
-    const TreeNode* ptrNode(TreeNodeId id) const;
-    TreeNode* appendChild(TreeNodeId parentId);
+    TreeNodeLinks* ptrNode(TreeNodeId id);
+    const TreeNodeLinks* ptrNode(TreeNodeId id) const;
+    TreeNodeId appendChild(TreeNodeId parentId);
     bool isNodeDeleted(TreeNodeId id) const;
+    void deleteNode(TreeNodeId id);
 
-    std::vector<TreeNode> m_vecNode;
+    // Node at slot 'i' of each array has identifier 'i + 1'
+    std::vector<TreeNodeLinks> m_vecNodeLinks;
+    std::vector<T> m_vecNodeData;
+    std::vector<uint8_t> m_vecNodeDeleted;
+    std::vector<TreeNodeId> m_vecFreeNodeId;
     std::vector<TreeNodeId> m_vecRoot;
 };
 
@@ -144,27 +165,27 @@ void visitDirectChildren(TreeNodeId id, const Tree<U>& tree, const FN& callback)
 template<typename T> Tree<T>::Tree() {}
 
 template<typename T> TreeNodeId Tree<T>::nodeSiblingPrevious(TreeNodeId id) const {
-    const TreeNode* node = this->ptrNode(id);
+    const TreeNodeLinks* node = this->ptrNode(id);
     return node ? node->siblingPrevious : 0;
 }
 
 template<typename T> TreeNodeId Tree<T>::nodeSiblingNext(TreeNodeId id) const {
-    const TreeNode* node = this->ptrNode(id);
+    const TreeNodeLinks* node = this->ptrNode(id);
     return node ? node->siblingNext : 0;
 }
 
 template<typename T> TreeNodeId Tree<T>::nodeChildFirst(TreeNodeId id) const {
-    const TreeNode* node = this->ptrNode(id);
+    const TreeNodeLinks* node = this->ptrNode(id);
     return node ? node->childFirst : 0;
 }
 
 template<typename T> TreeNodeId Tree<T>::nodeChildLast(TreeNodeId id) const {
-    const TreeNode* node = this->ptrNode(id);
+    const TreeNodeLinks* node = this->ptrNode(id);
     return node ? node->childLast : 0;
 }
 
 template<typename T> TreeNodeId Tree<T>::nodeParent(TreeNodeId id) const {
-    const TreeNode* node = this->ptrNode(id);
+    const TreeNodeLinks* node = this->ptrNode(id);
     return node ? node->parent : 0;
 }
 
@@ -177,12 +198,11 @@ template<typename T> TreeNodeId Tree<T>::nodeRoot(TreeNodeId id) const {
 
 template<typename T> const T& Tree<T>::nodeData(TreeNodeId id) const {
     static const T nullObject = {};
-    const TreeNode* node = this->ptrNode(id);
-    return node ? node->data : nullObject;
+    return this->ptrNode(id) ? m_vecNodeData[id - 1] : nullObject;
 }
 
 template<typename T> bool Tree<T>::nodeIsRoot(TreeNodeId id) const {
-    const TreeNode* node = this->ptrNode(id);
+    const TreeNodeLinks* node = this->ptrNode(id);
     return node ? node->parent == 0 : false;
 }
 
@@ -192,36 +212,51 @@ template<typename T> bool Tree<T>::nodeIsLeaf(TreeNodeId id) const {
 
 template<typename T> void Tree<T>::clear()
 {
-    m_vecNode.clear();
+    m_vecNodeLinks.clear();
+    m_vecNodeData.clear();
+    m_vecNodeDeleted.clear();
+    m_vecFreeNodeId.clear();
     m_vecRoot.clear();
 }
 
 template<typename T>
 TreeNodeId Tree<T>::appendChild(TreeNodeId parentId, const T& data)
 {
-    TreeNode* node = this->appendChild(parentId);
-    node->data = data;
-    return this->lastNodeId();
+    const TreeNodeId nodeId = this->appendChild(parentId);
+    m_vecNodeData[nodeId - 1] = data;
+    return nodeId;
 }
 
 template<typename T>
 TreeNodeId Tree<T>::appendChild(TreeNodeId parentId, T&& data)
 {
-    TreeNode* node = this->appendChild(parentId);
-    node->data = std::forward<T>(data);
-    return this->lastNodeId();
+    const TreeNodeId nodeId = this->appendChild(parentId);
+    m_vecNodeData[nodeId - 1] = std::forward<T>(data);
+    return nodeId;
 }
 
 template<typename T>
-typename Tree<T>::TreeNode* Tree<T>::appendChild(TreeNodeId parentId)
+TreeNodeId Tree<T>::appendChild(TreeNodeId parentId)
 {
-    m_vecNode.push_back({});
-    const TreeNodeId nodeId = this->lastNodeId();
-    TreeNode* node = &m_vecNode.back();
+    TreeNodeId nodeId = 0;
+    if (!m_vecFreeNodeId.empty()) {
+        nodeId = m_vecFreeNodeId.back();
+        m_vecFreeNodeId.pop_back();
+        m_vecNodeDeleted[nodeId - 1] = false;
+    }
+    else {
+        m_vecNodeLinks.push_back({});
+        m_vecNodeData.emplace_back();
+        m_vecNodeDeleted.push_back(false);
+        nodeId = this->lastNodeId();
+    }
+
+    TreeNodeLinks* node = this->ptrNode(nodeId);
+    *node = {};
     node->parent = parentId;
     node->siblingPrevious = this->nodeChildLast(parentId);
     if (parentId != 0) {
-        TreeNode* parentNode = this->ptrNode(parentId);
+        TreeNodeLinks* parentNode = this->ptrNode(parentId);
         if (parentNode->childFirst == 0)
             parentNode->childFirst = nodeId;
 
@@ -234,27 +269,72 @@ typename Tree<T>::TreeNode* Tree<T>::appendChild(TreeNodeId parentId)
         m_vecRoot.push_back(nodeId);
     }
 
-    return node;
+    return nodeId;
 }
 
 template<typename T> bool Tree<T>::isNodeDeleted(TreeNodeId id) const
 {
-    const auto node = this->ptrNode(id);
-    return !node || node->isDeleted;
+    return id == 0 || id > m_vecNodeDeleted.size() || m_vecNodeDeleted[id - 1];
+}
+
+template<typename T> void Tree<T>::deleteNode(TreeNodeId id)
+{
+    for (TreeNodeId it = this->nodeChildFirst(id); it != 0;) {
+        const TreeNodeId itNext = this->nodeSiblingNext(it);
+        this->deleteNode(it);
+        it = itNext;
+    }
+
+    *this->ptrNode(id) = {};
+    m_vecNodeData[id - 1] = T{}; // Release resources now
+    m_vecNodeDeleted[id - 1] = true;
+    m_vecFreeNodeId.push_back(id);
 }
 
 template<typename T> void Tree<T>::removeRoot(TreeNodeId id)
 {
     Expects(this->nodeIsRoot(id));
 
-    // TODO Mark all deep children nodes as 'deleted'
     auto it = std::find(m_vecRoot.begin(), m_vecRoot.end(), id);
     if (it != m_vecRoot.end()) {
-        TreeNode* node = this->ptrNode(id);
-        Expects(node != nullptr);
-        node->isDeleted = true;
         m_vecRoot.erase(it);
+        this->deleteNode(id);
+    }
+}
+
+template<typename T> std::vector<TreeNodeId> Tree<T>::compact()
+{
+    // Renumber nodes in pre-order, so nodes of a same sub-tree get contiguous slots
+    std::vector<TreeNodeId> vecOldToNewId(this->lastNodeId() + 1, 0);
+    TreeNodeId newId = 0;
+    traverseTree_preOrder(*this, [&](TreeNodeId oldId) { vecOldToNewId[oldId] = ++newId; });
+
+    std::vector<TreeNodeLinks> vecNodeLinks(newId);
+    std::vector<T> vecNodeData(newId);
+    for (TreeNodeId oldId = 1; oldId <= this->lastNodeId(); ++oldId) {
+        const TreeNodeId id = vecOldToNewId[oldId];
+        if (id == 0)
+            continue;
+
+        const TreeNodeLinks& oldNode = m_vecNodeLinks[oldId - 1];
+        TreeNodeLinks& node = vecNodeLinks[id - 1];
+        node.siblingPrevious = vecOldToNewId[oldNode.siblingPrevious];
+        node.siblingNext = vecOldToNewId[oldNode.siblingNext];
+        node.childFirst = vecOldToNewId[oldNode.childFirst];
+        node.childLast = vecOldToNewId[oldNode.childLast];
+        node.parent = vecOldToNewId[oldNode.parent];
+        vecNodeData[id - 1] = std::move(m_vecNodeData[oldId - 1]);
     }
+
+    for (TreeNodeId& rootId : m_vecRoot)
+        rootId = vecOldToNewId[rootId];
+
+    m_vecNodeLinks = std::move(vecNodeLinks);
+    m_vecNodeData = std::move(vecNodeData);
+    m_vecNodeDeleted.assign(newId, false);
+    m_vecFreeNodeId.clear();
+    m_vecFreeNodeId.shrink_to_fit();
+    return vecOldToNewId;
 }
 
 template<typename T> Span<const TreeNodeId> Tree<T>::roots() const {
@@ -262,17 +342,25 @@ template<typename T> Span<const TreeNodeId> Tree<T>::roots() const {
 }
 
 template<typename T> TreeNodeId Tree<T>::lastNodeId() const {
-    return static_cast<TreeNodeId>(m_vecNode.size());
+    return static_cast<TreeNodeId>(m_vecNodeLinks.size());
+}
+
+template<typename T> size_t Tree<T>::nodeCount() const {
+    return m_vecNodeLinks.size() - m_vecFreeNodeId.size();
+}
+
+template<typename T> size_t Tree<T>::deletedNodeCount() const {
+    return m_vecFreeNodeId.size();
 }
 
 template<typename T>
-typename Tree<T>::TreeNode* Tree<T>::ptrNode(TreeNodeId id) {
-    return id != 0 && id <= m_vecNode.size() ? &m_vecNode.at(id - 1) : nullptr;
+typename Tree<T>::TreeNodeLinks* Tree<T>::ptrNode(TreeNodeId id) {
+    return id != 0 && id <= m_vecNodeLinks.size() ? &m_vecNodeLinks[id - 1] : nullptr;
 }
 
 template<typename T>
-const typename Tree<T>::TreeNode* Tree<T>::ptrNode(TreeNodeId id) const {
-    return id != 0 && id <= m_vecNode.size() ? &m_vecNode.at(id - 1) : nullptr;
+const typename Tree<T>::TreeNodeLinks* Tree<T>::ptrNode(TreeNodeId id) const {
+    return id != 0 && id <= m_vecNodeLinks.size() ? &m_vecNodeLinks[id - 1] : nullptr;
 }
 
 template<typename T, typename FN>
@@ -301,10 +389,10 @@ void traverseTree(TreeNodeId id, const Tree<T>& tree, const FN& callback, TreeTr
 template<typename T, typename FN>
 void traverseTree_unorder(const Tree<T>& tree, const FN& callback)
 {
-    for (const typename Tree<T>::TreeNode& node : tree.m_vecNode) {
-        const auto id = CppUtils::safeStaticCast<TreeNodeId>((&node - &tree.m_vecNode.front()) + 1);
-        if (!tree.isNodeDeleted(id))
-            callback(id);
+    const auto nodeCount = CppUtils::safeStaticCast<TreeNodeId>(tree.m_vecNodeDeleted.size());
+    for (TreeNodeId i = 0; i < nodeCount; ++i) {
+        if (!tree.m_vecNodeDeleted[i])
+            callback(i + 1);
     }
 }
 
@@ -46,7 +46,7 @@ public:
                 m_nodeColors = annexData->nodeColors();
         }
 
-        const TopLoc_Location locShape = XCaf::shapeAbsoluteLocation(doc->modelTree(), treeNode.id());
+        const TopLoc_Location locShape = doc->modelTreeNodeAbsoluteLocation(treeNode.id());
         TopLoc_Location locFace;
         m_triangulation = BRep_Tool::Triangulation(face, locFace);
         m_location = locShape * locFace;
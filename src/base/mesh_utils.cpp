@@ -7,9 +7,14 @@
 #include "mesh_utils.h"
 #include "math_utils.h"
 
+#include <OSD_Parallel.hxx>
+
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <limits>
 #include <stdexcept>
+#include <vector>
 
 namespace Mayo {
 namespace MeshUtils {
@@ -25,6 +30,153 @@ namespace {
         return TColStd_Array1OfReal();
 }
 
+// Count of triangles(or nodes) processed by a single parallel task
+constexpr int MetricsChunkSize = 64 * 1024;
+
+// Partial sums computed by a chunk of triangles
+// Volume integrals are computed on the tetrahedrons formed by the origin and each triangle
+struct MetricsAccumulator {
+    double area = 0;
+    double volume = 0;
+    double volumeMoment[3] = {}; // First moment of volume(sum of volume * centroid)
+    double areaMoment[3] = {}; // First moment of area, used when the volume is null
+    double covariance[6] = {}; // Second moments: xx, yy, zz, xy, xz, yz
+
+    void add(const MetricsAccumulator& other)
+    {
+        this->area += other.area;
+        this->volume += other.volume;
+        for (int i = 0; i < 3; ++i) {
+            this->volumeMoment[i] += other.volumeMoment[i];
+            this->areaMoment[i] += other.areaMoment[i];
+        }
+
+        for (int i = 0; i < 6; ++i)
+            this->covariance[i] += other.covariance[i];
+    }
+};
+
+// Min/max coordinates of a chunk of nodes
+struct MetricsBox {
+    double min[3] = {
+        std::numeric_limits<double>::max(),
+        std::numeric_limits<double>::max(),
+        std::numeric_limits<double>::max()
+    };
+    double max[3] = {
+        std::numeric_limits<double>::lowest(),
+        std::numeric_limits<double>::lowest(),
+        std::numeric_limits<double>::lowest()
+    };
+};
+
+int metricsChunkCount(int itemCount)
+{
+    return itemCount > 0 ? (itemCount + MetricsChunkSize - 1) / MetricsChunkSize : 0;
+}
+
+// Computes metrics of triangulation with 'fnNode' giving the coordinates of a node from its
+// zero-based index
+// Each chunk accumulates into its own local sums, partial results are then reduced in chunk order
+template<typename NodeFunction>
+TriangulationMetrics computeTriangulationMetrics(
+        const Poly_Array1OfTriangle& triangles, int nodeCount, NodeFunction fnNode
+    )
+{
+    const int triangleCount = triangles.Length();
+    const int triangleLower = triangles.Lower();
+    std::vector<MetricsAccumulator> vecAccum(metricsChunkCount(triangleCount));
+    OSD_Parallel::For(0, static_cast<int>(vecAccum.size()), [&](int iChunk) {
+        const int iFirst = iChunk * MetricsChunkSize;
+        const int iLast = std::min(iFirst + MetricsChunkSize, triangleCount);
+        MetricsAccumulator accum;
+        for (int i = iFirst; i < iLast; ++i) {
+            int n1, n2, n3;
+            triangles.Value(triangleLower + i).Get(n1, n2, n3);
+            const gp_XYZ p1 = fnNode(n1 - 1);
+            const gp_XYZ p2 = fnNode(n2 - 1);
+            const gp_XYZ p3 = fnNode(n3 - 1);
+            const gp_XYZ sum = p1 + p2 + p3;
+            const double triArea = 0.5 * ((p2 - p1).Crossed(p3 - p1)).Modulus();
+            const double tetVolume = p1.Dot(p2.Crossed(p3)) / 6.;
+            accum.area += triArea;
+            accum.volume += tetVolume;
+            for (int c = 0; c < 3; ++c) {
+                accum.volumeMoment[c] += tetVolume * sum.Coord(c + 1) / 4.;
+                accum.areaMoment[c] += triArea * sum.Coord(c + 1) / 3.;
+            }
+
+            // Covariance of tetrahedron(origin, p1, p2, p3) is:
+            //     volume/20 * (p1*p1^T + p2*p2^T + p3*p3^T + sum*sum^T)
+            auto fnCov = [&](int a, int b) {
+                return tetVolume / 20. * (
+                    p1.Coord(a) * p1.Coord(b) + p2.Coord(a) * p2.Coord(b) + p3.Coord(a) * p3.Coord(b)
+                    + sum.Coord(a) * sum.Coord(b)
+                );
+            };
+            accum.covariance[0] += fnCov(1, 1);
+            accum.covariance[1] += fnCov(2, 2);
+            accum.covariance[2] += fnCov(3, 3);
+            accum.covariance[3] += fnCov(1, 2);
+            accum.covariance[4] += fnCov(1, 3);
+            accum.covariance[5] += fnCov(2, 3);
+        }
+
+        vecAccum.at(iChunk) = accum;
+    });
+
+    std::vector<MetricsBox> vecBox(metricsChunkCount(nodeCount));
+    OSD_Parallel::For(0, static_cast<int>(vecBox.size()), [&](int iChunk) {
+        const int iFirst = iChunk * MetricsChunkSize;
+        const int iLast = std::min(iFirst + MetricsChunkSize, nodeCount);
+        MetricsBox box;
+        for (int i = iFirst; i < iLast; ++i) {
+            const gp_XYZ pnt = fnNode(i);
+            for (int c = 0; c < 3; ++c) {
+                box.min[c] = std::min(box.min[c], pnt.Coord(c + 1));
+                box.max[c] = std::max(box.max[c], pnt.Coord(c + 1));
+            }
+        }
+
+        vecBox.at(iChunk) = box;
+    });
+
+    // Reduce partial results, in chunk order so results don't depend on thread scheduling
+    MetricsAccumulator total;
+    for (const MetricsAccumulator& accum : vecAccum)
+        total.add(accum);
+
+    TriangulationMetrics metrics;
+    for (const MetricsBox& box : vecBox)
+        metrics.boundingBox.Update(box.min[0], box.min[1], box.min[2], box.max[0], box.max[1], box.max[2]);
+
+    metrics.area = total.area;
+    metrics.signedVolume = total.volume;
+    if (std::abs(total.volume) > std::numeric_limits<double>::epsilon()) {
+        const gp_XYZ c = gp_XYZ(total.volumeMoment[0], total.volumeMoment[1], total.volumeMoment[2]) / total.volume;
+        metrics.centroid = c;
+        // Covariance relative to the centroid, made positive whatever the orientation of triangles
+        const double sign = total.volume < 0 ? -1. : 1.;
+        const double vol = std::abs(total.volume);
+        const double cxx = sign * total.covariance[0] - vol * c.X() * c.X();
+        const double cyy = sign * total.covariance[1] - vol * c.Y() * c.Y();
+        const double czz = sign * total.covariance[2] - vol * c.Z() * c.Z();
+        const double cxy = sign * total.covariance[3] - vol * c.X() * c.Y();
+        const double cxz = sign * total.covariance[4] - vol * c.X() * c.Z();
+        const double cyz = sign * total.covariance[5] - vol * c.Y() * c.Z();
+        metrics.inertia = gp_Mat(
+            cyy + czz, -cxy, -cxz,
+            -cxy, cxx + czz, -cyz,
+            -cxz, -cyz, cxx + cyy
+        );
+    }
+    else if (total.area > 0) {
+        metrics.centroid = gp_XYZ(total.areaMoment[0], total.areaMoment[1], total.areaMoment[2]) / total.area;
+    }
+
+    return metrics;
+}
+
 } // namespace
 
 double triangleSignedVolume(const gp_XYZ& p1, const gp_XYZ& p2, const gp_XYZ& p3)
@@ -48,42 +200,43 @@ double triangleArea(const gp_XYZ& p1, const gp_XYZ& p2, const gp_XYZ& p3)
 
 double triangulationVolume(const OccHandle<Poly_Triangulation>& triangulation)
 {
-    if (!triangulation)
-        return 0;
-
-    double volume = 0;
-    // TODO Parallelize computation
-    for (const Poly_Triangle& tri : MeshUtils::triangles(triangulation)) {
-        int v1, v2, v3;
-        tri.Get(v1, v2, v3);
-        volume += MeshUtils::triangleSignedVolume(
-                    triangulation->Node(v1).Coord(),
-                    triangulation->Node(v2).Coord(),
-                    triangulation->Node(v3).Coord()
-            );
-    }
-
-    return std::abs(volume);
+    return std::abs(MeshUtils::triangulationMetrics(triangulation).signedVolume);
 }
 
 double triangulationArea(const OccHandle<Poly_Triangulation>& triangulation)
+{
+    return MeshUtils::triangulationMetrics(triangulation).area;
+}
+
+TriangulationMetrics triangulationMetrics(const OccHandle<Poly_Triangulation>& triangulation)
 {
     if (!triangulation)
-        return 0;
+        return {};
 
-    double area = 0;
-    // TODO Parallelize computation
-    for (const Poly_Triangle& tri : MeshUtils::triangles(triangulation)) {
-        int v1, v2, v3;
-        tri.Get(v1, v2, v3);
-        area += MeshUtils::triangleArea(
-                    triangulation->Node(v1).Coord(),
-                    triangulation->Node(v2).Coord(),
-                    triangulation->Node(v3).Coord()
-            );
+    const Poly_Array1OfTriangle& triangles = MeshUtils::triangles(triangulation);
+    const int nodeCount = triangulation->NbNodes();
+#if OCC_VERSION_HEX >= 0x070600
+    // Access directly the node array, avoiding the precision check done by Poly_Triangulation::Node()
+    const Poly_ArrayOfNodes& nodes = triangulation->InternalNodes();
+    if (nodes.IsDoublePrecision()) {
+        return computeTriangulationMetrics(triangles, nodeCount, [&](int i) {
+            const gp_Vec3d& pnt = nodes.Value3d(i);
+            return gp_XYZ(pnt.x(), pnt.y(), pnt.z());
+        });
     }
-
-    return area;
+    else {
+        return computeTriangulationMetrics(triangles, nodeCount, [&](int i) {
+            const gp_Vec3f& pnt = nodes.Value3f(i);
+            return gp_XYZ(pnt.x(), pnt.y(), pnt.z());
+        });
+    }
+#else
+    const TColgp_Array1OfPnt& nodes = triangulation->Nodes();
+    const int nodeLower = nodes.Lower();
+    return computeTriangulationMetrics(triangles, nodeCount, [&](int i) {
+        return nodes.Value(nodeLower + i).XYZ();
+    });
+#endif
 }
 
 void setNode(const OccHandle<Poly_Triangulation>& triangulation, int index, const gp_Pnt& pnt)
@@ -159,6 +312,15 @@ const Poly_Array1OfTriangle& triangles(const OccHandle<Poly_Triangulation>& tria
 #endif
 }
 
+Poly_Array1OfTriangle& changeTriangles(const OccHandle<Poly_Triangulation>& triangulation)
+{
+#if OCC_VERSION_HEX < 0x070600
+    return triangulation->ChangeTriangles();
+#else
+    return triangulation->InternalTriangles();
+#endif
+}
+
 // Adapted from http://cs.smith.edu/~jorourke/Code/polyorient.C
 MeshUtils::Orientation orientation(const AdaptorPolyline2d& polyline)
 {
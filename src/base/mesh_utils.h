@@ -8,6 +8,9 @@
 
 #include "occ_handle.h"
 
+#include <Bnd_Box.hxx>
+#include <gp_Mat.hxx>
+#include <gp_Pnt.hxx>
 #include <Poly_Polygon3D.hxx>
 #include <Poly_Triangulation.hxx>
 #include <Standard_Version.hxx>
@@ -24,6 +27,18 @@ double triangleArea(const gp_XYZ& p1, const gp_XYZ& p2, const gp_XYZ& p3);
 double triangulationVolume(const OccHandle<Poly_Triangulation>& triangulation);
 double triangulationArea(const OccHandle<Poly_Triangulation>& triangulation);
 
+// Geometric properties of a triangulation, assumed to be a closed mesh for the volume properties
+struct TriangulationMetrics {
+    double area = 0;
+    double signedVolume = 0; // Negative if triangles are oriented inwards
+    gp_Pnt centroid; // Center of the enclosed volume(center of the surface if volume is null)
+    gp_Mat inertia{ 0, 0, 0, 0, 0, 0, 0, 0, 0 }; // Inertia tensor relative to 'centroid', assuming unit density
+    Bnd_Box boundingBox;
+};
+
+// Computes all the metrics in a single(parallel) pass over the triangles
+TriangulationMetrics triangulationMetrics(const OccHandle<Poly_Triangulation>& triangulation);
+
 #if OCC_VERSION_HEX >= 0x070600
 using Poly_Triangulation_NormalType = gp_Vec3f;
 #else
@@ -39,6 +54,7 @@ void allocateNormals(const OccHandle<Poly_Triangulation>& triangulation);
 
 Poly_Triangulation_NormalType normal(const OccHandle<Poly_Triangulation>& triangulation, int index);
 const Poly_Array1OfTriangle& triangles(const OccHandle<Poly_Triangulation>& triangulation);
+Poly_Array1OfTriangle& changeTriangles(const OccHandle<Poly_Triangulation>& triangulation);
 
 enum class Orientation {
     Unknown,
@@ -19,4 +19,8 @@ constexpr TaskId TaskId_null = UINT64_MAX;
 // Syntactic sugar for task auto-deletion flag(see TaskManager::run/exec())
 enum class TaskAutoDestroy { On, Off };
 
+// Scheduling priority of a task(see TaskManager::run())
+// Interactive tasks are picked before background ones by the thread pool
+enum class TaskPriority { Interactive, Background };
+
 } // namespace Mayo
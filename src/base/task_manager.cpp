@@ -8,9 +8,12 @@
 
 #include "cpp_utils.h"
 #include "math_utils.h"
+#include "task_thread_pool.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cmath>
 #include <future>
 #include <memory>
@@ -32,7 +35,9 @@ struct TaskManager::Entity {
 // Pimpl struct providing private(hidden) interface of TaskManager class
 struct TaskManager::Private {
     // Ctor
-    Private(TaskManager* mgr) : taskMgr(mgr) {}
+    Private(TaskManager* mgr, TaskThreadPool* pool)
+        : taskMgr(mgr), threadPool(pool ? pool : &TaskThreadPool::globalInstance())
+    {}
 
     // Const/mutable functions to find an Entity from a task identifier. Returns null if not found
     TaskManager::Entity* findEntity(TaskId id);
@@ -41,27 +46,28 @@ struct TaskManager::Private {
     // Execute(synchronous) task entity, sending started/ended signals accordingly
     void execEntity(TaskManager::Entity* entity);
 
+    // Blocks until task entity has finished or 'msecs' elapsed(no timeout if 'msecs < 0')
+    bool waitEntity(TaskManager::Entity* entity, int msecs);
+
     // Destroy finished task entities whose policy was set to TaskAutoDestroy::On
     void cleanGarbage();
 
     TaskManager* taskMgr = nullptr;
+    TaskThreadPool* threadPool = nullptr;
     std::atomic<TaskId> taskIdSeq = {};
     std::unordered_map<TaskId, std::unique_ptr<TaskManager::Entity>> mapEntity;
 };
 
-TaskManager::TaskManager()
-    : d(new Private(this))
+TaskManager::TaskManager(TaskThreadPool* pool)
+    : d(new Private(this, pool))
 {
 }
 
 TaskManager::~TaskManager()
 {
     // Make sure all tasks are really finished
-    for (const auto& mapPair : d->mapEntity) {
-        const std::unique_ptr<Entity>& ptrEntity = mapPair.second;
-        if (ptrEntity->control.valid())
-            ptrEntity->control.wait();
-    }
+    for (const auto& mapPair : d->mapEntity)
+        d->waitEntity(mapPair.second.get(), -1);
 
     // Erase the task from its container before destruction, this will allow TaskProgress destructor
     // to behave correctly(it calls TaskProgress::setValue())
@@ -83,7 +89,7 @@ TaskId TaskManager::newTask(TaskJob fn)
     return taskId;
 }
 
-void TaskManager::run(TaskId id, TaskAutoDestroy policy)
+void TaskManager::run(TaskId id, TaskAutoDestroy policy, TaskPriority priority)
 {
     d->cleanGarbage();
     Entity* entity = d->findEntity(id);
@@ -92,7 +98,9 @@ void TaskManager::run(TaskId id, TaskAutoDestroy policy)
 
     entity->isFinished = false;
     entity->autoDestroy = policy;
-    entity->control = std::async([=]{ d->execEntity(entity); });
+    auto job = std::make_shared<std::packaged_task<void()>>([=]{ d->execEntity(entity); });
+    entity->control = job->get_future();
+    d->threadPool->start([=]{ (*job)(); }, priority);
 }
 
 void TaskManager::exec(TaskId id, TaskAutoDestroy policy)
@@ -113,15 +121,7 @@ bool TaskManager::waitForDone(TaskId id, int msecs)
     if (!entity)
         return true;
 
-    if (!entity->control.valid())
-        return true;
-
-    if (msecs < 0) {
-        entity->control.wait();
-        return true;
-    }
-
-    return entity->control.wait_for(std::chrono::milliseconds(msecs)) == std::future_status::ready;
+    return d->waitEntity(entity, msecs);
 }
 
 void TaskManager::requestAbort(TaskId id)
@@ -133,6 +133,17 @@ void TaskManager::requestAbort(TaskId id)
     }
 }
 
+void TaskManager::flushPendingProgress()
+{
+    for (const auto& mapPair : d->mapEntity)
+        mapPair.second->taskProgress.flushPendingNotification();
+}
+
+TaskThreadPool* TaskManager::threadPool() const
+{
+    return d->threadPool;
+}
+
 void TaskManager::foreachTask(const std::function<void(TaskId)>& fn)
 {
     for (const auto& mapPair : d->mapEntity)
@@ -198,6 +209,35 @@ void TaskManager::Private::execEntity(Entity* entity)
     entity->isFinished = true;
 }
 
+bool TaskManager::Private::waitEntity(Entity* entity, int msecs)
+{
+    if (!entity || !entity->control.valid())
+        return true;
+
+    if (!this->threadPool->isWorkerThread()) {
+        if (msecs < 0) {
+            entity->control.wait();
+            return true;
+        }
+
+        return entity->control.wait_for(std::chrono::milliseconds(msecs)) == std::future_status::ready;
+    }
+
+    // Current thread is a worker of the pool: blocking it might starve the pool in case the awaited
+    // task is still queued, so execute pending jobs meanwhile
+    using Clock = std::chrono::steady_clock;
+    const auto timeEnd = Clock::now() + std::chrono::milliseconds(std::max(msecs, 0));
+    while (entity->control.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        if (msecs >= 0 && Clock::now() >= timeEnd)
+            return false;
+
+        if (!this->threadPool->tryRunPendingJob())
+            entity->control.wait_for(std::chrono::milliseconds(1));
+    }
+
+    return true;
+}
+
 void TaskManager::Private::cleanGarbage()
 {
     auto it = this->mapEntity.begin();
@@ -15,6 +15,8 @@
 
 namespace Mayo {
 
+class TaskThreadPool;
+
 // Piece of code to be executed as a task(ie with TaskManager::run/exec())
 using TaskJob = std::function<void(TaskProgress*)>;
 
@@ -22,7 +24,8 @@ using TaskJob = std::function<void(TaskProgress*)>;
 class TaskManager {
 public:
     // Ctor & dtor
-    TaskManager();
+    // Asynchronous tasks are executed by 'pool', if null then TaskThreadPool::globalInstance() is used
+    TaskManager(TaskThreadPool* pool = nullptr);
     ~TaskManager();
 
     // Not copyable
@@ -36,10 +39,14 @@ public:
     // Asynchronous execution of job associated with task identifier 'id'
     // By default destroy policy is set to 'On' meaning the task will be deleted at some point
     // after its completion
-    // This function is based on std::async() so depending on the C++ stdlib implementation this is
-    // probably using a thread pool
+    // The job is queued in the thread pool of the manager, concurrency is bounded by
+    // TaskThreadPool::maxThreadCount()
     // NOTE The task must have been allocated previously with newTask()
-    void run(TaskId id, TaskAutoDestroy policy = TaskAutoDestroy::On);
+    void run(
+        TaskId id,
+        TaskAutoDestroy policy = TaskAutoDestroy::On,
+        TaskPriority priority = TaskPriority::Interactive
+    );
 
     // Same as run() but execution of the task job is synchronous(it runs in the current thread
     // just like a regular function call)
@@ -57,6 +64,8 @@ public:
     void setTitle(TaskId id, std::string_view title);
 
     // Blocks the current thread until task of identifier 'id' has finished
+    // If the current thread is a worker of the thread pool then pending jobs are executed while
+    // waiting, this prevents deadlocks when tasks are waiting for other(nested) tasks
     bool waitForDone(TaskId id, int msecs = -1);
 
     // Instructs the task of identifier 'id' to abort as soon as possible
@@ -64,6 +73,15 @@ public:
     // TaskProgress::isAbortRequested() flag and interrupt consequently
     void requestAbort(TaskId id);
 
+    // Emits signalProgressChanged for tasks whose last progress value was throttled and not
+    // notified yet(see TaskProgress::NotifyMaxRate)
+    // Should be called periodically by the thread owning the manager while tasks are running, for
+    // example with a timer of interval 1000 / TaskProgress::NotifyMaxRate milliseconds
+    void flushPendingProgress();
+
+    // Thread pool used to execute asynchronous tasks
+    TaskThreadPool* threadPool() const;
+
     // Applies function 'fn' to each task
     void foreachTask(const std::function<void(TaskId)>& fn);
 
@@ -8,11 +8,31 @@
 #include "task_manager.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <limits>
 
 namespace Mayo {
 
+namespace {
+
+// Progress values are accumulated as fixed-point integers, this is the value mapped to 100%
+// Fine resolution avoids loss of small contributions from children with little portion size
+constexpr int64_t ProgressUnitsMax = 1000000;
+
+int64_t toProgressUnits(int pct)
+{
+    return static_cast<int64_t>(pct) * (ProgressUnitsMax / 100);
+}
+
+int64_t steadyTimeMsecs()
+{
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
 TaskProgress::TaskProgress(TaskProgress* parent, double portionSize, std::string_view step)
     : m_parent(parent),
       m_taskMgr(parent ? parent->m_taskMgr : nullptr),
@@ -40,6 +60,12 @@ bool TaskProgress::isNull() const
     return m_taskId == TaskId_null;
 }
 
+int TaskProgress::value() const
+{
+    const int64_t units = std::clamp<int64_t>(m_units.load(std::memory_order_relaxed), 0, ProgressUnitsMax);
+    return static_cast<int>(units * 100 / ProgressUnitsMax);
+}
+
 void TaskProgress::setValue(int pct)
 {
     if (m_taskId == TaskId_null)
@@ -48,18 +74,15 @@ void TaskProgress::setValue(int pct)
     if (m_isAbortRequested)
         return;
 
-    const int valueOnEntry = m_value;
-    m_value = std::clamp(pct, 0, 100);
-    if (m_value != 0 && m_value == valueOnEntry)
+    const int64_t units = toProgressUnits(std::clamp(pct, 0, 100));
+    const int64_t unitsOnEntry = m_units.exchange(units, std::memory_order_relaxed);
+    if (units != 0 && units == unitsOnEntry)
         return;
 
-    if (m_parent) {
-        const auto valueDeltaInParent = std::round((m_value - valueOnEntry) * (m_portionSize / 100.));
-        m_parent->setValue(m_parent->value() + valueDeltaInParent);
-    }
-    else {
-        m_taskMgr->signalProgressChanged.send(m_taskId, m_value);
-    }
+    if (m_parent)
+        m_parent->accumulate(std::llround((units - unitsOnEntry) * (m_portionSize / 100.)));
+    else
+        this->notifyValueChanged();
 }
 
 void TaskProgress::setValue(double pct)
@@ -86,4 +109,58 @@ void TaskProgress::requestAbort()
         m_isAbortRequested = true;
 }
 
+void TaskProgress::accumulate(int64_t units)
+{
+    if (m_isAbortRequested)
+        return;
+
+    if (units != 0)
+        m_units.fetch_add(units, std::memory_order_relaxed);
+
+    if (m_parent)
+        m_parent->accumulate(std::llround(units * (m_portionSize / 100.)));
+    else
+        this->notifyValueChanged();
+}
+
+void TaskProgress::notifyValueChanged()
+{
+    const int pct = this->value();
+    if (pct == m_lastNotifiedValue.load(std::memory_order_relaxed))
+        return; // Fast path: nothing new to notify
+
+    // Throttle intermediate values, only one thread wins the right to emit in a time slot
+    // Values not emitted are kept pending, see flushPendingNotification()
+    if (pct != 0 && pct != 100) {
+        const int64_t timeNow = steadyTimeMsecs();
+        int64_t timeLastNotify = m_lastNotifyTime.load(std::memory_order_relaxed);
+        if (timeNow - timeLastNotify < 1000 / NotifyMaxRate) {
+            m_isNotifyPending = true;
+            return;
+        }
+
+        if (!m_lastNotifyTime.compare_exchange_strong(timeLastNotify, timeNow)) {
+            m_isNotifyPending = true;
+            return;
+        }
+    }
+
+    m_isNotifyPending = false;
+    if (m_lastNotifiedValue.exchange(pct) != pct)
+        m_taskMgr->signalProgressChanged.send(m_taskId, pct);
+
+    // Value might have changed concurrently while emitting, don't lose it
+    if (this->value() != pct)
+        m_isNotifyPending = true;
+}
+
+void TaskProgress::flushPendingNotification()
+{
+    if (m_parent || m_taskId == TaskId_null || m_isAbortRequested)
+        return;
+
+    if (m_isNotifyPending)
+        this->notifyValueChanged();
+}
+
 } // namespace Mayo
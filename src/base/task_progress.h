@@ -8,6 +8,7 @@
 
 #include "task_common.h"
 #include <atomic>
+#include <cstdint>
 #include <string>
 #include <string_view>
 
@@ -16,6 +17,13 @@ namespace Mayo {
 class TaskManager;
 
 // Provides feedback on the progress of a running/executing task
+//
+// TaskProgress objects form a tree: progress of a child is accumulated into its parent according to
+// the portion size of the child. Accumulation is lock-free, so children can progress concurrently.
+// Only the root TaskProgress emits TaskManager::signalProgressChanged: emission is throttled(at
+// most NotifyMaxRate per second) and coalesced, so calling setValue() in tight loops is cheap
+// A throttled value is kept pending: it's emitted by the next progress change once the throttling
+// window has expired, or by TaskManager::flushPendingProgress()
 class TaskProgress {
 public:
     TaskProgress() = default;
@@ -28,8 +36,12 @@ public:
     TaskId taskId() const { return m_taskId; }
     TaskManager* taskManager() const { return m_taskMgr; }
 
+    // Maximum count of progress notifications per second for a root task
+    // Note: values 0 and 100 are always notified
+    static constexpr int NotifyMaxRate = 20;
+
     // Value in [0,100]
-    int value() const { return m_value; }
+    int value() const;
     void setValue(int pct);
     void setValue(double pct);
 
@@ -54,15 +66,25 @@ private:
     void setTaskManager(TaskManager* mgr) { m_taskMgr = mgr; }
     void requestAbort();
 
+    // Adds 'units' to the accumulated value of this progress and its parents
+    void accumulate(int64_t units);
+    // Emits progress signal(root only) unless the last emission is too recent
+    void notifyValueChanged();
+    // Emits the last throttled value(root only) if the throttling window has expired
+    void flushPendingNotification();
+
     friend class TaskManager;
 
     TaskProgress* m_parent = nullptr;
     TaskManager* m_taskMgr = nullptr;
     TaskId m_taskId = TaskId_null;
     double m_portionSize = -1;
-    std::atomic<int> m_value = 0;
+    std::atomic<int64_t> m_units = 0; // Fixed-point value, see ProgressUnitsMax
+    std::atomic<int> m_lastNotifiedValue = -1;
+    std::atomic<int64_t> m_lastNotifyTime = 0; // In milliseconds, from steady clock
+    std::atomic<bool> m_isNotifyPending = false;
     std::string m_step;
-    bool m_isAbortRequested = false;
+    std::atomic<bool> m_isAbortRequested = false;
 };
 
 } // namespace Mayo
@@ -0,0 +1,249 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "task_thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Mayo {
+
+namespace {
+
+constexpr int TaskPriority_Count = 2;
+
+int toIndex(TaskPriority priority)
+{
+    return priority == TaskPriority::Interactive ? 0 : 1;
+}
+
+int defaultThreadCount()
+{
+    const auto count = static_cast<int>(std::thread::hardware_concurrency());
+    return count > 0 ? count : 2;
+}
+
+} // namespace
+
+// Worker thread and its queues of jobs
+struct TaskThreadPool::Worker {
+    TaskThreadPool::Private* pool = nullptr;
+    int index = -1;
+    std::thread thread;
+    std::mutex mutexQueues;
+    std::array<std::deque<TaskThreadPool::Job>, TaskPriority_Count> queues;
+};
+
+// Pimpl struct providing private(hidden) interface of TaskThreadPool class
+struct TaskThreadPool::Private {
+    // Lazily creates the worker threads
+    void ensureStarted();
+
+    // Worker thread entry point
+    void workerLoop(TaskThreadPool::Worker* worker);
+
+    // Pops a job from the queues of worker 'index' or steals it from other workers
+    // 'index' can be -1 when the calling thread is not a worker
+    bool popJob(int index, TaskThreadPool::Job* job);
+
+    // Pushes 'job' into queue of worker at 'index' and wakes up some idle worker
+    void pushJob(int index, TaskThreadPool::Job job, TaskPriority priority);
+
+    int maxThreadCount = 0;
+    std::once_flag startedFlag;
+    std::vector<std::unique_ptr<TaskThreadPool::Worker>> vecWorker;
+    std::atomic<unsigned> roundRobinSeq = 0;
+    std::atomic<int> pendingJobCount = 0;
+    std::mutex mutexIdle;
+    std::condition_variable condIdle;
+    bool stopRequested = false;
+
+    // Worker object associated to the current thread(null if the thread doesn't belong to any pool)
+    static thread_local TaskThreadPool::Worker* currentWorker;
+};
+
+thread_local TaskThreadPool::Worker* TaskThreadPool::Private::currentWorker = nullptr;
+
+TaskThreadPool::TaskThreadPool(int maxThreadCount)
+    : d(new Private)
+{
+    d->maxThreadCount = maxThreadCount > 0 ? maxThreadCount : defaultThreadCount();
+}
+
+TaskThreadPool::~TaskThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(d->mutexIdle);
+        d->stopRequested = true;
+    }
+
+    d->condIdle.notify_all();
+    for (const std::unique_ptr<Worker>& worker : d->vecWorker) {
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+
+    delete d;
+}
+
+TaskThreadPool& TaskThreadPool::globalInstance()
+{
+    static TaskThreadPool pool;
+    return pool;
+}
+
+int TaskThreadPool::maxThreadCount() const
+{
+    return d->maxThreadCount;
+}
+
+void TaskThreadPool::setMaxThreadCount(int count)
+{
+    if (d->vecWorker.empty())
+        d->maxThreadCount = count > 0 ? count : defaultThreadCount();
+}
+
+void TaskThreadPool::start(Job job, TaskPriority priority)
+{
+    if (!job)
+        return;
+
+    d->ensureStarted();
+    Worker* worker = Private::currentWorker;
+    if (worker && worker->pool == d) {
+        d->pushJob(worker->index, std::move(job), priority);
+    }
+    else {
+        const auto workerCount = static_cast<unsigned>(d->vecWorker.size());
+        d->pushJob(d->roundRobinSeq.fetch_add(1) % workerCount, std::move(job), priority);
+    }
+}
+
+bool TaskThreadPool::tryRunPendingJob()
+{
+    if (d->vecWorker.empty())
+        return false;
+
+    Worker* worker = Private::currentWorker;
+    Job job;
+    if (d->popJob(worker && worker->pool == d ? worker->index : -1, &job)) {
+        job();
+        return true;
+    }
+
+    return false;
+}
+
+bool TaskThreadPool::isWorkerThread() const
+{
+    return Private::currentWorker && Private::currentWorker->pool == d;
+}
+
+void TaskThreadPool::Private::ensureStarted()
+{
+    std::call_once(this->startedFlag, [=]{
+        this->vecWorker.reserve(this->maxThreadCount);
+        for (int i = 0; i < this->maxThreadCount; ++i) {
+            auto worker = std::make_unique<TaskThreadPool::Worker>();
+            worker->pool = this;
+            worker->index = i;
+            this->vecWorker.push_back(std::move(worker));
+        }
+
+        // Start threads only once all workers are created, as they may steal jobs from each other
+        for (const std::unique_ptr<TaskThreadPool::Worker>& worker : this->vecWorker) {
+            TaskThreadPool::Worker* ptrWorker = worker.get();
+            worker->thread = std::thread([=]{ this->workerLoop(ptrWorker); });
+        }
+    });
+}
+
+void TaskThreadPool::Private::workerLoop(TaskThreadPool::Worker* worker)
+{
+    currentWorker = worker;
+    TaskThreadPool::Job job;
+    for (;;) {
+        if (this->popJob(worker->index, &job)) {
+            job();
+            job = nullptr; // Release captured resources right now
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(this->mutexIdle);
+        this->condIdle.wait(lock, [=]{ return this->pendingJobCount > 0 || this->stopRequested; });
+        if (this->stopRequested && this->pendingJobCount == 0)
+            break;
+    }
+
+    currentWorker = nullptr;
+}
+
+bool TaskThreadPool::Private::popJob(int index, TaskThreadPool::Job* job)
+{
+    if (this->pendingJobCount == 0)
+        return false;
+
+    const int workerCount = static_cast<int>(this->vecWorker.size());
+    for (int iPriority = 0; iPriority < TaskPriority_Count; ++iPriority) {
+        // Own queue first(LIFO)
+        if (index >= 0) {
+            TaskThreadPool::Worker* worker = this->vecWorker.at(index).get();
+            std::lock_guard<std::mutex> lock(worker->mutexQueues);
+            auto& queue = worker->queues.at(iPriority);
+            if (!queue.empty()) {
+                *job = std::move(queue.back());
+                queue.pop_back();
+                --this->pendingJobCount;
+                return true;
+            }
+        }
+
+        // Steal from other workers(FIFO)
+        const int offset = std::max(index, 0);
+        for (int i = 1; i <= workerCount; ++i) {
+            const int victimIndex = (offset + i) % workerCount;
+            if (victimIndex == index)
+                continue;
+
+            TaskThreadPool::Worker* victim = this->vecWorker.at(victimIndex).get();
+            std::lock_guard<std::mutex> lock(victim->mutexQueues);
+            auto& queue = victim->queues.at(iPriority);
+            if (!queue.empty()) {
+                *job = std::move(queue.front());
+                queue.pop_front();
+                --this->pendingJobCount;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void TaskThreadPool::Private::pushJob(int index, TaskThreadPool::Job job, TaskPriority priority)
+{
+    TaskThreadPool::Worker* worker = this->vecWorker.at(index).get();
+    {
+        std::lock_guard<std::mutex> lock(worker->mutexQueues);
+        worker->queues.at(toIndex(priority)).push_back(std::move(job));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutexIdle);
+        ++this->pendingJobCount;
+    }
+
+    this->condIdle.notify_one();
+}
+
+} // namespace Mayo
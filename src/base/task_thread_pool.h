@@ -0,0 +1,64 @@
+/****************************************************************************
+** Copyright (c) 2024, Fougue Ltd. <https://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "task_common.h"
+
+#include <functional>
+
+namespace Mayo {
+
+// Bounded pool of worker threads executing jobs with work-stealing
+//
+// Each worker owns a pair of double-ended queues(one per TaskPriority). Jobs started from a worker
+// thread are pushed to the back of the worker's own queue and popped back in LIFO order(good cache
+// locality for nested jobs), while idle workers steal from the front of the other queues.
+// Interactive jobs are always picked before background ones.
+//
+// Worker threads are created lazily at first call to start()
+class TaskThreadPool {
+public:
+    using Job = std::function<void()>;
+
+    // Creates a pool of 'maxThreadCount' workers. If 'maxThreadCount <= 0' then the count of
+    // hardware threads is used
+    explicit TaskThreadPool(int maxThreadCount = -1);
+
+    // Waits until all pending jobs are executed then joins the worker threads
+    ~TaskThreadPool();
+
+    // Not copyable
+    TaskThreadPool(const TaskThreadPool&) = delete;
+    TaskThreadPool& operator=(const TaskThreadPool&) = delete;
+
+    // Process-wide pool shared by default by all TaskManager objects
+    static TaskThreadPool& globalInstance();
+
+    // Maximum count of worker threads
+    // NOTE setMaxThreadCount() has no effect once worker threads were created(ie after first
+    //      call to start())
+    int maxThreadCount() const;
+    void setMaxThreadCount(int count);
+
+    // Enqueues 'job' for asynchronous execution by some worker thread
+    void start(Job job, TaskPriority priority = TaskPriority::Interactive);
+
+    // Executes in the current thread one of the pending jobs(if any)
+    // Returns true if a job was executed
+    // Useful to avoid starvation when a worker thread has to wait for other jobs to complete
+    bool tryRunPendingJob();
+
+    // Whether the current thread is a worker thread owned by this pool
+    bool isWorkerThread() const;
+
+private:
+    struct Worker;
+    struct Private;
+    Private* const d = nullptr;
+};
+
+} // namespace Mayo
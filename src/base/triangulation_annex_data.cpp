@@ -46,6 +46,28 @@ TriangulationAnnexDataPtr TriangulationAnnexData::Set(
     return data;
 }
 
+MeshUtils::TriangulationMetrics TriangulationAnnexData::triangulationMetrics(
+        const OccHandle<Poly_Triangulation>& triangulation) const
+{
+    if (!triangulation)
+        return {};
+
+    std::lock_guard<std::mutex> lock(m_mutexMetricsCache);
+    MetricsCache& cache = m_metricsCache;
+    // Counts are also compared, as a triangulation can be resized in place
+    if (cache.triangulation != triangulation
+            || cache.nodeCount != triangulation->NbNodes()
+            || cache.triangleCount != triangulation->NbTriangles())
+    {
+        cache.triangulation = triangulation;
+        cache.nodeCount = triangulation->NbNodes();
+        cache.triangleCount = triangulation->NbTriangles();
+        cache.metrics = MeshUtils::triangulationMetrics(triangulation);
+    }
+
+    return cache.metrics;
+}
+
 const Standard_GUID& TriangulationAnnexData::ID() const
 {
     return TriangulationAnnexData::GetID();
@@ -6,11 +6,13 @@
 
 #pragma once
 
+#include "mesh_utils.h"
 #include "occ_handle.h"
 #include "span.h"
 
 #include <Quantity_Color.hxx>
 #include <TDF_Attribute.hxx>
+#include <mutex>
 #include <vector>
 
 namespace Mayo {
@@ -28,6 +30,12 @@ public:
 
     Span<const Quantity_Color> nodeColors() const { return m_vecNodeColor; }
 
+    // Metrics of 'triangulation'(the mesh owning this attribute), computed on first call and then
+    // cached until another triangulation is passed
+    // The cache holds a reference to the triangulation, so its address can't be reused by another
+    // triangulation while cached
+    MeshUtils::TriangulationMetrics triangulationMetrics(const OccHandle<Poly_Triangulation>& triangulation) const;
+
     // -- from TDF_Attribute
     const Standard_GUID& ID() const override;
     void Restore(const OccHandle<TDF_Attribute>& attribute) override;
@@ -41,6 +49,15 @@ private:
     void copyNodeColors(Span<const Quantity_Color> spanNodeColor);
 
     std::vector<Quantity_Color> m_vecNodeColor;
+
+    struct MetricsCache {
+        OccHandle<Poly_Triangulation> triangulation;
+        int nodeCount = 0;
+        int triangleCount = 0;
+        MeshUtils::TriangulationMetrics metrics;
+    };
+    mutable MetricsCache m_metricsCache;
+    mutable std::mutex m_mutexMetricsCache;
 };
 
 } // namespace Mayo
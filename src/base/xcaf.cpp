@@ -337,27 +337,39 @@ TDF_LabelSequence XCaf::diffTopLevelFreeShapes(const TDF_LabelSequence& seqOther
     return seqDiff;
 }
 
-TreeNodeId XCaf::deepBuildAssemblyTree(TreeNodeId parentNode, const TDF_Label& label)
+TreeNodeId XCaf::buildAssemblyTree(TreeNodeId parentNode, const TDF_Label& label)
 {
     Expects(m_modelTree != nullptr);
 
     const TreeNodeId node = m_modelTree->appendChild(parentNode, label);
     if (XCaf::isShapeAssembly(label)) {
         for (const TDF_Label& child : XCaf::shapeComponents(label))
-            this->deepBuildAssemblyTree(node, child);
-    }
-    else if (XCaf::isShapeReference(label)) {
-        const TDF_Label referred = XCaf::shapeReferred(label);
-        this->deepBuildAssemblyTree(node, referred);
+            this->buildAssemblyTree(node, child);
     }
 #if 0
     else if (XCaf::isShapeSimple(label)) {
         for (const TDF_Label& child : XCaf::shapeSubs(label))
-            this->deepBuildAssemblyTree(node, child);
+            this->buildAssemblyTree(node, child);
     }
 #endif
 
     return node;
 }
 
+bool XCaf::isAssemblyTreeNodeCollapsed(TreeNodeId node) const
+{
+    Expects(m_modelTree != nullptr);
+
+    // A referred product always has its own node once expanded, so a leaf reference is collapsed
+    return m_modelTree->nodeIsLeaf(node) && XCaf::isShapeReference(m_modelTree->nodeData(node));
+}
+
+void XCaf::expandAssemblyTreeNode(TreeNodeId node)
+{
+    if (this->isAssemblyTreeNodeCollapsed(node)) {
+        const TDF_Label referred = XCaf::shapeReferred(m_modelTree->nodeData(node));
+        this->buildAssemblyTree(node, referred);
+    }
+}
+
 } // namespace Mayo
@@ -119,7 +119,17 @@ public:
 private:
     XCaf() = default;
 
-    TreeNodeId deepBuildAssemblyTree(TreeNodeId parentNode, const TDF_Label& label);
+    // Appends to the model tree the node of 'label' and the nodes of assembly components, recursively
+    // Shape references(ie instances) are appended as leaf nodes: sub-tree of the referred product is
+    // only appended on demand by expandAssemblyTreeNode()
+    TreeNodeId buildAssemblyTree(TreeNodeId parentNode, const TDF_Label& label);
+
+    // Whether 'node' is a shape reference whose referred product wasn't appended yet
+    bool isAssemblyTreeNodeCollapsed(TreeNodeId node) const;
+
+    // Appends the sub-tree of the product referred by 'node'. Does nothing if 'node' isn't collapsed
+    void expandAssemblyTreeNode(TreeNodeId node);
+
     void setLabelMain(const TDF_Label& labelMain) { m_labelMain = labelMain; }
     void setModelTree(Tree<TDF_Label>& modelTree) { m_modelTree = &modelTree; }
 
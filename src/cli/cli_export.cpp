@@ -16,6 +16,7 @@
 
 #include <Message.hxx>
 
+#include <QtCore/QTimer>
 #include <QtCore/QtDebug>
 
 #include <fmt/format.h>
@@ -124,7 +125,8 @@ bool importInDocument(DocumentPtr doc, const CliExportArgs& args, Helper* helper
         .targetDocument(doc)
         .withFilepaths(args.filesToOpen)
         .withParametersProvider(appModule)
-        .withEntityPostProcess([=](TDF_Label labelEntity, TaskProgress* progress) {
+        .withEntityPostProcess([=](TDF_Label labelEntity, const FilePath& /*filepath*/, TaskProgress* progress) {
+            // On-disk mesh cache isn't used: one-shot conversions would only fill it
             appModule->computeBRepMesh(labelEntity, progress);
         })
         .withEntityPostProcessRequiredIf([=](IO::Format){ return brepMeshRequired; })
@@ -241,6 +243,8 @@ void cli_asyncExportDocuments(
         return fnExit(EXIT_FAILURE); // Error
 
     // Run export operations(asynchronous)
+    // Export tasks run concurrently and traverse the complete model tree, so it's built here once
+    doc->deepExpandModelTree();
     for (const FilePath& filepath : args.filesToExport) {
         const TaskId taskId = taskMgr->newTask([=](TaskProgress* progress) {
             exportDocument(doc, filepath, helper, progress);
@@ -250,6 +254,13 @@ void cli_asyncExportDocuments(
         taskMgr->setTitle(taskId, fmt::format(CliExport::textIdTr("Exporting {}..."), strFilename));
     }
 
+    // Progress notifications are throttled, make sure last values of running tasks are emitted
+    if (args.progressReport) {
+        auto progressFlushTimer = new QTimer(helper);
+        QObject::connect(progressFlushTimer, &QTimer::timeout, helper, [=]{ taskMgr->flushPendingProgress(); });
+        progressFlushTimer->start(1000 / TaskProgress::NotifyMaxRate);
+    }
+
     taskMgr->foreachTask([=](TaskId taskId) {
         if (taskId != importTaskId)
             taskMgr->run(taskId, TaskAutoDestroy::Off);
@@ -9,6 +9,7 @@
 #include "../base/application.h"
 #include "../base/io_system.h"
 #include "../base/settings.h"
+#include "../base/task_thread_pool.h"
 #include "../graphics/graphics_mesh_object_driver.h"
 #include "../graphics/graphics_point_cloud_object_driver.h"
 #include "../graphics/graphics_shape_object_driver.h"
@@ -74,6 +75,7 @@ struct CommandLineArguments {
     bool includeDebugLogs = true;
     bool progressReport = true;
     bool showSystemInformation = false;
+    int maxThreadCount = -1;
 };
 
 // Helper to filter out AppModule settings that are not useful for MayoConv application
@@ -241,6 +243,14 @@ static CommandLineArguments processCommandLine()
     );
     cmdParser.addOption(cmdNoProgress);
 
+    const QCommandLineOption cmdMaxThreads(
+                QStringList{ "max-threads" },
+                Main::tr("Maximum count of threads used to run import/export tasks(default is the "
+                         "count of hardware threads)"),
+                Main::tr("count")
+    );
+    cmdParser.addOption(cmdMaxThreads);
+
     const QCommandLineOption cmdSysInfo(
                 QStringList{ "system-info" },
                 Main::tr("Show detailed system information and quit")
@@ -287,6 +297,8 @@ static CommandLineArguments processCommandLine()
 #endif
     args.progressReport = !cmdParser.isSet(cmdNoProgress);
     args.showSystemInformation = cmdParser.isSet(cmdSysInfo);
+    if (cmdParser.isSet(cmdMaxThreads))
+        args.maxThreadCount = cmdParser.value(cmdMaxThreads).toInt();
 
     return args;
 }
@@ -380,6 +392,9 @@ static int runApp(QCoreApplication* qtApp)
         }
     };
 
+    // Task execution
+    TaskThreadPool::globalInstance().setMaxThreadCount(args.maxThreadCount);
+
     // Signals
     setGlobalSignalThreadHelper(std::make_unique<QtSignalThreadHelper>());
 
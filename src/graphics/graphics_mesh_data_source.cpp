@@ -8,58 +8,28 @@
 
 #include "../base/mesh_utils.h"
 
+#include <OSD_Parallel.hxx>
 #include <Precision.hxx>
 #include <Standard_Type.hxx>
-#include <TColgp_SequenceOfXYZ.hxx>
-#include <TColStd_DataMapOfIntegerInteger.hxx>
-#include <TColStd_DataMapOfIntegerReal.hxx>
 
 namespace Mayo {
 
-GraphicsMeshDataSource::GraphicsMeshDataSource(const OccHandle<Poly_Triangulation>& mesh)
-    : m_mesh(mesh)
-{
-    if (!m_mesh.IsNull()) {
-        const int lenCoords = m_mesh->NbNodes();
-        m_nodeCoords = new TColStd_HArray2OfReal(1, lenCoords, 1, 3);
-
-        for(int i = 1; i <= lenCoords; ++i) {
-            m_nodes.Add(i);
-            const gp_XYZ xyz = m_mesh->Node(i).XYZ();
-            m_nodeCoords->SetValue(i, 1, xyz.X());
-            m_nodeCoords->SetValue(i, 2, xyz.Y());
-            m_nodeCoords->SetValue(i, 3, xyz.Z());
-        }
-
-        const Poly_Array1OfTriangle& aSeq = MeshUtils::triangles(m_mesh);
-        const int lenTriangles = aSeq.Length();
-        m_elemNormals = new TColStd_HArray2OfReal(1, lenTriangles, 1, 3);
-        m_elemNodes = new TColStd_HArray2OfInteger(1, lenTriangles, 1, 3);
-
-        for(int i = 1; i <= lenTriangles; ++i ) {
-            m_elements.Add(i);
-            const Poly_Triangle& aTri = aSeq(i);
-
-            int V[3];
-            aTri.Get(V[0], V[1], V[2]);
+namespace {
 
-            const gp_Vec aV1(m_mesh->Node(V[0]), m_mesh->Node(V[1]));
-            const gp_Vec aV2(m_mesh->Node(V[1]), m_mesh->Node(V[2]));
-
-            gp_Vec aN = aV1.Crossed(aV2);
-            if (aN.SquareMagnitude() > Precision::SquareConfusion())
-                aN.Normalize();
-            else
-                aN.SetCoord(0.0, 0.0, 0.0);
+// Helper to fill 'map' with the integer range [1, count]
+void fillPackedMap(TColStd_PackedMapOfInteger& map, int count)
+{
+    // PackedMap stores 32 integers per block, avoid rehashing while adding
+    map.ReSize(count / 32 + 1);
+    for (int i = 1; i <= count; ++i)
+        map.Add(i);
+}
 
-            for (int j = 0; j < 3; ++j)
-                m_elemNodes->SetValue(i, j+1, V[j]);
+} // namespace
 
-            m_elemNormals->SetValue (i, 1, aN.X());
-            m_elemNormals->SetValue (i, 2, aN.Y());
-            m_elemNormals->SetValue (i, 3, aN.Z());
-        }
-    }
+GraphicsMeshDataSource::GraphicsMeshDataSource(const OccHandle<Poly_Triangulation>& mesh)
+    : m_mesh(mesh)
+{
 }
 
 bool GraphicsMeshDataSource::GetGeom(
@@ -74,13 +44,15 @@ bool GraphicsMeshDataSource::GetGeom(
         return false;
 
     if (IsElement) {
-        if (ID >= 1 && ID <= m_elements.Extent()) {
+        if (ID >= 1 && ID <= this->elementCount()) {
             Type = MeshVS_ET_Face;
             NbNodes = 3;
+            const Poly_Triangle& tri = MeshUtils::triangles(m_mesh).Value(ID);
             for (int i = 1, k = 1; i <= 3; ++i) {
-                const int IdxNode = m_elemNodes->Value(ID, i);
-                for (int j = 1; j <= 3; ++j, ++k)
-                    Coords(k) = m_nodeCoords->Value(IdxNode, j);
+                const gp_Pnt pnt = m_mesh->Node(tri.Value(i));
+                Coords(k++) = pnt.X();
+                Coords(k++) = pnt.Y();
+                Coords(k++) = pnt.Z();
             }
 
             return true;
@@ -89,13 +61,14 @@ bool GraphicsMeshDataSource::GetGeom(
         return false;
     }
     else {
-        if (ID >= 1 && ID <= m_nodes.Extent()) {
+        if (ID >= 1 && ID <= this->nodeCount()) {
             Type = MeshVS_ET_Node;
             NbNodes = 1;
 
-            Coords(1) = m_nodeCoords->Value(ID, 1);
-            Coords(2) = m_nodeCoords->Value(ID, 2);
-            Coords(3) = m_nodeCoords->Value(ID, 3);
+            const gp_Pnt pnt = m_mesh->Node(ID);
+            Coords(1) = pnt.X();
+            Coords(2) = pnt.Y();
+            Coords(3) = pnt.Z();
             return true;
         }
 
@@ -114,30 +87,75 @@ bool GraphicsMeshDataSource::GetNodesByElement(const int ID, TColStd_Array1OfInt
     if (m_mesh.IsNull())
         return false;
 
-    if (ID >= 1 && ID <= m_elements.Extent() && theNodeIDs.Length() >= 3) {
+    if (ID >= 1 && ID <= this->elementCount() && theNodeIDs.Length() >= 3) {
         const int aLow = theNodeIDs.Lower();
-        theNodeIDs(aLow)     = m_elemNodes->Value(ID, 1);
-        theNodeIDs(aLow + 1) = m_elemNodes->Value(ID, 2);
-        theNodeIDs(aLow + 2) = m_elemNodes->Value(ID, 3);
+        const Poly_Triangle& tri = MeshUtils::triangles(m_mesh).Value(ID);
+        theNodeIDs(aLow)     = tri.Value(1);
+        theNodeIDs(aLow + 1) = tri.Value(2);
+        theNodeIDs(aLow + 2) = tri.Value(3);
         return true;
     }
 
     return false;
 }
 
+const TColStd_PackedMapOfInteger& GraphicsMeshDataSource::GetAllNodes() const
+{
+    std::call_once(m_nodesFlag, [=]{ fillPackedMap(m_nodes, this->nodeCount()); });
+    return m_nodes;
+}
+
+const TColStd_PackedMapOfInteger& GraphicsMeshDataSource::GetAllElements() const
+{
+    std::call_once(m_elementsFlag, [=]{ fillPackedMap(m_elements, this->elementCount()); });
+    return m_elements;
+}
+
 bool GraphicsMeshDataSource::GetNormal(const int Id, const int Max, double& nx, double& ny, double& nz) const
 {
     if (m_mesh.IsNull())
         return false;
 
-    if (Id >= 1 && Id <= m_elements.Extent() && Max >= 3) {
-        nx = m_elemNormals->Value(Id, 1);
-        ny = m_elemNormals->Value(Id, 2);
-        nz = m_elemNormals->Value(Id, 3);
+    if (Id >= 1 && Id <= this->elementCount() && Max >= 3) {
+        // Compute all face normals at first request
+        std::call_once(m_elemNormalsFlag, [=]{
+            const Poly_Array1OfTriangle& triangles = MeshUtils::triangles(m_mesh);
+            m_vecElemNormal.resize(this->elementCount());
+            OSD_Parallel::For(0, this->elementCount(), [&](int i) {
+                int v[3];
+                triangles.Value(i + 1).Get(v[0], v[1], v[2]);
+                const gp_Pnt pnt0 = m_mesh->Node(v[0]);
+                const gp_Pnt pnt1 = m_mesh->Node(v[1]);
+                const gp_Vec vec1(pnt0, pnt1);
+                const gp_Vec vec2(pnt1, m_mesh->Node(v[2]));
+                gp_Vec n = vec1.Crossed(vec2);
+                if (n.SquareMagnitude() > Precision::SquareConfusion())
+                    n.Normalize();
+                else
+                    n.SetCoord(0., 0., 0.);
+
+                m_vecElemNormal[i] = { float(n.X()), float(n.Y()), float(n.Z()) };
+            });
+        });
+
+        const ElementNormal& n = m_vecElemNormal.at(Id - 1);
+        nx = n.x;
+        ny = n.y;
+        nz = n.z;
         return true;
     }
 
     return false;
 }
 
+int GraphicsMeshDataSource::nodeCount() const
+{
+    return !m_mesh.IsNull() ? m_mesh->NbNodes() : 0;
+}
+
+int GraphicsMeshDataSource::elementCount() const
+{
+    return !m_mesh.IsNull() ? m_mesh->NbTriangles() : 0;
+}
+
 } // namespace Mayo
@@ -16,11 +16,16 @@
 #include <MeshVS_EntityType.hxx>
 #include <Poly_Triangulation.hxx>
 #include <TColStd_PackedMapOfInteger.hxx>
-#include <TColStd_HArray2OfInteger.hxx>
-#include <TColStd_HArray2OfReal.hxx>
+
+#include <mutex>
+#include <vector>
 
 namespace Mayo {
 
+// Provides MeshVS data source directly on top of a Poly_Triangulation object
+// Geometry and connectivity aren't duplicated: they are read from the triangulation on request.
+// Node/element maps and face normals are lazily built at first access, so creating the data
+// source of a big mesh costs nothing
 class GraphicsMeshDataSource : public MeshVS_DataSource {
 public:
     GraphicsMeshDataSource(const OccHandle<Poly_Triangulation>& mesh);
@@ -29,17 +34,23 @@ public:
     bool GetGeomType(const int ID, const bool IsElement, MeshVS_EntityType& Type) const override;
     Standard_Address GetAddr(const int /*ID*/, const bool /*IsElement*/) const override { return nullptr; }
     bool GetNodesByElement(const int ID, TColStd_Array1OfInteger& NodeIDs, int& NbNodes) const override;
-    const TColStd_PackedMapOfInteger& GetAllNodes() const override { return m_nodes; }
-    const TColStd_PackedMapOfInteger& GetAllElements() const override { return m_elements; }
+    const TColStd_PackedMapOfInteger& GetAllNodes() const override;
+    const TColStd_PackedMapOfInteger& GetAllElements() const override;
     bool GetNormal(const int Id, const int Max, double& nx, double& ny, double& nz) const override;
 
 private:
-  OccHandle<Poly_Triangulation> m_mesh;
-  TColStd_PackedMapOfInteger m_nodes;
-  TColStd_PackedMapOfInteger m_elements;
-  OccHandle<TColStd_HArray2OfInteger> m_elemNodes;
-  OccHandle<TColStd_HArray2OfReal> m_nodeCoords;
-  OccHandle<TColStd_HArray2OfReal> m_elemNormals;
+    struct ElementNormal { float x; float y; float z; };
+
+    int nodeCount() const;
+    int elementCount() const;
+
+    OccHandle<Poly_Triangulation> m_mesh;
+    mutable TColStd_PackedMapOfInteger m_nodes;
+    mutable TColStd_PackedMapOfInteger m_elements;
+    mutable std::vector<ElementNormal> m_vecElemNormal;
+    mutable std::once_flag m_nodesFlag;
+    mutable std::once_flag m_elementsFlag;
+    mutable std::once_flag m_elemNormalsFlag;
 };
 
 } // namespace Mayo
@@ -38,6 +38,34 @@ struct GuiApplication::Private {
             guiDoc->graphicsScene()->redraw();
     }
 
+    void onDocumentEntityAboutToBeDestroyed(const Document* doc, TreeNodeId entityTreeNodeId)
+    {
+        // Identifiers of the entity tree nodes will be reused, so selected ones must not survive
+        std::vector<ApplicationItem> vecDeselected;
+        for (const ApplicationItem& item : m_selectionModel.selectedItems()) {
+            if (item.document().get() == doc
+                && item.isDocumentTreeNode()
+                && doc->modelTree().nodeRoot(item.documentTreeNode().id()) == entityTreeNodeId)
+            {
+                vecDeselected.push_back(item);
+            }
+        }
+
+        m_selectionModel.remove(vecDeselected);
+    }
+
+    void onDocumentModelTreeCompacted(const Document* doc, const std::vector<TreeNodeId>& vecOldToNewId)
+    {
+        m_selectionModel.remap([&](const ApplicationItem& item) {
+            if (item.document().get() != doc || !item.isDocumentTreeNode())
+                return item;
+
+            const DocumentTreeNode& node = item.documentTreeNode();
+            const TreeNodeId newId = node.id() < vecOldToNewId.size() ? vecOldToNewId[node.id()] : 0;
+            return newId != 0 ? ApplicationItem(DocumentTreeNode(node.document(), newId)) : ApplicationItem();
+        });
+    }
+
     GuiApplication* m_backPtr = nullptr;
     ApplicationPtr m_app;
     std::vector<GuiDocument*> m_vecGuiDocument;
@@ -141,6 +169,16 @@ void GuiApplication::setAutomaticDocumentMapping(bool on)
 
 void GuiApplication::onDocumentAdded(const DocumentPtr& doc)
 {
+    // Connected before GuiDocument, so items are deselected while their graphics still exist
+    // Note: document is captured by raw pointer to avoid a reference cycle
+    const Document* docPtr = doc.get();
+    doc->signalEntityAboutToBeDestroyed.connectSlot([=](TreeNodeId entityTreeNodeId) {
+        d->onDocumentEntityAboutToBeDestroyed(docPtr, entityTreeNodeId);
+    });
+    doc->signalModelTreeCompacted.connectSlot([=](const std::vector<TreeNodeId>& vecOldToNewId) {
+        d->onDocumentModelTreeCompacted(docPtr, vecOldToNewId);
+    });
+
     if (d->m_automaticDocumentMapping) {
         d->m_vecGuiDocument.push_back(new GuiDocument(doc, this));
         this->signalGuiDocumentAdded.send(d->m_vecGuiDocument.back());
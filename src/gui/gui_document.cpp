@@ -13,6 +13,7 @@
 #include "../base/cpp_utils.h"
 #include "../base/document.h"
 #include "../base/math_utils.h"
+#include "../base/task_thread_pool.h"
 #include "../base/tkernel_utils.h"
 #include "../graphics/graphics_utils.h"
 #include "../gui/gui_application.h"
@@ -22,11 +23,17 @@
 #endif
 #include <AIS_ConnectedInteractive.hxx>
 #include <AIS_Trihedron.hxx>
+#include <BRepBndLib.hxx>
 #include <Geom_Axis2Placement.hxx>
 #include <Graphic3d_GraphicDriver.hxx>
+#include <OSD_Parallel.hxx>
+#include <StdPrs_ToolTriangulatedShape.hxx>
 #include <V3d_TypeOfOrientation.hxx>
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <unordered_set>
 
 namespace Mayo {
 
@@ -65,8 +72,36 @@ static GuiDocument::GradientBackground& defaultGradientBackground()
     return defaultGradientBackground;
 }
 
+// Entities having less graphics instances are mapped in one go
+constexpr size_t ProgressiveMapping_MinInstanceCount = 1000;
+
+// Count of graphics instances added to the scene between two redraws
+constexpr size_t ProgressiveMapping_BatchSize = 250;
+
+// Bounding box of a product shape, used by both synchronous and progressive mappings
+// The shape is tessellated beforehand just like AIS does when computing its presentation, so the
+// box is tight and the presentation can reuse the triangulation
+static Bnd_Box productBoundingBox(const TopoDS_Shape& shape, const OccHandle<Prs3d_Drawer>& drawer)
+{
+    Bnd_Box bndBox;
+    if (!shape.IsNull()) {
+        StdPrs_ToolTriangulatedShape::Tessellate(shape, drawer);
+        BRepBndLib::Add(shape, bndBox);
+    }
+
+    return bndBox;
+}
+
 } // namespace Internal
 
+struct GuiDocument::EntityMapping {
+    TreeNodeId entityTreeNodeId = 0;
+    std::vector<InstanceItem> vecInstance;
+    std::vector<TopoDS_Shape> vecProductShape; // Indexed with InstanceItem::productIndex
+    std::unordered_map<TDF_Label, GraphicsObjectPtr> mapLabelGfxProduct;
+    std::atomic<bool> cancelled = false;
+};
+
 std::vector<GraphicsObjectPtr>& GuiDocument::getSelGfxObjects()
 {
     return m_selGfxObjects;
@@ -117,12 +152,17 @@ GuiDocument::GuiDocument(const DocumentPtr& doc, GuiApplication* guiApp)
 
     m_cameraAnimation->setView(m_v3dView);
 
+    if (getGlobalSignalThreadHelper())
+        m_guiThreadContext = getGlobalSignalThreadHelper()->getCurrentThreadContext();
+
     for (int i = 0; i < doc->entityCount(); ++i)
         this->mapEntity(doc->entityTreeNodeId(i));
 
 
     doc->signalEntityAdded.connectSlot(&GuiDocument::onDocumentEntityAdded, this);
     doc->signalEntityAboutToBeDestroyed.connectSlot(&GuiDocument::onDocumentEntityAboutToBeDestroyed, this);
+    doc->signalModelTreeCompacted.connectSlot(&GuiDocument::onDocumentModelTreeCompacted, this);
+    doc->signalModelTreeNodeExpanded.connectSlot(&GuiDocument::onDocumentModelTreeNodeExpanded, this);
     m_gfxScene.signalSelectionChanged.connectSlot(&GuiDocument::onGraphicsSelectionChanged, this);
 }
 
@@ -214,6 +254,10 @@ void GuiDocument::setDevicePixelRatio(double ratio)
 
 GuiDocument::~GuiDocument()
 {
+    // Batches of progressive mapping might still be pending in the event loop
+    for (const std::shared_ptr<EntityMapping>& mapping : m_vecEntityMapping)
+        mapping->cancelled = true;
+
     delete m_cameraAnimation;
 }
 
@@ -223,16 +267,9 @@ void GuiDocument::foreachGraphicsObject(
     if (!fn)
         return;
 
-    const Tree<TDF_Label>& docModelTree = m_document->modelTree();
-    const GraphicsEntity* ptrItem = this->findGraphicsEntity(docModelTree.nodeRoot(nodeId));
-    if (!ptrItem)
-        return;
-
-    traverseTree(nodeId, docModelTree, [&](TreeNodeId id) {
-        GraphicsObjectPtr gfxObject = CppUtils::findValue(id, ptrItem->mapTreeNodeGfxObject);
-        if (gfxObject)
-            fn(gfxObject);
-        });
+    traverseTree(nodeId, m_document->modelTree(), [&](TreeNodeId id) {
+        this->foreachTreeNodeGraphicsObject(id, fn);
+    });
 }
 
 void GuiDocument::foreachGraphicsObject(
@@ -241,15 +278,10 @@ void GuiDocument::foreachGraphicsObject(
     if (!fn)
         return;
 
-    const Tree<TDF_Label>& docModelTree = m_document->modelTree();
-    const GraphicsEntity* ptrItem = this->findGraphicsEntity(docModelTree.nodeRoot(nodeId));
-    if (!ptrItem)
-        return;
-
-    traverseTree(nodeId, docModelTree, [&](TreeNodeId id) {
-        GraphicsObjectPtr gfxObject = CppUtils::findValue(id, ptrItem->mapTreeNodeGfxObject);
-        if (gfxObject)
+    traverseTree(nodeId, m_document->modelTree(), [&](TreeNodeId id) {
+        this->foreachTreeNodeGraphicsObject(id, [&](const GraphicsObjectPtr& gfxObject) {
             fn(gfxObject, id);
+        });
     });
 }
 
@@ -258,13 +290,8 @@ TreeNodeId GuiDocument::nodeFromGraphicsObject(const GraphicsObjectPtr& gfxObjec
     if (!gfxObject)
         return 0;
 
-    for (const GraphicsEntity& gfxEntity: m_vecGraphicsEntity) {
-        auto it = gfxEntity.mapGfxObjectTreeNode.find(gfxObject);
-        if (it != gfxEntity.mapGfxObjectTreeNode.cend())
-            return it->second;
-    }
-
-    return 0;
+    auto it = m_mapGfxObjectTreeNode.find(gfxObject.get());
+    return it != m_mapGfxObjectTreeNode.cend() ? it->second : 0;
 }
 
 void GuiDocument::toggleItemSelected(const ApplicationItem& appItem)
@@ -275,15 +302,8 @@ void GuiDocument::toggleItemSelected(const ApplicationItem& appItem)
 
     if (appItem.isDocumentTreeNode()) {
         const DocumentTreeNode& docTreeNode = appItem.documentTreeNode();
-        const TreeNodeId entityNodeId = doc->modelTree().nodeRoot(docTreeNode.id());
-        const GraphicsEntity* gfxEntity = this->findGraphicsEntity(entityNodeId);
-        if (!gfxEntity)
-            return;
-
-        traverseTree(docTreeNode.id(), doc->modelTree(), [=](TreeNodeId id) {
-            GraphicsObjectPtr gfxObject = CppUtils::findValue(id, gfxEntity->mapTreeNodeGfxObject);
-            if (gfxObject)
-                m_gfxScene.toggleOwnerSelection(gfxObject->GlobalSelOwner());
+        this->foreachGraphicsObject(docTreeNode.id(), [=](GraphicsObjectPtr gfxObject) {
+            m_gfxScene.toggleOwnerSelection(gfxObject->GlobalSelOwner());
         });
     }
 }
@@ -319,111 +339,196 @@ void GuiDocument::setActiveDisplayMode(const GraphicsObjectDriverPtr& driver, in
 
 CheckState GuiDocument::nodeVisibleState(TreeNodeId nodeId) const
 {
-    auto itFound = m_mapTreeNodeCheckState.find(nodeId);
-    return itFound != m_mapTreeNodeCheckState.cend() ? itFound->second : CheckState::Off;
+    return nodeId < m_vecTreeNodeGraphics.size() ? m_vecTreeNodeGraphics[nodeId].visibleState : CheckState::Off;
 }
 
 void GuiDocument::setNodeVisible(TreeNodeId nodeId, bool on)
 {
-    auto itNode = m_mapTreeNodeCheckState.find(nodeId);
-    if (itNode == m_mapTreeNodeCheckState.end())
-        return; // Error: unknown tree node
+    this->applyNodesVisible(Span<const TreeNodeId>(&nodeId, 1), on);
+}
 
+void GuiDocument::setNodesVisible(Span<const TreeNodeId> spanNodeId, bool on)
+{
+    if (this->applyNodesVisible(spanNodeId, on))
+        m_gfxScene.redraw();
+}
+
+bool GuiDocument::applyNodesVisible(Span<const TreeNodeId> spanNodeId, bool on)
+{
+    const Tree<TDF_Label>& docModelTree = m_document->modelTree();
     const CheckState nodeVisibleState = on ? CheckState::On : CheckState::Off;
-    if (itNode->second == nodeVisibleState)
-        return; // Same visible state
 
     // Helper data/function to keep track of all the nodes whose visibility state are altered
-    std::unordered_map<TreeNodeId, CheckState> mapNodeIdVisibleState;
+    // Counters of the parent node are updated accordingly
+    MapVisibilityByTreeNodeId mapNodeIdVisibleState;
     auto fnSetNodeVisibleState = [&](TreeNodeId id, CheckState state) {
-        auto it = m_mapTreeNodeCheckState.find(id);
-        if (it == m_mapTreeNodeCheckState.cend()) {
-            m_mapTreeNodeCheckState[id] = state;
-            mapNodeIdVisibleState[id] = state;
-        }
-        else if (it->second != state) {
-            it->second = state;
-            mapNodeIdVisibleState[id] = state;
+        TreeNodeGraphics& nodeGfx = this->changeTreeNodeGraphics(id);
+        if (nodeGfx.visibleState == state)
+            return false;
+
+        const TreeNodeId parentId = docModelTree.nodeParent(id);
+        if (parentId != 0) {
+            TreeNodeGraphics& parentGfx = this->changeTreeNodeGraphics(parentId);
+            parentGfx.childOnCount += (state == CheckState::On ? 1 : 0) - (nodeGfx.visibleState == CheckState::On ? 1 : 0);
+            parentGfx.childOffCount += (state == CheckState::Off ? 1 : 0) - (nodeGfx.visibleState == CheckState::Off ? 1 : 0);
         }
+
+        nodeGfx.visibleState = state;
+        mapNodeIdVisibleState[id] = state;
+        return true;
     };
 
-    // Recursive show/hide of the input node graphics
-    const Tree<TDF_Label>& docModelTree = m_document->modelTree();
-    traverseTree(nodeId, docModelTree , [=](TreeNodeId id) {
-        fnSetNodeVisibleState(id, nodeVisibleState);
-    });
-    this->foreachGraphicsObject(nodeId, [=](GraphicsObjectPtr gfxObject) {
-        GraphicsUtils::AisObject_setVisible(gfxObject, on);
-    });
+    const ApplicationItemSelectionModel* appSelectionModel = m_guiApp->selectionModel();
+    const bool hasSelectedItems = on && !appSelectionModel->selectedItems().empty();
+    auto fnIsNodeSelected = [&](TreeNodeId id) {
+        return appSelectionModel->isSelected(ApplicationItem({ m_document, id }));
+    };
 
-    // Keep selection state of the input node: in case the node graphics are "shown" back again then
-    // AIS object selection status is lost
-    const ApplicationItem appItem({ m_document, nodeId });
-    bool isAppItemSelected = m_guiApp->selectionModel()->isSelected(appItem);
-    if (!isAppItemSelected) { // Check if a parent is selected
-        TreeNodeId parentId = docModelTree.nodeParent(nodeId);
-        while (parentId != 0 && !isAppItemSelected) {
-            const ApplicationItem parentAppItem({ m_document, parentId });
-            isAppItemSelected = m_guiApp->selectionModel()->isSelected(parentAppItem);
-            parentId = docModelTree.nodeParent(parentId);
+    for (const TreeNodeId nodeId : spanNodeId) {
+        if (nodeId >= m_vecTreeNodeGraphics.size() || !m_vecTreeNodeGraphics[nodeId].isMapped)
+            continue; // Error: unknown tree node
+
+        if (this->nodeVisibleState(nodeId) == nodeVisibleState)
+            continue; // Same visible state
+
+        // Keep selection state of the input node: in case the node graphics are "shown" back again
+        // then AIS object selection status is lost
+        bool isNodeSelected = false;
+        for (TreeNodeId id = nodeId;
+             hasSelectedItems && id != 0 && !isNodeSelected;
+             id = docModelTree.nodeParent(id))
+        {
+            isNodeSelected = fnIsNodeSelected(id);
         }
-    }
 
-    if (on && isAppItemSelected)
-        this->toggleItemSelected(appItem);
+        // Recursive show/hide of the input node graphics
+        traverseTree(nodeId, docModelTree, [&](TreeNodeId id) {
+            fnSetNodeVisibleState(id, nodeVisibleState);
+            this->foreachTreeNodeGraphicsObject(id, [=](const GraphicsObjectPtr& gfxObject) {
+                GraphicsUtils::AisObject_setVisible(gfxObject, on);
+            });
+        });
 
-    // Keep selection state of input node children
-    traverseTree(nodeId, docModelTree, [=](TreeNodeId id) {
-        if (id != nodeId) {
-            const ApplicationItem childAppItem({ m_document, id });
-            if (on && m_guiApp->selectionModel()->isSelected(childAppItem))
-                this->toggleItemSelected(childAppItem);
+        if (on && isNodeSelected)
+            this->toggleItemSelected(ApplicationItem({ m_document, nodeId }));
+
+        // Keep selection state of input node children
+        if (hasSelectedItems) {
+            traverseTree(nodeId, docModelTree, [&](TreeNodeId id) {
+                if (id != nodeId && fnIsNodeSelected(id))
+                    this->toggleItemSelected(ApplicationItem({ m_document, id }));
+            });
         }
-    });
 
-    // Parent nodes check state
-    TreeNodeId parentId = docModelTree.nodeParent(nodeId);
-    while (parentId != 0) {
-        int childCount = 0;
-        int checkedCount = 0;
-        int uncheckedCount = 0;
-        visitDirectChildren(parentId, docModelTree, [&](TreeNodeId id) {
-            ++childCount;
-            const CheckState childState = this->nodeVisibleState(id);
-            if (childState == CheckState::On)
-                ++checkedCount;
-            else if (childState == CheckState::Off)
-                ++uncheckedCount;
-        });
-        CheckState parentVisibleState = CheckState::Partially;
-        if (checkedCount == childCount)
-            parentVisibleState = CheckState::On;
-        else if (uncheckedCount == childCount)
-            parentVisibleState = CheckState::Off;
-
-        fnSetNodeVisibleState(parentId, parentVisibleState);
-        parentId = docModelTree.nodeParent(parentId);
+        // Parent nodes check state, stop as soon as some parent state is unchanged
+        for (TreeNodeId parentId = docModelTree.nodeParent(nodeId);
+             parentId != 0;
+             parentId = docModelTree.nodeParent(parentId))
+        {
+            const TreeNodeGraphics& parentGfx = m_vecTreeNodeGraphics.at(parentId);
+            CheckState parentVisibleState = CheckState::Partially;
+            if (parentGfx.childOnCount == parentGfx.childCount)
+                parentVisibleState = CheckState::On;
+            else if (parentGfx.childOffCount == parentGfx.childCount)
+                parentVisibleState = CheckState::Off;
+
+            if (!fnSetNodeVisibleState(parentId, parentVisibleState))
+                break;
+        }
     }
 
     // Notify all node visibility changes
     if (!mapNodeIdVisibleState.empty())
         this->signalNodesVisibilityChanged.send(mapNodeIdVisibleState);
+
+    return !mapNodeIdVisibleState.empty();
+}
+
+void GuiDocument::setExplodingMode(ExplodingMode mode)
+{
+    if (mode == m_explodingMode)
+        return;
+
+    m_explodingMode = mode;
+    for (GraphicsEntity& entity : m_vecGraphicsEntity)
+        entity.isExplodeVectorValid = false;
+
+    this->setExplodingFactor(m_explodingFactor);
 }
 
 void GuiDocument::setExplodingFactor(double t)
 {
-    m_explodingFactor = t;
-    for (const GraphicsEntity& entity : m_vecGraphicsEntity) {
-        const gp_Pnt entityCenter = BndBoxCoords::get(entity.bndBox).center();
+    bool isSceneChanged = false;
+    for (GraphicsEntity& entity : m_vecGraphicsEntity) {
+        // Skip entities which objects are already in place
+        if (entity.isExplodeVectorValid && t == m_explodingFactor)
+            continue;
+
+        if (!entity.isExplodeVectorValid) {
+            // Hierarchical exploding needs the tree nodes of all the assembly levels
+            if (m_explodingMode == ExplodingMode::Hierarchical)
+                m_document->deepExpandModelTreeNode(entity.treeNodeId);
+
+            this->computeExplodeVectors(&entity);
+        }
+
         for (const GraphicsEntity::Object& object : entity.vecObject) {
-            const gp_Vec vecDirection(entityCenter, BndBoxCoords::get(object.bndBox).center());
             gp_Trsf trsfMove;
-            trsfMove.SetTranslation(2 * t * vecDirection);
+            trsfMove.SetTranslation(t * object.explodeVector);
             m_gfxScene.setObjectTransformation(object.ptr, trsfMove * object.trsfOriginal);
         }
+
+        isSceneChanged = true;
     }
 
-    m_gfxScene.redraw();
+    m_explodingFactor = t;
+    if (isSceneChanged)
+        m_gfxScene.redraw();
+}
+
+void GuiDocument::computeExplodeVectors(GraphicsEntity* gfxEntity) const
+{
+    auto fnCenter = [](const Bnd_Box& bndBox) { return BndBoxCoords::get(bndBox).center(); };
+    const gp_Pnt entityCenter = fnCenter(gfxEntity->bndBox);
+    if (m_explodingMode == ExplodingMode::Flat) {
+        for (GraphicsEntity::Object& object : gfxEntity->vecObject)
+            object.explodeVector = 2 * gp_Vec(entityCenter, fnCenter(object.bndBox));
+    }
+    else if (m_explodingMode == ExplodingMode::Hierarchical) {
+        // Bounding box of each tree node, from the objects below it
+        const Tree<TDF_Label>& modelTree = m_document->modelTree();
+        std::unordered_map<TreeNodeId, Bnd_Box> mapNodeBndBox;
+        std::vector<TreeNodeId> vecObjectNodeId;
+        vecObjectNodeId.reserve(gfxEntity->vecObject.size());
+        for (const GraphicsEntity::Object& object : gfxEntity->vecObject) {
+            auto itNode = m_mapGfxObjectTreeNode.find(object.ptr.get());
+            const TreeNodeId objectNodeId = itNode != m_mapGfxObjectTreeNode.cend() ? itNode->second : 0;
+            vecObjectNodeId.push_back(objectNodeId);
+            for (TreeNodeId id = objectNodeId; id != 0; id = modelTree.nodeParent(id)) {
+                BndUtils::add(&mapNodeBndBox[id], object.bndBox);
+                if (id == gfxEntity->treeNodeId)
+                    break;
+            }
+        }
+
+        // Each node moves away from the center of its parent, offsets add up along the ancestors
+        for (size_t i = 0; i < gfxEntity->vecObject.size(); ++i) {
+            gp_Vec vecExplode;
+            for (TreeNodeId id = vecObjectNodeId.at(i); id != 0 && id != gfxEntity->treeNodeId;) {
+                const TreeNodeId parentId = modelTree.nodeParent(id);
+                auto itParentBndBox = mapNodeBndBox.find(parentId);
+                if (itParentBndBox == mapNodeBndBox.cend())
+                    break;
+
+                vecExplode += gp_Vec(fnCenter(itParentBndBox->second), fnCenter(mapNodeBndBox[id]));
+                id = parentId;
+            }
+
+            gfxEntity->vecObject.at(i).explodeVector = 2 * vecExplode;
+        }
+    }
+
+    gfxEntity->isExplodeVectorValid = true;
 }
 
 bool GuiDocument::isOriginTrihedronVisible() const
@@ -614,6 +719,72 @@ void GuiDocument::onDocumentEntityAboutToBeDestroyed(TreeNodeId entityTreeNodeId
     this->signalGraphicsBoundingBoxChanged.send(m_gfxBoundingBox);
 }
 
+void GuiDocument::onDocumentModelTreeCompacted(const std::vector<TreeNodeId>& vecOldToNewId)
+{
+    auto fnNewId = [&](TreeNodeId id) -> TreeNodeId {
+        return id < vecOldToNewId.size() ? vecOldToNewId[id] : 0;
+    };
+
+    std::vector<TreeNodeGraphics> vecTreeNodeGraphics;
+    for (size_t oldId = 0; oldId < m_vecTreeNodeGraphics.size(); ++oldId) {
+        const TreeNodeId newId = fnNewId(static_cast<TreeNodeId>(oldId));
+        if (newId != 0) {
+            if (newId >= vecTreeNodeGraphics.size())
+                vecTreeNodeGraphics.resize(newId + 1);
+
+            vecTreeNodeGraphics[newId] = std::move(m_vecTreeNodeGraphics[oldId]);
+        }
+    }
+
+    m_vecTreeNodeGraphics = std::move(vecTreeNodeGraphics);
+    for (auto& [gfxObject, nodeId] : m_mapGfxObjectTreeNode)
+        nodeId = fnNewId(nodeId);
+
+    for (GraphicsEntity& gfxEntity : m_vecGraphicsEntity)
+        gfxEntity.treeNodeId = fnNewId(gfxEntity.treeNodeId);
+
+    // Worker threads don't access InstanceItem::treeNodeId, so it can be safely changed here
+    for (const std::shared_ptr<EntityMapping>& mapping : m_vecEntityMapping) {
+        mapping->entityTreeNodeId = fnNewId(mapping->entityTreeNodeId);
+        for (InstanceItem& instance : mapping->vecInstance)
+            instance.treeNodeId = fnNewId(instance.treeNodeId);
+    }
+}
+
+void GuiDocument::onDocumentModelTreeNodeExpanded(TreeNodeId nodeId)
+{
+    if (nodeId >= m_vecTreeNodeGraphics.size() || !m_vecTreeNodeGraphics[nodeId].isMapped)
+        return;
+
+    // New nodes inherit the visible state of the expanded node
+    const Tree<TDF_Label>& docModelTree = m_document->modelTree();
+    const CheckState visibleState = m_vecTreeNodeGraphics[nodeId].visibleState;
+    traverseTree(nodeId, docModelTree, [&](TreeNodeId id) {
+        if (id == nodeId)
+            return;
+
+        TreeNodeGraphics& nodeGfx = this->changeTreeNodeGraphics(id);
+        nodeGfx.isMapped = true;
+        nodeGfx.visibleState = visibleState;
+        TreeNodeGraphics& parentGfx = this->changeTreeNodeGraphics(docModelTree.nodeParent(id));
+        ++parentGfx.childCount;
+        parentGfx.childOnCount += visibleState == CheckState::On ? 1 : 0;
+        parentGfx.childOffCount += visibleState == CheckState::Off ? 1 : 0;
+    });
+
+    // Move down the graphics objects attached to the expanded node
+    const std::vector<NestedGraphicsObject> vecNestedObject =
+            std::move(m_vecTreeNodeGraphics.at(nodeId).vecNestedObject);
+    m_vecTreeNodeGraphics.at(nodeId).vecNestedObject.clear();
+    for (const NestedGraphicsObject& nestedObject : vecNestedObject)
+        this->attachGraphicsObject(nodeId, nestedObject.gfxObject, nestedObject.vecReferencePath);
+
+    // Hierarchy of the objects changed
+    GraphicsEntity* gfxEntity = this->findGraphicsEntity(docModelTree.nodeRoot(nodeId));
+    if (gfxEntity && m_explodingMode == ExplodingMode::Hierarchical)
+        gfxEntity->isExplodeVectorValid = false;
+}
+
 void GuiDocument::onGraphicsSelectionChanged()
 {
     m_guiApp->connectApplicationItemSelectionChanged(false);
@@ -637,126 +808,413 @@ void GuiDocument::onGraphicsSelectionChanged()
         }
     });
 
+    const std::unordered_set<ApplicationItem> setSelected(vecSelected.cbegin(), vecSelected.cend());
     std::vector<ApplicationItem> vecRemoved;
     for (const ApplicationItem& appItem : appSelectionModel->selectedItems()) {
         if (appItem.document() != m_document)
             continue;
 
-        auto it = std::find(vecSelected.cbegin(), vecSelected.cend(), appItem);
-        if (it == vecSelected.cend())
+        if (setSelected.find(appItem) == setSelected.cend())
             vecRemoved.push_back(appItem);
     }
 
-    if (!vecSelected.empty())
-        appSelectionModel->add(vecSelected);
-
-    if (!vecRemoved.empty())
-        appSelectionModel->remove(vecRemoved);
+    appSelectionModel->change(vecSelected, vecRemoved);
 }
 
 void GuiDocument::mapEntity(TreeNodeId entityTreeNodeId)
 {
     const Tree<TDF_Label>& docModelTree = m_document->modelTree();
+    traverseTree(entityTreeNodeId, docModelTree, [&](TreeNodeId id) {
+        TreeNodeGraphics& nodeGfx = this->changeTreeNodeGraphics(id);
+        nodeGfx.isMapped = true;
+        nodeGfx.visibleState = CheckState::On;
+        const TreeNodeId parentId = docModelTree.nodeParent(id);
+        if (parentId != 0) {
+            TreeNodeGraphics& parentGfx = this->changeTreeNodeGraphics(parentId);
+            ++parentGfx.childCount;
+            ++parentGfx.childOnCount;
+        }
+    });
+
+    std::vector<InstanceItem> vecInstance = this->collectEntityInstances(entityTreeNodeId);
+    if (m_guiThreadContext.has_value()
+            && vecInstance.size() >= Internal::ProgressiveMapping_MinInstanceCount)
+    {
+        this->mapEntityProgressive(entityTreeNodeId, std::move(vecInstance));
+        return;
+    }
+
+    std::unordered_map<TDF_Label, Bnd_Box> mapLabelProductBndBox;
+    for (InstanceItem& instance : vecInstance) {
+        auto [it, isNewProduct] = mapLabelProductBndBox.insert({ instance.productLabel, Bnd_Box() });
+        if (isNewProduct && XCaf::isShape(instance.productLabel)) {
+            const TopoDS_Shape shape = XCaf::shape(instance.productLabel);
+            it->second = Internal::productBoundingBox(shape, m_gfxScene.drawerDefault());
+        }
+
+        if (!it->second.IsVoid())
+            instance.bndBox = it->second.Transformed(instance.shapeLocation.Transformation());
+    }
+
     GraphicsEntity gfxEntity;
     gfxEntity.treeNodeId = entityTreeNodeId;
     std::unordered_map<TDF_Label, GraphicsObjectPtr> mapLabelGfxProduct;
+    this->addGraphicsObjects(&gfxEntity, vecInstance, &mapLabelGfxProduct);
+    m_gfxScene.redraw();
+    this->addGraphicsEntity(std::move(gfxEntity));
+}
+
+std::vector<GuiDocument::InstanceItem> GuiDocument::collectEntityInstances(TreeNodeId entityTreeNodeId) const
+{
+    const Tree<TDF_Label>& docModelTree = m_document->modelTree();
+    std::vector<InstanceItem> vecInstance;
+    // Depth of the non-leaf nodes
+    std::unordered_map<TreeNodeId, int> mapNodeDepth;
+    auto fnNodeDepth = [&](TreeNodeId id) {
+        auto it = mapNodeDepth.find(id);
+        return it != mapNodeDepth.cend() ? it->second : -1;
+    };
+
+    // Instances below a collapsed reference node are found by walking the XCAF references, so
+    // that the model tree isn't expanded
+    std::vector<TDF_Label> vecReferencePath;
+    std::function<void(TreeNodeId, const TDF_Label&, const TopLoc_Location&, const TopLoc_Location&, int)> fnAddCollapsedInstances;
+    fnAddCollapsedInstances = [&](
+            TreeNodeId refNodeId,
+            const TDF_Label& refLabel,
+            const TopLoc_Location& locRef,
+            const TopLoc_Location& locRefParent,
+            int depthRef)
+    {
+        const TDF_Label productLabel = XCaf::shapeReferred(refLabel);
+        const TopLoc_Location locProduct = locRef * XCaf::shapeReferenceLocation(productLabel);
+        if (XCaf::isShapeAssembly(productLabel)) {
+            for (const TDF_Label& componentLabel : XCaf::shapeComponents(productLabel)) {
+                const TopLoc_Location locComponent = locProduct * XCaf::shapeReferenceLocation(componentLabel);
+                vecReferencePath.push_back(componentLabel);
+                fnAddCollapsedInstances(refNodeId, componentLabel, locComponent, locProduct, depthRef + 2);
+                vecReferencePath.pop_back();
+            }
+
+            return;
+        }
+
+        InstanceItem instance;
+        instance.treeNodeId = refNodeId;
+        instance.productLabel = productLabel;
+        instance.location = locProduct;
+        instance.shapeLocation = locProduct;
+        instance.depth = depthRef + 1;
+        instance.vecReferencePath = vecReferencePath;
+        if (m_document->xcaf().hasShapeColor(refLabel)) {
+            instance.colorRefLabel = refLabel;
+            instance.location = locRefParent;
+        }
+
+        vecInstance.push_back(std::move(instance));
+    };
 
     traverseTree(entityTreeNodeId, docModelTree, [&](TreeNodeId id) {
+        // Pre-order traversal: parent depth is always available
         const TDF_Label nodeLabel = docModelTree.nodeData(id);
-        if (docModelTree.nodeIsLeaf(id)) {
-            GraphicsObjectPtr gfxProduct = CppUtils::findValue(nodeLabel, mapLabelGfxProduct);
-            if (!gfxProduct) {
-                gfxProduct = m_guiApp->createGraphicsObject(nodeLabel);
-                if (!gfxProduct)
-                    return;
-
-                mapLabelGfxProduct.insert({ nodeLabel, gfxProduct });
-            }
+        const TreeNodeId parentNodeId = docModelTree.nodeParent(id);
+        const int depthParent = fnNodeDepth(parentNodeId);
+        if (!docModelTree.nodeIsLeaf(id)) {
+            mapNodeDepth.insert({ id, depthParent + 1 });
+            return;
+        }
 
-            if (!docModelTree.nodeIsRoot(id)) {
-                const TreeNodeId parentNodeId = docModelTree.nodeParent(id);
-                const TDF_Label parentNodeLabel = docModelTree.nodeData(parentNodeId);
-                if (XCaf::isShapeReference(parentNodeLabel) && m_document->xcaf().hasShapeColor(parentNodeLabel)) {
-                    // Parent node is a reference and it redefines color attribute, so the graphics
-                    // can't be shared with the product
-                    auto gfxObject = m_guiApp->createGraphicsObject(parentNodeLabel);
-                    const TreeNodeId grandParentNodeId = docModelTree.nodeParent(parentNodeId);
-                    const TopLoc_Location locGrandParentShape = XCaf::shapeAbsoluteLocation(docModelTree, grandParentNodeId);
-                    gfxObject->SetLocalTransformation(locGrandParentShape);
-                    gfxEntity.vecObject.push_back(gfxObject);
-                }
-                else {
-                    auto gfxInstance = new AIS_ConnectedInteractive;
-                    gfxInstance->Connect(gfxProduct, XCaf::shapeAbsoluteLocation(docModelTree, id));
-                    gfxInstance->SetDisplayMode(gfxProduct->DisplayMode());
-                    gfxInstance->Attributes()->SetFaceBoundaryDraw(gfxProduct->Attributes()->FaceBoundaryDraw());
-                    gfxInstance->SetOwner(gfxProduct->GetOwner());
-                    gfxEntity.vecObject.push_back(GraphicsObjectPtr(gfxInstance));
-                }
+        const TopLoc_Location locNode = m_document->modelTreeNodeAbsoluteLocation(id);
+        if (m_document->isModelTreeNodeCollapsed(id)) {
+            const TopLoc_Location locParent = m_document->modelTreeNodeAbsoluteLocation(parentNodeId);
+            fnAddCollapsedInstances(id, nodeLabel, locNode, locParent, depthParent + 1);
+            return;
+        }
 
-                if (XCaf::isShapeReference(parentNodeLabel))
-                    id = docModelTree.nodeParent(id);
-            }
-            else {
-                gfxEntity.vecObject.push_back(gfxProduct);
+        InstanceItem instance;
+        instance.treeNodeId = id;
+        instance.productLabel = nodeLabel;
+        instance.location = locNode;
+        instance.shapeLocation = locNode;
+        instance.isEntityRoot = docModelTree.nodeIsRoot(id);
+        instance.depth = depthParent + 1;
+        if (!instance.isEntityRoot) {
+            const TDF_Label parentNodeLabel = docModelTree.nodeData(parentNodeId);
+            if (XCaf::isShapeReference(parentNodeLabel) && m_document->xcaf().hasShapeColor(parentNodeLabel)) {
+                // Parent node is a reference and it redefines color attribute, so the graphics
+                // can't be shared with the product
+                instance.colorRefLabel = parentNodeLabel;
+                instance.location = m_document->modelTreeNodeAbsoluteLocation(docModelTree.nodeParent(parentNodeId));
             }
 
-            const GraphicsEntity::Object& lastGfxObject = gfxEntity.vecObject.back();
-            gfxEntity.mapTreeNodeGfxObject.insert({ id, lastGfxObject.ptr });
-            gfxEntity.mapGfxObjectTreeNode.insert({ lastGfxObject.ptr, id });
+            if (XCaf::isShapeReference(parentNodeLabel))
+                instance.treeNodeId = parentNodeId;
         }
+
+        vecInstance.push_back(std::move(instance));
     });
 
-    for (const GraphicsEntity::Object& object : gfxEntity.vecObject) {
-        m_gfxScene.addObject(object.ptr);
-        auto driver = GraphicsObjectDriver::get(object.ptr);
+    return vecInstance;
+}
+
+void GuiDocument::addGraphicsObjects(
+        GraphicsEntity* gfxEntity,
+        Span<const InstanceItem> spanInstance,
+        std::unordered_map<TDF_Label, GraphicsObjectPtr>* mapLabelGfxProduct)
+{
+    for (const InstanceItem& instance : spanInstance) {
+        GraphicsObjectPtr gfxProduct = CppUtils::findValue(instance.productLabel, *mapLabelGfxProduct);
+        if (!gfxProduct) {
+            gfxProduct = m_guiApp->createGraphicsObject(instance.productLabel);
+            if (!gfxProduct)
+                continue;
+
+            mapLabelGfxProduct->insert({ instance.productLabel, gfxProduct });
+        }
+
+        GraphicsObjectPtr gfxObject;
+        if (instance.isEntityRoot) {
+            gfxObject = gfxProduct;
+        }
+        else if (!instance.colorRefLabel.IsNull()) {
+            gfxObject = m_guiApp->createGraphicsObject(instance.colorRefLabel);
+            gfxObject->SetLocalTransformation(instance.location);
+        }
+        else {
+            auto gfxInstance = new AIS_ConnectedInteractive;
+            gfxInstance->Connect(gfxProduct, instance.location);
+            gfxInstance->SetDisplayMode(gfxProduct->DisplayMode());
+            gfxInstance->Attributes()->SetFaceBoundaryDraw(gfxProduct->Attributes()->FaceBoundaryDraw());
+            gfxInstance->SetOwner(gfxProduct->GetOwner());
+            gfxObject = gfxInstance;
+        }
+
+        m_gfxScene.addObject(gfxObject);
+        auto driver = GraphicsObjectDriver::get(gfxObject);
         if (driver)
-            driver->applyDisplayMode(object.ptr, this->activeDisplayMode(driver));
+            driver->applyDisplayMode(gfxObject, this->activeDisplayMode(driver));
+
+        GraphicsEntity::Object object(gfxObject);
+        object.bndBox = !instance.bndBox.IsVoid() ? instance.bndBox : GraphicsUtils::AisObject_boundingBox(gfxObject);
+        object.trsfOriginal = m_gfxScene.objectTransformation(gfxObject);
+        BndUtils::add(&gfxEntity->bndBox, object.bndBox);
+        gfxEntity->vecObject.push_back(std::move(object));
+        gfxEntity->isExplodeVectorValid = false;
+        // Tree nodes might have been expanded since the instance was collected
+        const TreeNodeId nodeId = this->attachGraphicsObject(instance.treeNodeId, gfxObject, instance.vecReferencePath);
+        // Tree node might have been hidden before its graphics were added(progressive mapping)
+        if (this->nodeVisibleState(nodeId) == CheckState::Off)
+            GraphicsUtils::AisObject_setVisible(gfxObject, false);
     }
+}
 
-    for (GraphicsEntity::Object& object : gfxEntity.vecObject) {
-        object.bndBox = GraphicsUtils::AisObject_boundingBox(object.ptr);
-        object.trsfOriginal = m_gfxScene.objectTransformation(object.ptr);
-        BndUtils::add(&gfxEntity.bndBox, object.bndBox);
+void GuiDocument::mapEntityProgressive(TreeNodeId entityTreeNodeId, std::vector<InstanceItem>&& vecInstance)
+{
+    auto mapping = std::make_shared<EntityMapping>();
+    mapping->entityTreeNodeId = entityTreeNodeId;
+    mapping->vecInstance = std::move(vecInstance);
+    // Top-level products first, so they become interactive before the deepest parts
+    std::stable_sort(
+        mapping->vecInstance.begin(), mapping->vecInstance.end(),
+        [](const InstanceItem& lhs, const InstanceItem& rhs) { return lhs.depth < rhs.depth; }
+    );
+
+    // Shapes of products are retrieved here, worker threads must not access the document
+    std::unordered_map<TDF_Label, int> mapLabelProductIndex;
+    for (InstanceItem& instance : mapping->vecInstance) {
+        const auto productIndex = static_cast<int>(mapping->vecProductShape.size());
+        auto [it, isNewProduct] = mapLabelProductIndex.insert({ instance.productLabel, productIndex });
+        if (isNewProduct) {
+            const bool isShape = XCaf::isShape(instance.productLabel);
+            mapping->vecProductShape.push_back(isShape ? XCaf::shape(instance.productLabel) : TopoDS_Shape());
+        }
+
+        instance.productIndex = it->second;
     }
 
-    m_gfxScene.redraw();
+    GraphicsEntity gfxEntity;
+    gfxEntity.treeNodeId = entityTreeNodeId;
+    this->addGraphicsEntity(std::move(gfxEntity));
+    m_vecEntityMapping.push_back(mapping);
+
+    // Tessellate products and compute bounding boxes batch per batch in a worker thread, each batch
+    // is then posted to the GUI thread. So the AIS presentations computed by the GUI thread reuse
+    // the triangulations instead of meshing the shapes
+    // A product is processed with the first batch referencing it, the GUI thread accesses its shape
+    // only once that batch is posted
+    // Note: InstanceItem objects of a batch aren't modified anymore once the batch is posted
+    const std::any guiThreadContext = m_guiThreadContext;
+    const OccHandle<Prs3d_Drawer> drawer = m_gfxScene.drawerDefault();
+    TaskThreadPool::globalInstance().start([=]{
+        const size_t instanceCount = mapping->vecInstance.size();
+        std::vector<Bnd_Box> vecProductBndBox(mapping->vecProductShape.size());
+        std::vector<bool> vecProductBndBoxDone(mapping->vecProductShape.size(), false);
+        for (size_t first = 0; first < instanceCount && !mapping->cancelled; first += Internal::ProgressiveMapping_BatchSize) {
+            const size_t last = std::min(first + Internal::ProgressiveMapping_BatchSize, instanceCount);
+            std::vector<int> vecProductIndex;
+            for (size_t i = first; i < last; ++i) {
+                const int productIndex = mapping->vecInstance.at(i).productIndex;
+                if (!vecProductBndBoxDone.at(productIndex)) {
+                    vecProductBndBoxDone.at(productIndex) = true;
+                    vecProductIndex.push_back(productIndex);
+                }
+            }
+
+            OSD_Parallel::For(0, static_cast<int>(vecProductIndex.size()), [&](int i) {
+                const int productIndex = vecProductIndex.at(i);
+                const TopoDS_Shape& shape = mapping->vecProductShape.at(productIndex);
+                vecProductBndBox.at(productIndex) = Internal::productBoundingBox(shape, drawer);
+            });
+
+            OSD_Parallel::For(static_cast<int>(first), static_cast<int>(last), [&](int i) {
+                InstanceItem& instance = mapping->vecInstance.at(i);
+                const Bnd_Box& productBndBox = vecProductBndBox.at(instance.productIndex);
+                if (!productBndBox.IsVoid())
+                    instance.bndBox = productBndBox.Transformed(instance.shapeLocation.Transformation());
+            });
 
-    traverseTree(entityTreeNodeId, docModelTree, [=](TreeNodeId id) {
-        m_mapTreeNodeCheckState.insert({ id, CheckState::On });
+            getGlobalSignalThreadHelper()->execInThread(guiThreadContext, [=]{
+                if (!mapping->cancelled)
+                    this->mapEntityBatch(mapping, first, last);
+            });
+        }
     });
+}
 
-    m_vecGraphicsEntity.push_back(std::move(gfxEntity));
+void GuiDocument::mapEntityBatch(const std::shared_ptr<EntityMapping>& mapping, size_t first, size_t last)
+{
+    GraphicsEntity* gfxEntity = this->findGraphicsEntity(mapping->entityTreeNodeId);
+    if (!gfxEntity)
+        return;
+
+    const Span<const InstanceItem> spanInstance(mapping->vecInstance);
+    this->addGraphicsObjects(gfxEntity, spanInstance.subspan(first, last - first), &mapping->mapLabelGfxProduct);
+    BndUtils::add(&m_gfxBoundingBox, gfxEntity->bndBox);
+    const bool isLastBatch = last == mapping->vecInstance.size();
+    if (first == 0 || isLastBatch)
+        GraphicsUtils::V3dView_fitAll(m_v3dView, this->graphicsBoundingBox(OnlySelectedGraphics | OnlyVisibleGraphics));
+
+    m_gfxScene.redraw();
+    if (isLastBatch) {
+        auto itMapping = std::find(m_vecEntityMapping.begin(), m_vecEntityMapping.end(), mapping);
+        if (itMapping != m_vecEntityMapping.end())
+            m_vecEntityMapping.erase(itMapping);
+
+        this->signalGraphicsBoundingBoxChanged.send(m_gfxBoundingBox);
+    }
 }
 
 void GuiDocument::unmapEntity(TreeNodeId entityTreeNodeId)
 {
+    {   // Cancel progressive mapping(if any)
+        auto itMapping = std::find_if(
+            m_vecEntityMapping.begin(), m_vecEntityMapping.end(),
+            [=](const std::shared_ptr<EntityMapping>& mapping) { return mapping->entityTreeNodeId == entityTreeNodeId; }
+        );
+        if (itMapping != m_vecEntityMapping.end()) {
+            (*itMapping)->cancelled = true;
+            m_vecEntityMapping.erase(itMapping);
+        }
+    }
+
     {   // Delete entity graphics
         const GraphicsEntity* ptrItem = this->findGraphicsEntity(entityTreeNodeId);
         if (!ptrItem)
             return;
 
-        for (const GraphicsEntity::Object& object : ptrItem->vecObject)
+        for (const GraphicsEntity::Object& object : ptrItem->vecObject) {
             m_gfxScene.eraseObject(object.ptr);
+            m_mapGfxObjectTreeNode.erase(object.ptr.get());
+        }
 
         const auto indexItem = ptrItem - &m_vecGraphicsEntity.front();
         m_vecGraphicsEntity.erase(m_vecGraphicsEntity.begin() + indexItem);
+        // Entities after the erased one are shifted
+        for (auto i = indexItem; CppUtils::cmpLess(i, m_vecGraphicsEntity.size()); ++i)
+            this->changeTreeNodeGraphics(m_vecGraphicsEntity.at(i).treeNodeId).entityIndex = int(i);
+
         m_gfxScene.redraw();
     }
 
     traverseTree(entityTreeNodeId, m_document->modelTree(), [=](TreeNodeId id) {
-        m_mapTreeNodeCheckState.erase(id);
+        if (id < m_vecTreeNodeGraphics.size())
+            m_vecTreeNodeGraphics.at(id) = {};
     });
 }
 
 const GuiDocument::GraphicsEntity* GuiDocument::findGraphicsEntity(TreeNodeId entityTreeNodeId) const
 {
-    auto itFound = std::find_if(
-                m_vecGraphicsEntity.cbegin(),
-                m_vecGraphicsEntity.cend(),
-                [=](const GraphicsEntity& item) { return item.treeNodeId == entityTreeNodeId; }
-    );
-    return itFound != m_vecGraphicsEntity.cend() ? &(*itFound) : nullptr;
+    if (entityTreeNodeId >= m_vecTreeNodeGraphics.size())
+        return nullptr;
+
+    const int entityIndex = m_vecTreeNodeGraphics.at(entityTreeNodeId).entityIndex;
+    return entityIndex >= 0 ? &m_vecGraphicsEntity.at(entityIndex) : nullptr;
+}
+
+GuiDocument::GraphicsEntity* GuiDocument::findGraphicsEntity(TreeNodeId entityTreeNodeId)
+{
+    const GuiDocument* constThis = this;
+    return const_cast<GraphicsEntity*>(constThis->findGraphicsEntity(entityTreeNodeId));
+}
+
+void GuiDocument::addGraphicsEntity(GraphicsEntity&& gfxEntity)
+{
+    this->changeTreeNodeGraphics(gfxEntity.treeNodeId).entityIndex = int(m_vecGraphicsEntity.size());
+    m_vecGraphicsEntity.push_back(std::move(gfxEntity));
+}
+
+TreeNodeId GuiDocument::attachGraphicsObject(
+        TreeNodeId nodeId,
+        const GraphicsObjectPtr& gfxObject,
+        const std::vector<TDF_Label>& vecReferencePath)
+{
+    // Walk down the reference path as long as the tree nodes are built
+    const Tree<TDF_Label>& docModelTree = m_document->modelTree();
+    auto itRef = vecReferencePath.cbegin();
+    while (itRef != vecReferencePath.cend() && !docModelTree.nodeIsLeaf(nodeId)) {
+        // Child node of an expanded reference is the referred product, holding the components
+        const TreeNodeId productNodeId = docModelTree.nodeChildFirst(nodeId);
+        TreeNodeId componentNodeId = docModelTree.nodeChildFirst(productNodeId);
+        while (componentNodeId != 0 && docModelTree.nodeData(componentNodeId) != *itRef)
+            componentNodeId = docModelTree.nodeSiblingNext(componentNodeId);
+
+        if (componentNodeId == 0)
+            break; // Error: model tree doesn't match the XCAF references
+
+        nodeId = componentNodeId;
+        ++itRef;
+    }
+
+    TreeNodeGraphics& nodeGfx = this->changeTreeNodeGraphics(nodeId);
+    if (itRef == vecReferencePath.cend())
+        nodeGfx.gfxObject = gfxObject;
+    else
+        nodeGfx.vecNestedObject.push_back({ gfxObject, std::vector<TDF_Label>(itRef, vecReferencePath.cend()) });
+
+    m_mapGfxObjectTreeNode.insert_or_assign(gfxObject.get(), nodeId);
+    return nodeId;
+}
+
+void GuiDocument::foreachTreeNodeGraphicsObject(
+        TreeNodeId nodeId, const std::function<void(const GraphicsObjectPtr&)>& fn) const
+{
+    if (nodeId >= m_vecTreeNodeGraphics.size())
+        return;
+
+    const TreeNodeGraphics& nodeGfx = m_vecTreeNodeGraphics[nodeId];
+    if (nodeGfx.gfxObject)
+        fn(nodeGfx.gfxObject);
+
+    for (const NestedGraphicsObject& nestedObject : nodeGfx.vecNestedObject)
+        fn(nestedObject.gfxObject);
+}
+
+GuiDocument::TreeNodeGraphics& GuiDocument::changeTreeNodeGraphics(TreeNodeId nodeId)
+{
+    if (nodeId >= m_vecTreeNodeGraphics.size())
+        m_vecTreeNodeGraphics.resize(nodeId + 1);
+
+    return m_vecTreeNodeGraphics[nodeId];
 }
 
 void GuiDocument::v3dViewTrihedronDisplay(Aspect_TypeOfTriedronPosition corner)
@@ -9,6 +9,7 @@
 #include "../base/document.h"
 #include "../base/global.h"
 #include "../base/signal.h"
+#include "../base/span.h"
 #include "../graphics/graphics_object_driver.h"
 #include "../graphics/graphics_scene.h"
 #include "../graphics/graphics_view_ptr.h"
@@ -16,8 +17,11 @@
 
 #include <Aspect_TypeOfTriedronPosition.hxx>
 #include <Bnd_Box.hxx>
+#include <TopLoc_Location.hxx>
 #include <V3d_View.hxx>
+#include <any>
 #include <functional>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -97,9 +101,21 @@ public:
     // -- Visible state of document's tree nodes
     CheckState nodeVisibleState(TreeNodeId nodeId) const;
     void setNodeVisible(TreeNodeId nodeId, bool on);
+    // Same as setNodeVisible() for multiple nodes, but signalNodesVisibilityChanged is emitted once
+    // and graphics scene is redrawn once
+    void setNodesVisible(Span<const TreeNodeId> spanNodeId, bool on);
 
     // -- Exploding
+    enum class ExplodingMode {
+        Flat, // Objects move away from the center of their entity
+        Hierarchical // Each assembly level moves away from the center of its parent assembly
+    };
+    ExplodingMode explodingMode() const { return m_explodingMode; }
+    void setExplodingMode(ExplodingMode mode);
+
     double explodingFactor() const { return m_explodingFactor; }
+    // Graphics objects are moved along explode vectors precomputed once per entity, then the
+    // graphics scene is redrawn once
     void setExplodingFactor(double t); // Must be in [0,1]
 
     // -- Visibility of trihedron at world origin
@@ -147,27 +163,100 @@ public:
 private:
     void onDocumentEntityAdded(TreeNodeId entityTreeNodeId);
     void onDocumentEntityAboutToBeDestroyed(TreeNodeId entityTreeNodeId);
+    void onDocumentModelTreeCompacted(const std::vector<TreeNodeId>& vecOldToNewId);
+    void onDocumentModelTreeNodeExpanded(TreeNodeId nodeId);
     void onGraphicsSelectionChanged();
 
+    // Creates the graphics objects of an entity and adds them to the graphics scene
+    // Big entities are mapped progressively if a global ISignalThreadHelper is available: bounding
+    // boxes are computed by worker threads and graphics objects are added in batches through the
+    // event loop, from the top-level products down to the deepest ones
+    // The model tree isn't expanded: graphics objects of instances below a collapsed node are
+    // attached to that node, and moved down to the child nodes once they get built
     void mapEntity(TreeNodeId entityTreeNodeId);
     void unmapEntity(TreeNodeId entityTreeNodeId);
 
+    // Returns true if the visible state of some node changed
+    bool applyNodesVisible(Span<const TreeNodeId> spanNodeId, bool on);
+
     struct GraphicsEntity {
         struct Object {
             Object(const GraphicsObjectPtr& p) : ptr(p) {}
             GraphicsObjectPtr ptr;
             gp_Trsf trsfOriginal;
             Bnd_Box bndBox;
+            gp_Vec explodeVector; // Translation of the object for exploding factor 1
         };
 
         TreeNodeId treeNodeId;
         std::vector<Object> vecObject;
-        std::unordered_map<TreeNodeId, GraphicsObjectPtr> mapTreeNodeGfxObject;
-        std::unordered_map<GraphicsObjectPtr, TreeNodeId> mapGfxObjectTreeNode;
         Bnd_Box bndBox;
+        bool isExplodeVectorValid = false; // Reset when objects are added
+    };
+
+    // Graphics object of some instance not yet built in the model tree, with the chain of XCAF
+    // references leading to the instance from the collapsed node
+    struct NestedGraphicsObject {
+        GraphicsObjectPtr gfxObject;
+        std::vector<TDF_Label> vecReferencePath;
+    };
+
+    // Graphics data associated to a document tree node
+    struct TreeNodeGraphics {
+        GraphicsObjectPtr gfxObject;
+        std::vector<NestedGraphicsObject> vecNestedObject; // For collapsed nodes only
+        int entityIndex = -1; // Index in m_vecGraphicsEntity(for entity root nodes only)
+        bool isMapped = false;
+        CheckState visibleState = CheckState::Off;
+        // Count of direct children, and those being visible or hidden
+        int childCount = 0;
+        int childOnCount = 0;
+        int childOffCount = 0;
+    };
+
+    // Graphics instance of some leaf product, to be created when mapping an entity
+    struct InstanceItem {
+        TreeNodeId treeNodeId = 0; // Tree node associated to the graphics object
+        TDF_Label productLabel;
+        TDF_Label colorRefLabel; // Reference redefining the product color(null if none)
+        TopLoc_Location location; // Location of the graphics object
+        TopLoc_Location shapeLocation; // Absolute location of the product shape
+        // References from 'treeNodeId' down to the instance, empty if the instance is the node itself
+        std::vector<TDF_Label> vecReferencePath;
+        bool isEntityRoot = false;
+        int depth = 0;
+        int productIndex = -1;
+        Bnd_Box bndBox; // Bounding box of the product shape at instance location, void if not available
     };
 
+    // State of an entity being progressively mapped
+    struct EntityMapping;
+
+    std::vector<InstanceItem> collectEntityInstances(TreeNodeId entityTreeNodeId) const;
+    void addGraphicsObjects(
+            GraphicsEntity* gfxEntity,
+            Span<const InstanceItem> spanInstance,
+            std::unordered_map<TDF_Label, GraphicsObjectPtr>* mapLabelGfxProduct
+    );
+    void mapEntityProgressive(TreeNodeId entityTreeNodeId, std::vector<InstanceItem>&& vecInstance);
+    void mapEntityBatch(const std::shared_ptr<EntityMapping>& mapping, size_t first, size_t last);
+
+    void computeExplodeVectors(GraphicsEntity* gfxEntity) const;
+
     const GraphicsEntity* findGraphicsEntity(TreeNodeId entityTreeNodeId) const;
+    GraphicsEntity* findGraphicsEntity(TreeNodeId entityTreeNodeId);
+    void addGraphicsEntity(GraphicsEntity&& gfxEntity);
+
+    // Associates graphics object to the deepest tree node built along the reference path
+    // Returns the identifier of the tree node the object is associated to
+    TreeNodeId attachGraphicsObject(
+            TreeNodeId nodeId,
+            const GraphicsObjectPtr& gfxObject,
+            const std::vector<TDF_Label>& vecReferencePath
+    );
+    // Executes callback 'fn' on the graphics objects attached to tree node 'nodeId'(no traversal)
+    void foreachTreeNodeGraphicsObject(TreeNodeId nodeId, const std::function<void(const GraphicsObjectPtr&)>& fn) const;
+    TreeNodeGraphics& changeTreeNodeGraphics(TreeNodeId nodeId);
 
     void v3dViewTrihedronDisplay(Aspect_TypeOfTriedronPosition corner);
 
@@ -184,11 +273,16 @@ private:
     OccHandle<AIS_InteractiveObject> m_aisViewCube;
 
     std::vector<GraphicsEntity> m_vecGraphicsEntity;
+    // Indexed with TreeNodeId(dense array aligned with the document model tree)
+    std::vector<TreeNodeGraphics> m_vecTreeNodeGraphics;
+    std::unordered_map<const AIS_InteractiveObject*, TreeNodeId> m_mapGfxObjectTreeNode;
+    std::vector<std::shared_ptr<EntityMapping>> m_vecEntityMapping;
+    std::any m_guiThreadContext;
     Bnd_Box m_gfxBoundingBox;
 
     std::unordered_map<GraphicsObjectDriverPtr, int> m_mapGfxDriverDisplayMode;
-    std::unordered_map<TreeNodeId, CheckState> m_mapTreeNodeCheckState;
 
+    ExplodingMode m_explodingMode = ExplodingMode::Flat;
     double m_explodingFactor = 0.;
 
     std::vector<GraphicsObjectPtr> m_selGfxObjects;
@@ -28,12 +28,16 @@
 #include <fmt/format.h>
 
 #include <cassert>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <type_traits>
 
 #include <gp_Quaternion.hxx>
 #include <gp_Trsf.hxx>
 #include <BRep_Builder.hxx>
 #include <Image_Texture.hxx>
+#include <OSD_Parallel.hxx>
 #include <Poly_Triangulation.hxx>
 #include <TDataStd_Name.hxx>
 #include <XCAFDoc_VisMaterial.hxx>
@@ -216,18 +220,36 @@ Quantity_Color toOccColor(const aiColor4D& color, Quantity_TypeOfColor colorType
     return Quantity_Color(color.r, color.g, color.b, colorType);
 }
 
+// Buffer referring to the data of an assimp embedded texture, data isn't copied
+// The aiScene object owning the texture is kept alive as long as the buffer exists
+class AssimpTextureBuffer : public NCollection_Buffer {
+public:
+    AssimpTextureBuffer(const std::shared_ptr<const aiScene>& scene, const aiTexture* texture)
+        : NCollection_Buffer(
+              OccHandle<NCollection_BaseAllocator>(), // Null allocator: data won't be freed by the buffer
+              AssimpTextureBuffer::dataSize(texture),
+              reinterpret_cast<Standard_Byte*>(texture->pcData)
+          ),
+          m_scene(scene)
+    {
+    }
+
+    static Standard_Size dataSize(const aiTexture* texture)
+    {
+        // Height is zero for compressed textures, then width is the size in bytes
+        const Standard_Size width = texture->mWidth;
+        const Standard_Size height = texture->mHeight;
+        return height == 0 ? width : 4 * width * height;
+    }
+
+private:
+    std::shared_ptr<const aiScene> m_scene;
+};
+
 // Create an OpenCascade Image_Texture object from assimp texture
-OccHandle<Image_Texture> createOccTexture(const aiTexture* texture)
+OccHandle<Image_Texture> createOccTexture(const std::shared_ptr<const aiScene>& scene, const aiTexture* texture)
 {
-    const auto textureWidth = texture->mWidth;
-    const auto textureHeight = texture->mHeight;
-    const auto textureSize = textureHeight == 0 ? textureWidth : 4 * textureWidth * textureHeight;
-    auto buff = makeOccHandle<NCollection_Buffer>(
-        NCollection_BaseAllocator::CommonBaseAllocator(),
-        textureSize
-    );
-    auto textureData = reinterpret_cast<const Standard_Byte*>(texture->pcData);
-    std::copy(textureData, textureData + textureSize, buff->ChangeData());
+    OccHandle<NCollection_Buffer> buff = new AssimpTextureBuffer(scene, texture);
     return new Image_Texture(buff, texture->mFilename.C_Str());
 }
 
@@ -240,30 +262,72 @@ OccHandle<Poly_Triangulation> createOccTriangulation(const aiMesh* mesh)
 
     const unsigned textureIndex = 0;
     const bool hasUvNodes = mesh->HasTextureCoords(textureIndex) && mesh->mNumUVComponents[textureIndex] == 2;
-    auto triangulation = makeOccHandle<Poly_Triangulation>(mesh->mNumVertices, mesh->mNumFaces, hasUvNodes);
+    const bool hasNormals = mesh->HasNormals();
+    const auto nodeCount = static_cast<int>(mesh->mNumVertices);
+    const auto triangleCount = static_cast<int>(mesh->mNumFaces);
+    using OccNormal = MeshUtils::Poly_Triangulation_NormalType;
+#if OCC_VERSION_HEX >= 0x070600
+    // Nodes are stored with the precision of assimp data(single by default), so nodes and normals
+    // can be copied in bulk
+    constexpr bool isAssimpSinglePrecision = std::is_same_v<ai_real, float>;
+    auto triangulation = makeOccHandle<Poly_Triangulation>();
+    triangulation->SetDoublePrecision(!isAssimpSinglePrecision);
+    triangulation->ResizeNodes(nodeCount, false/*toCopyOld*/);
+    triangulation->ResizeTriangles(triangleCount, false/*toCopyOld*/);
+    if (hasNormals)
+        triangulation->AddNormals();
+
+    if (hasUvNodes)
+        triangulation->AddUVNodes();
+
+    if constexpr (isAssimpSinglePrecision) {
+        static_assert(!isAssimpSinglePrecision || sizeof(aiVector3D) == sizeof(gp_Vec3f));
+        if (nodeCount > 0) {
+            std::memcpy(&triangulation->InternalNodes().ChangeValue3f(0), mesh->mVertices, nodeCount * sizeof(aiVector3D));
+            if (hasNormals)
+                std::memcpy(&triangulation->InternalNormals().ChangeFirst(), mesh->mNormals, nodeCount * sizeof(aiVector3D));
+        }
+    }
+    else {
+        for (int i = 0; i < nodeCount; ++i) {
+            const aiVector3D& vertex = mesh->mVertices[i];
+            triangulation->SetNode(i + 1, gp_Pnt{ vertex.x, vertex.y, vertex.z });
+        }
 
-    for (unsigned i = 0; i < mesh->mNumVertices; ++i) {
+        for (int i = 0; hasNormals && i < nodeCount; ++i) {
+            const aiVector3D& normal = mesh->mNormals[i];
+            MeshUtils::setNormal(triangulation, i + 1, OccNormal(float(normal.x), float(normal.y), float(normal.z)));
+        }
+    }
+#else
+    auto triangulation = makeOccHandle<Poly_Triangulation>(nodeCount, triangleCount, hasUvNodes);
+    for (int i = 0; i < nodeCount; ++i) {
         const aiVector3D& vertex = mesh->mVertices[i];
         MeshUtils::setNode(triangulation, i + 1, { vertex.x, vertex.y, vertex.z });
     }
 
-    for (unsigned i = 0; i < mesh->mNumFaces; ++i) {
-        const auto indices = mesh->mFaces[i].mIndices;
-        assert(mesh->mFaces[i].mNumIndices == 3);
-        MeshUtils::setTriangle(triangulation, i + 1, Poly_Triangle(indices[0] + 1, indices[1] + 1, indices[2] + 1));
-    }
-
-    if (mesh->HasNormals()) {
+    if (hasNormals) {
         MeshUtils::allocateNormals(triangulation);
-        for (unsigned i = 0; i < mesh->mNumVertices; ++i) {
-            using OccNormal = MeshUtils::Poly_Triangulation_NormalType;
+        for (int i = 0; i < nodeCount; ++i) {
             const aiVector3D& normal = mesh->mNormals[i];
             MeshUtils::setNormal(triangulation, i + 1, OccNormal{ normal.x, normal.y, normal.z });
         }
     }
+#endif
+
+    // Copy face indices straight into the triangle array, shifting them to OpenCascade 1-based
+    // node indices
+    if (triangleCount > 0) {
+        Poly_Triangle* triangles = &MeshUtils::changeTriangles(triangulation).ChangeFirst();
+        for (int i = 0; i < triangleCount; ++i) {
+            const unsigned* indices = mesh->mFaces[i].mIndices;
+            assert(mesh->mFaces[i].mNumIndices == 3);
+            triangles[i].Set(int(indices[0] + 1), int(indices[1] + 1), int(indices[2] + 1));
+        }
+    }
 
     if (hasUvNodes) {
-        for (unsigned i = 0; i < mesh->mNumVertices; i++) {
+        for (int i = 0; i < nodeCount; ++i) {
             const aiVector3D& t = mesh->mTextureCoords[textureIndex][i];
             MeshUtils::setUvNode(triangulation, i + 1, t.x, t.y);
         }
@@ -272,6 +336,16 @@ OccHandle<Poly_Triangulation> createOccTriangulation(const aiMesh* mesh)
     return triangulation;
 }
 
+// Deletes the meshes owned by 'scene', the scene itself stays valid
+// Useful when the scene is kept alive only because of embedded textures
+void releaseSceneMeshes(aiScene* scene)
+{
+    for (unsigned i = 0; i < scene->mNumMeshes; ++i) {
+        delete scene->mMeshes[i];
+        scene->mMeshes[i] = nullptr;
+    }
+}
+
 // Provides assimp progress handler for TaskProgress
 class AssimpProgressHandler : public Assimp::ProgressHandler {
 public:
@@ -310,6 +384,7 @@ public:
 
 bool AssimpReader::readFile(const FilePath& filepath, TaskProgress* progress)
 {
+    m_scene.reset();
     m_vecTriangulation.clear();
     m_vecMaterial.clear();
     m_mapMaterialLabel.clear();
@@ -338,8 +413,8 @@ bool AssimpReader::readFile(const FilePath& filepath, TaskProgress* progress)
     //m_importer.SetPropertyBool(AI_CONFIG_IMPORT_FBX_PRESERVE_PIVOTS, false);
     m_importer.SetPropertyBool(AI_CONFIG_PP_PTV_KEEP_HIERARCHY, true);
     m_importer.SetProgressHandler(new AssimpProgressHandler(progress));
-    m_scene = m_importer.ReadFile(filepath.u8string(), flags);
-    if (!m_scene || (m_scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || !m_scene->mRootNode) {
+    const aiScene* scene = m_importer.ReadFile(filepath.u8string(), flags);
+    if (!scene || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) || !scene->mRootNode) {
         this->messenger()->emitError(m_importer.GetErrorString());
         return false;
     }
@@ -348,24 +423,36 @@ bool AssimpReader::readFile(const FilePath& filepath, TaskProgress* progress)
     // Apply "aiProcess_PreTransformVertices" post-processing step
     // This avoids issues with any non-identity scaling matrix
     // WARNING Assimp bones and animations are destructed by this step
-    if (deep_aiNodeTransformationHasScaling(m_scene->mRootNode)) {
-        m_scene = m_importer.ApplyPostProcessing(aiProcess_PreTransformVertices);
+    if (deep_aiNodeTransformationHasScaling(scene->mRootNode)) {
+        m_importer.ApplyPostProcessing(aiProcess_PreTransformVertices);
         this->messenger()->emitTrace("aiProcess_PreTransformVertices ON");
     }
 #endif
 
+    // Take ownership of the scene, so it can outlive the importer: embedded textures share its data
+    m_scene.reset(m_importer.GetOrphanedScene());
+    if (!m_scene) {
+        this->messenger()->emitError(m_importer.GetErrorString());
+        return false;
+    }
+
     // Create OpenCascade elements from the assimp meshes
     //     mesh of triangles -> Poly_Triangulation
     //     mesh lines -> Poly_Polygon3D
+    // Meshes are independent of each other, so they are converted in parallel
     m_vecTriangulation.resize(m_scene->mNumMeshes);
-    std::fill(m_vecTriangulation.begin(), m_vecTriangulation.end(), nullptr);
+    OSD_Parallel::For(0, static_cast<int>(m_scene->mNumMeshes), [&](int i) {
+        const aiMesh* mesh = m_scene->mMeshes[i];
+        if (mesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE)
+            m_vecTriangulation.at(i) = createOccTriangulation(mesh);
+    });
+
     for (unsigned i = 0; i < m_scene->mNumMeshes; ++i) {
         const aiMesh* mesh = m_scene->mMeshes[i];
-        if (mesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE) {
-            auto triangulation = createOccTriangulation(mesh);
-            m_vecTriangulation.at(i) = triangulation;
-        }
-        else if (mesh->mPrimitiveTypes & aiPrimitiveType_LINE) {
+        if (mesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE)
+            continue; // Already converted
+
+        if (mesh->mPrimitiveTypes & aiPrimitiveType_LINE) {
             // TODO Create and add a Poly_Polygon3D object
             this->messenger()->emitWarning(AssimpReaderI18N::textIdTr("LINE primitives not supported yet"));
         }
@@ -376,7 +463,7 @@ bool AssimpReader::readFile(const FilePath& filepath, TaskProgress* progress)
 
     for (unsigned i = 0; i < m_scene->mNumTextures; ++i) {
         const aiTexture* texture = m_scene->mTextures[i];
-        m_mapEmbeddedTexture.insert({ texture, createOccTexture(texture) });
+        m_mapEmbeddedTexture.insert({ texture, createOccTexture(m_scene, texture) });
     }
 
     m_vecMaterial.resize(m_scene->mNumMaterials);
@@ -387,7 +474,7 @@ bool AssimpReader::readFile(const FilePath& filepath, TaskProgress* progress)
     }
 
 #ifdef MAYO_ASSIMP_READER_HANDLE_SCALING
-    deep_aiScenePrint(std::cout, m_scene);
+    deep_aiScenePrint(std::cout, m_scene.get());
 #endif
     return true;
 }
@@ -438,6 +525,11 @@ TDF_LabelSequence AssimpReader::transfer(DocumentPtr doc, TaskProgress* progress
     });
     //doc->xcaf().shapeTool()->ComputeShapes(labelEntity);
     doc->xcaf().shapeTool()->UpdateAssemblies();
+
+    // Scene might be kept alive by embedded textures, release the meshes as they were converted
+    releaseSceneMeshes(m_scene.get());
+    m_scene.reset();
+    m_vecTriangulation.clear();
     return CafUtils::makeLabelSequence({ labelEntity });
 }
 
@@ -15,6 +15,7 @@
 #include <XCAFDoc_VisMaterial.hxx>
 
 #include <functional>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -59,7 +60,7 @@ private:
 
     class Properties;
     Assimp::Importer m_importer;
-    const aiScene* m_scene = nullptr;
+    std::shared_ptr<aiScene> m_scene; // Orphaned from m_importer
 
     std::vector<OccHandle<Poly_Triangulation>> m_vecTriangulation;
     std::vector<OccHandle<XCAFDoc_VisMaterial>> m_vecMaterial;
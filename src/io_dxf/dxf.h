@@ -784,4 +784,6 @@ public:
     virtual void AddGraphics() const = 0;
 
     std::string LayerName() const;
+    const std::string& SectionName() const { return m_section_name; }
+    const std::string& BlockName() const { return m_block_name; }
 };
@@ -46,13 +46,19 @@
 #include <gp_Elips.hxx>
 #include <gp_Trsf.hxx>
 
+#include <OSD_Parallel.hxx>
+
 #include <fmt/format.h>
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <iostream>
+#include <map>
 #include <optional>
 #include <sstream>
 #include <string_view>
+#include <tuple>
+#include <variant>
 
 #define MAYO_IO_DXF_DEBUG_TRACE 1
 
@@ -107,6 +113,64 @@ private:
     std::uintmax_t m_fileReadSize = 0;
     Resource_FormatType m_srcEncoding = Resource_ANSI;
 
+    struct Block {
+        std::vector<DxfReader::Entity> vecEntity;
+        // Scale factor -> index of the block shape in m_vecBlockShape
+        std::vector<std::pair<double, int>> vecScaledShapeIndex;
+    };
+    std::unordered_map<std::string, Block> m_mapBlock;
+    std::vector<DxfReader::BlockShape> m_vecBlockShape;
+
+    // Fonts shared by text entities, keyed by (name, height, width scaling)
+    // Note: Font_BRepFont caches the shapes of rendered glyphs, so they are reused across texts
+    std::map<std::tuple<std::string, double, double>, OccHandle<Font_BRepFont>> m_mapFont;
+
+    // Records of parsed entities, holding the data required to build their shape
+    struct LineRecord {
+        gp_Pnt p0;
+        gp_Pnt p1;
+    };
+    struct PolylineRecord {
+        std::vector<gp_Pnt> vecNode; // Polyline vertices or nodes of the polyface mesh
+        std::vector<Poly_Triangle> vecTriangle; // Only for polyface mesh
+        bool isPolyfaceMesh = false;
+        bool isClosed = false;
+    };
+    struct CircleRecord {
+        gp_Circ circle;
+        std::optional<std::pair<gp_Pnt, gp_Pnt>> arcEnds; // Full circle if null
+    };
+    struct EllipseRecord {
+        gp_Elips ellipse;
+    };
+    struct SplineRecord {
+        int degree = 0;
+        bool isPeriodic = false;
+        std::vector<gp_Pnt> vecPole;
+        std::vector<double> vecKnot;
+        std::vector<double> vecWeight;
+        std::vector<gp_Pnt> vecFitPoint; // Interpolated points, used if there is no pole
+    };
+    struct TextRecord {
+        OccHandle<Font_BRepFont> font;
+        NCollection_String str;
+        gp_Ax3 location;
+        Graphic3d_HorizontalTextAlignment hAlign = Graphic3d_HTA_LEFT;
+        Graphic3d_VerticalTextAlignment vAlign = Graphic3d_VTA_TOP;
+        bool useTextFormatter = false;
+    };
+    using ShapeRecord = std::variant<
+        LineRecord, PolylineRecord, CircleRecord, EllipseRecord, SplineRecord, TextRecord
+    >;
+
+    // Entity whose shape is built once parsing is done
+    struct DeferredShape {
+        ShapeRecord record;
+        std::vector<DxfReader::Entity>* ptrVecEntity = nullptr; // Entities of the target layer
+        std::size_t entityIndex = 0;
+    };
+    std::vector<DeferredShape> m_vecDeferredShape;
+
 protected:
     void get_line() override;
     bool setSourceEncoding(const std::string& codepage) override;
@@ -118,6 +182,7 @@ public:
     void setMessenger(Messenger* messenger) { m_messenger = messenger; }
     void setParameters(const DxfReader::Parameters& params) { m_params = params; }
     const auto& layers() const { return m_layers; }
+    const auto& blockShapes() const { return m_vecBlockShape; }
 
     // CDxfRead's virtual functions
     void OnReadLine(const DxfCoords& s, const DxfCoords& e, bool hidden) override;
@@ -137,11 +202,33 @@ public:
     void ReportError(const std::string& msg) override;
     void AddGraphics() const override;
 
-    static OccHandle<Geom_BSplineCurve> createSplineFromPolesAndKnots(const Dxf_SPLINE& spline);
-    static OccHandle<Geom_BSplineCurve> createInterpolationSpline(const Dxf_SPLINE& spline);
+    static OccHandle<Geom_BSplineCurve> createSplineFromPolesAndKnots(const SplineRecord& spline);
+    static OccHandle<Geom_BSplineCurve> createInterpolationSpline(const SplineRecord& spline);
 
     gp_Pnt toPnt(const DxfCoords& coords) const;
     void addShape(const TopoDS_Shape& shape);
+    void addEntity(const DxfReader::Entity& entity);
+
+    // Returns the font matching input parameters, null if font can't be initialized
+    OccHandle<Font_BRepFont> findFont(const std::string& fontName, double height, double widthScaling = 1.);
+
+    // Adds entity described by 'record', its shape is built right now or deferred until
+    // buildDeferredShapes() call
+    void addRecord(ShapeRecord record);
+
+    // Builds the shape described by 'record', 'ptrError' receives the error message if any
+    // This function is thread-safe for records not sharing the same font
+    TopoDS_Shape buildShape(const ShapeRecord& record, std::string* ptrError) const;
+
+    // Builds the shapes of the deferred entities, in parallel
+    // Texts sharing the same font are processed in the same thread as Font_BRepFont objects
+    // aren't thread-safe
+    // 'progress' is driven by the count of shapes built, remaining shapes are skipped on abort
+    void buildDeferredShapes(TaskProgress* progress);
+
+    // Returns index in m_vecBlockShape of the shape of block 'blockName' scaled by 'scale'
+    // The block shape is created at first call, -1 is returned if the block doesn't exist or is empty
+    int findBlockShape(const std::string& blockName, double scale);
 
     TopoDS_Face makeFace(const Dxf_QuadBase& quad) const;
 };
@@ -160,6 +247,11 @@ public:
                     textIdTr("Group all objects within a layer into a single compound shape"));
         this->fontNameForTextObjects.setDescription(
                     textIdTr("Name of the font to be used when creating shape for text objects"));
+        this->parallelBuild.setDescription(
+                    textIdTr("Build shapes of entities in parallel once the file is read"));
+        this->lightweightLines.setDescription(
+                    textIdTr("Create lines as polygonal edges without curve geometry\n"
+                             "Faster to build and display for huge drawings, but such edges can't be used for modeling"));
     }
 
     void restoreDefaults() override {
@@ -168,22 +260,34 @@ public:
         this->importAnnotations.setValue(params.importAnnotations);
         this->groupLayers.setValue(params.groupLayers);
         this->fontNameForTextObjects.setValue(0);
+        this->parallelBuild.setValue(params.parallelBuild);
+        this->lightweightLines.setValue(params.lightweightLines);
     }
 
     PropertyDouble scaling{ this, textId("scaling") };
     PropertyBool importAnnotations{ this, textId("importAnnotations") };
     PropertyBool groupLayers{ this, textId("groupLayers") };
     PropertyEnumeration fontNameForTextObjects{ this, textId("fontNameForTextObjects"), &systemFontNames() };
+    PropertyBool parallelBuild{ this, textId("parallelBuild") };
+    PropertyBool lightweightLines{ this, textId("lightweightLines") };
 };
 
 bool DxfReader::readFile(const FilePath& filepath, TaskProgress* progress)
 {
     m_layers.clear();
-    DxfReader::Internal internalReader(filepath, progress);
+    m_vecBlockShape.clear();
+    // Building of deferred shapes is a progress stage of its own
+    const double buildPortion = m_params.parallelBuild ? 40 : 0;
+    TaskProgress readProgress(progress, 100 - buildPortion);
+    DxfReader::Internal internalReader(filepath, &readProgress);
     internalReader.setParameters(m_params);
     internalReader.setMessenger(this->messenger() ? this->messenger() : &Messenger::null());
     internalReader.DoRead();
+    readProgress.setValue(100);
+    TaskProgress buildProgress(progress, buildPortion);
+    internalReader.buildDeferredShapes(&buildProgress);
     m_layers = std::move(internalReader.layers());
+    m_vecBlockShape = std::move(internalReader.blockShapes());
     return !internalReader.Failed();
 }
 
@@ -196,9 +300,8 @@ TDF_LabelSequence DxfReader::transfer(DocumentPtr doc, TaskProgress* progress)
     std::unordered_map<std::string, TDF_Label> mapLayerNameLabel;
     std::unordered_map<ColorIndex_t, TDF_Label> mapAciColorLabel;
 
-    auto fnAddRootShape = [&](const TopoDS_Shape& shape, const std::string& shapeName, TDF_Label layer) {
+    auto fnAddRootLabel = [&](const std::string& shapeName, TDF_Label layer) {
         const TDF_Label labelShape = shapeTool->NewShape();
-        shapeTool->SetShape(labelShape, shape);
         TDataStd_Name::Set(labelShape, to_OccExtString(shapeName));
         seqLabel.Append(labelShape);
         if (!layer.IsNull())
@@ -207,6 +310,25 @@ TDF_LabelSequence DxfReader::transfer(DocumentPtr doc, TaskProgress* progress)
         return labelShape;
     };
 
+    auto fnAddRootShape = [&](const TopoDS_Shape& shape, const std::string& shapeName, TDF_Label layer) {
+        const TDF_Label labelShape = fnAddRootLabel(shapeName, layer);
+        shapeTool->SetShape(labelShape, shape);
+        return labelShape;
+    };
+
+    // Block shapes are added to the document only once, at first insert
+    std::vector<TDF_Label> vecBlockShapeLabel(m_vecBlockShape.size());
+    auto fnBlockShapeLabel = [&](int blockShapeIndex) {
+        TDF_Label& labelBlock = vecBlockShapeLabel.at(blockShapeIndex);
+        if (labelBlock.IsNull()) {
+            const BlockShape& blockShape = m_vecBlockShape.at(blockShapeIndex);
+            labelBlock = shapeTool->AddShape(blockShape.shape, false/*!makeAssembly*/);
+            TDataStd_Name::Set(labelBlock, to_OccExtString(blockShape.name));
+        }
+
+        return labelBlock;
+    };
+
     auto fnAddAci = [&](ColorIndex_t aci) -> TDF_Label {
         auto it = mapAciColorLabel.find(aci);
         if (it != mapAciColorLabel.cend())
@@ -243,6 +365,13 @@ TDF_LabelSequence DxfReader::transfer(DocumentPtr doc, TaskProgress* progress)
             colorTool->SetColor(labelShape, labelColor, XCAFDoc_ColorGen);
     };
 
+    // Block inserts are added as assembly components referring to the shared block shape
+    auto fnAddInsertComponent = [&](const TDF_Label& labelAssembly, const Entity& entity) {
+        const TDF_Label labelBlock = fnBlockShapeLabel(entity.blockShapeIndex);
+        const TDF_Label labelComponent = shapeTool->AddComponent(labelAssembly, labelBlock, entity.location);
+        fnSetShapeColor(labelComponent, entity.aci);
+    };
+
     if (!m_params.groupLayers) {
         for (const auto& [layerName, vecEntity] : m_layers) {
             if (startsWith(layerName, "BLOCKS"))
@@ -250,9 +379,18 @@ TDF_LabelSequence DxfReader::transfer(DocumentPtr doc, TaskProgress* progress)
 
             const TDF_Label layerLabel = CppUtils::findValue(layerName, mapLayerNameLabel);
             for (const DxfReader::Entity& entity : vecEntity) {
+                if (entity.shape.IsNull())
+                    continue; // Shape creation failed
+
                 const std::string shapeName = std::string("Shape_") + std::to_string(++iShape);
-                const TDF_Label shapeLabel = fnAddRootShape(entity.shape, shapeName, layerLabel);
-                colorTool->SetColor(shapeLabel, fnAddAci(entity.aci), XCAFDoc_ColorGen);
+                if (entity.blockShapeIndex >= 0) {
+                    fnAddInsertComponent(fnAddRootLabel(shapeName, layerLabel), entity);
+                }
+                else {
+                    const TDF_Label shapeLabel = fnAddRootShape(entity.shape, shapeName, layerLabel);
+                    colorTool->SetColor(shapeLabel, fnAddAci(entity.aci), XCAFDoc_ColorGen);
+                }
+
                 fnUpdateProgressValue();
             }
         }
@@ -263,19 +401,42 @@ TDF_LabelSequence DxfReader::transfer(DocumentPtr doc, TaskProgress* progress)
                 continue; // Skip
 
             TopoDS_Compound comp = BRepUtils::makeEmptyCompound();
+            std::vector<const Entity*> vecShapeEntity;
+            std::vector<const Entity*> vecInsertEntity;
             for (const Entity& entity : vecEntity) {
-                if (!entity.shape.IsNull())
+                if (entity.blockShapeIndex >= 0) {
+                    vecInsertEntity.push_back(&entity);
+                }
+                else if (!entity.shape.IsNull()) {
                     BRepUtils::addShape(&comp, entity.shape);
+                    vecShapeEntity.push_back(&entity);
+                }
+            }
+
+            const TDF_Label layerLabel = CppUtils::findValue(layerName, mapLayerNameLabel);
+            TDF_Label compLabel;
+            if (vecInsertEntity.empty()) {
+                compLabel = fnAddRootShape(comp, layerName, layerLabel);
+            }
+            else {
+                // Layer is an assembly of the compound of plain entities and of the block inserts
+                const TDF_Label layerAsmLabel = fnAddRootLabel(layerName, layerLabel);
+                if (!vecShapeEntity.empty()) {
+                    compLabel = shapeTool->AddShape(comp, false/*!makeAssembly*/);
+                    TDataStd_Name::Set(compLabel, to_OccExtString(layerName));
+                    shapeTool->AddComponent(layerAsmLabel, compLabel, TopLoc_Location());
+                }
+
+                for (const Entity* entity : vecInsertEntity)
+                    fnAddInsertComponent(layerAsmLabel, *entity);
             }
 
-            if (!comp.IsNull()) {
-                const TDF_Label layerLabel = CppUtils::findValue(layerName, mapLayerNameLabel);
-                const TDF_Label compLabel = fnAddRootShape(comp, layerName, layerLabel);
+            if (!compLabel.IsNull()) {
                 // Check if all entities have the same color
                 bool uniqueColor = true;
-                const ColorIndex_t aci = !vecEntity.empty() ? vecEntity.front().aci : -1;
-                for (const Entity& entity : vecEntity) {
-                    uniqueColor = entity.aci == aci;
+                const ColorIndex_t aci = !vecShapeEntity.empty() ? vecShapeEntity.front()->aci : -1;
+                for (const Entity* entity : vecShapeEntity) {
+                    uniqueColor = entity->aci == aci;
                     if (!uniqueColor)
                         break;
                 }
@@ -284,11 +445,9 @@ TDF_LabelSequence DxfReader::transfer(DocumentPtr doc, TaskProgress* progress)
                     fnSetShapeColor(compLabel, aci);
                 }
                 else {
-                    for (const Entity& entity : vecEntity) {
-                        if (!entity.shape.IsNull()) {
-                            const TDF_Label entityLabel = shapeTool->AddSubShape(compLabel, entity.shape);
-                            fnSetShapeColor(entityLabel, entity.aci);
-                        }
+                    for (const Entity* entity : vecShapeEntity) {
+                        const TDF_Label entityLabel = shapeTool->AddSubShape(compLabel, entity->shape);
+                        fnSetShapeColor(entityLabel, entity->aci);
                     }
                 }
             }
@@ -298,6 +457,9 @@ TDF_LabelSequence DxfReader::transfer(DocumentPtr doc, TaskProgress* progress)
         }
     }
 
+    if (!m_vecBlockShape.empty())
+        shapeTool->UpdateAssemblies();
+
     return seqLabel;
 }
 
@@ -314,6 +476,8 @@ void DxfReader::applyProperties(const PropertyGroup* group)
         m_params.importAnnotations = ptr->importAnnotations;
         m_params.groupLayers = ptr->groupLayers;
         m_params.fontNameForTextObjects = ptr->fontNameForTextObjects.valueName();
+        m_params.parallelBuild = ptr->parallelBuild;
+        m_params.lightweightLines = ptr->lightweightLines;
     }
 }
 
@@ -417,52 +581,42 @@ void DxfReader::Internal::OnReadLine(const DxfCoords& s, const DxfCoords& e, boo
     if (p0.IsEqual(p1, Precision::Confusion()))
         return;
 
-    const TopoDS_Edge edge = BRepBuilderAPI_MakeEdge(p0, p1);
-    this->addShape(edge);
+    this->addRecord(LineRecord{ p0, p1 });
 }
 
 void DxfReader::Internal::OnReadPolyline(const Dxf_POLYLINE& polyline)
 {
+    // Only points and triangles are recorded, not the whole Dxf_POLYLINE object
+    PolylineRecord record;
     const auto& vertices = polyline.vertices;
     if (polyline.flags & Dxf_POLYLINE::Flag::PolyfaceMesh) {
+        record.isPolyfaceMesh = true;
         const int meshVertexCount = polyline.polygonMeshMVertexCount;
-        TColgp_Array1OfPnt nodes(1, meshVertexCount);
+        record.vecNode.reserve(meshVertexCount);
         for (int i = 0; i < meshVertexCount; ++i)
-            nodes.ChangeValue(i + 1) = this->toPnt(vertices.at(i).point);
+            record.vecNode.push_back(this->toPnt(vertices.at(i).point));
 
         const int meshFaceCount = polyline.polygonMeshNVertexCount;
-        std::vector<Poly_Triangle> vecTriangle;
-        vecTriangle.reserve(meshFaceCount);
+        record.vecTriangle.reserve(meshFaceCount);
         for (int i = 0; i < meshFaceCount; ++i) {
             const Dxf_VERTEX& face = vertices.at(meshVertexCount + i);
             const auto meshVertex1 = std::abs(face.polyfaceMeshVertex1);
             const auto meshVertex2 = std::abs(face.polyfaceMeshVertex2);
             const auto meshVertex3 = std::abs(face.polyfaceMeshVertex3);
             const auto meshVertex4 = std::abs(face.polyfaceMeshVertex4);
-            vecTriangle.emplace_back(meshVertex1, meshVertex2, meshVertex3);
+            record.vecTriangle.emplace_back(meshVertex1, meshVertex2, meshVertex3);
             if (meshVertex4 != 0 && meshVertex3 != meshVertex4)
-                vecTriangle.emplace_back(meshVertex1, meshVertex3, meshVertex4);
+                record.vecTriangle.emplace_back(meshVertex1, meshVertex3, meshVertex4);
         }
-
-        Poly_Array1OfTriangle triangles(1, static_cast<int>(vecTriangle.size()));
-        for (unsigned i = 0; i < vecTriangle.size(); ++i)
-            triangles.ChangeValue(i + 1) = vecTriangle.at(i);
-
-        this->addShape(BRepUtils::makeFace(new Poly_Triangulation(nodes, triangles)));
     }
     else {
-        const bool isPolylineClosed = polyline.flags & Dxf_POLYLINE::Flag::Closed;
-        const int nodeCount = CppUtils::safeStaticCast<int>(vertices.size() + (isPolylineClosed ? 1 : 0));
-        MeshUtils::Polygon3dBuilder polygonBuilder(nodeCount);
-        for (unsigned i = 0; i < vertices.size(); ++i)
-            polygonBuilder.setNode(i + 1, this->toPnt(vertices.at(i).point));
-
-        if (isPolylineClosed)
-            polygonBuilder.setNode(nodeCount, this->toPnt(vertices.at(0).point));
-
-        polygonBuilder.finalize();
-        this->addShape(BRepUtils::makeEdge(polygonBuilder.get()));
+        record.isClosed = polyline.flags & Dxf_POLYLINE::Flag::Closed;
+        record.vecNode.reserve(vertices.size());
+        for (const Dxf_VERTEX& vertex : vertices)
+            record.vecNode.push_back(this->toPnt(vertex.point));
     }
+
+    this->addRecord(std::move(record));
 }
 
 void DxfReader::Internal::OnReadPoint(const DxfCoords& s)
@@ -487,12 +641,9 @@ void DxfReader::Internal::OnReadText(const Dxf_TEXT& text)
         fontName.replace(5, 1, " ");
 
     const double fontHeight = 1.4 * text.height * m_params.scaling;
-    Font_BRepFont brepFont;
-    brepFont.SetWidthScaling(static_cast<float>(text.relativeXScaleFactorWidth));
-    if (!brepFont.Init(fontName.c_str(), Font_FA_Regular, fontHeight/*, Font_StrictLevel_Aliases*/)) {
-        m_messenger->emitWarning(fmt::format("Font_BRepFont is null for '{}'", fontName));
+    const OccHandle<Font_BRepFont> brepFont = this->findFont(fontName, fontHeight, text.relativeXScaleFactorWidth);
+    if (!brepFont)
         return;
-    }
 
     using DxfHJustification = Dxf_TEXT::HorizontalJustification;
     using DxfVJustification = Dxf_TEXT::VerticalJustification;
@@ -550,11 +701,13 @@ void DxfReader::Internal::OnReadText(const Dxf_TEXT& text)
         xAxisDir = gp::DX().Transformed(rotTrsf);
     }
 
-    const gp_Ax3 locText(pt, extDir, xAxisDir);
-    Font_BRepTextBuilder brepTextBuilder;
-    const auto occTextStr = string_conv<NCollection_String>(text.str);
-    const TopoDS_Shape shapeText = brepTextBuilder.Perform(brepFont, occTextStr, locText, hAlign, vAlign);
-    this->addShape(shapeText);
+    TextRecord record;
+    record.font = brepFont;
+    record.str = string_conv<NCollection_String>(text.str);
+    record.location = gp_Ax3(pt, extDir, xAxisDir);
+    record.hAlign = hAlign;
+    record.vAlign = vAlign;
+    this->addRecord(std::move(record));
 }
 
 void DxfReader::Internal::OnReadMText(const Dxf_MTEXT& text)
@@ -569,11 +722,9 @@ void DxfReader::Internal::OnReadMText(const Dxf_MTEXT& text)
 
     const std::string& fontName = m_params.fontNameForTextObjects;
     const double fontHeight = 1.4 * text.height * m_params.scaling;
-    Font_BRepFont brepFont;
-    if (!brepFont.Init(fontName.c_str(), Font_FA_Regular, fontHeight)) {
-        m_messenger->emitWarning(fmt::format("Font_BRepFont is null for '{}'", fontName));
+    const OccHandle<Font_BRepFont> brepFont = this->findFont(fontName, fontHeight);
+    if (!brepFont)
         return;
-    }
 
     const int ap = static_cast<int>(text.attachmentPoint);
     Graphic3d_HorizontalTextAlignment hAlign = Graphic3d_HTA_LEFT;
@@ -609,26 +760,14 @@ void DxfReader::Internal::OnReadMText(const Dxf_MTEXT& text)
         xAxisDir = gp::DX().Transformed(rotTrsf);
     }
 
-    const auto occTextStr = string_conv<NCollection_String>(text.str);
-    const gp_Ax3 locText(pt, extDir, xAxisDir);
-    Font_BRepTextBuilder brepTextBuilder;
-#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
-    auto textFormat = makeOccHandle<Font_TextFormatter>();
-    textFormat->SetupAlignment(hAlign, vAlign);
-    textFormat->Append(occTextStr, *brepFont.FTFont());
-    /* Font_TextFormatter computes weird ResultWidth() so wrapping is currently broken
-    if (text.acadHasColumnInfo && text.acadColumnInfo_Width > 0.) {
-        textFormat->SetWordWrapping(true);
-        textFormat->SetWrapping(text.acadColumnInfo_Width);
-    }
-    */
-    textFormat->Format();
-    const TopoDS_Shape shapeText = brepTextBuilder.Perform(brepFont, textFormat, locText);
-#else
-    const TopoDS_Shape shapeText = brepTextBuilder.Perform(brepFont, occTextStr, locText, hAlign, vAlign);
-#endif
-
-    this->addShape(shapeText);
+    TextRecord record;
+    record.font = brepFont;
+    record.str = string_conv<NCollection_String>(text.str);
+    record.location = gp_Ax3(pt, extDir, xAxisDir);
+    record.hAlign = hAlign;
+    record.vAlign = vAlign;
+    record.useTextFormatter = true;
+    this->addRecord(std::move(record));
 }
 
 // Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
@@ -640,8 +779,7 @@ void DxfReader::Internal::OnReadArc(const DxfCoords& s, const DxfCoords& e, cons
     const gp_Pnt pc = this->toPnt(c);
     const gp_Circ circle(gp_Ax2(pc, up), p0.Distance(pc));
     if (circle.Radius() > 0) {
-        const TopoDS_Edge edge = BRepBuilderAPI_MakeEdge(circle, p0, p1);
-        this->addShape(edge);
+        this->addRecord(CircleRecord{ circle, std::make_pair(p0, p1) });
     }
     else {
         m_messenger->emitWarning("DxfReader - Ignore degenerate arc of circle");
@@ -656,8 +794,7 @@ void DxfReader::Internal::OnReadCircle(const DxfCoords& s, const DxfCoords& c, b
     const gp_Pnt pc = this->toPnt(c);
     const gp_Circ circle(gp_Ax2(pc, up), p0.Distance(pc));
     if (circle.Radius() > 0) {
-        const TopoDS_Edge edge = BRepBuilderAPI_MakeEdge(circle);
-        this->addShape(edge);
+        this->addRecord(CircleRecord{ circle, std::nullopt });
     }
     else {
         m_messenger->emitWarning("DxfReader - Ignore degenerate circle");
@@ -681,8 +818,7 @@ void DxfReader::Internal::OnReadEllipse(
                 minor_radius * m_params.scaling);
     ellipse.Rotate(gp_Ax1(pc, up), rotation);
     if (ellipse.MinorRadius() > 0) {
-        const TopoDS_Edge edge = BRepBuilderAPI_MakeEdge(ellipse);
-        this->addShape(edge);
+        this->addRecord(EllipseRecord{ ellipse });
     }
     else {
         m_messenger->emitWarning("DxfReader - Ignore degenerate ellipse");
@@ -692,86 +828,66 @@ void DxfReader::Internal::OnReadEllipse(
 // Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
 void DxfReader::Internal::OnReadSpline(const Dxf_SPLINE& spline)
 {
-    // https://documentation.help/AutoCAD-DXF/WS1a9193826455f5ff18cb41610ec0a2e719-79e1.htm
-    try {
-        OccHandle<Geom_BSplineCurve> geom;
-        if (!spline.controlPoints.empty())
-            geom = createSplineFromPolesAndKnots(spline);
-        else if (!spline.fitPoints.empty())
-            geom = createInterpolationSpline(spline);
-
-        if (geom.IsNull())
-            throw Standard_Failure("Geom_BSplineCurve object is null");
+    // Only data used by createSplineFromPolesAndKnots() or createInterpolationSpline() is recorded
+    auto fnToPnts = [](const std::vector<DxfCoords>& vecCoords) {
+        std::vector<gp_Pnt> vecPnt;
+        vecPnt.reserve(vecCoords.size());
+        for (const DxfCoords& coords : vecCoords)
+            vecPnt.emplace_back(coords.x, coords.y, coords.z);
+
+        return vecPnt;
+    };
 
-        const TopoDS_Edge edge = BRepBuilderAPI_MakeEdge(geom);
-        this->addShape(edge);
+    SplineRecord record;
+    record.degree = spline.degree;
+    record.isPeriodic = (spline.flags & Dxf_SPLINE::Periodic) != 0;
+    if (!spline.controlPoints.empty()) {
+        record.vecPole = fnToPnts(spline.controlPoints);
+        record.vecKnot = spline.knots;
+        record.vecWeight = spline.weights;
     }
-    catch (const Standard_Failure& err) {
-#ifdef MAYO_IO_DXF_DEBUG_TRACE
-        std::cout << "ERROR DxfReader::OnReadSpline() -- " << err.GetMessageString() << std::endl;
-#endif
-        m_messenger->emitWarning(
-            fmt::format("DxfReader - Failed to create bspline({})", err.GetMessageString())
-        );
+    else {
+        record.vecFitPoint = fnToPnts(spline.fitPoints);
     }
+
+    this->addRecord(std::move(record));
 }
 
 // Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
 void DxfReader::Internal::OnReadInsert(const Dxf_INSERT& ins)
 {
-    const std::string prefix = "BLOCKS " + ins.blockName + " ";
-    for (const auto& [k, vecEntity] : m_layers) {
-        if (!startsWith(k, prefix))
-            continue; // Skip
-
-        TopoDS_Shape comp = BRepUtils::makeEmptyCompound();
-        for (const DxfReader::Entity& entity : vecEntity) {
-            if (!entity.shape.IsNull())
-                BRepUtils::addShape(&comp, entity.shape);
-        }
-
-        if (comp.IsNull())
-            continue; // Skip
-
-        if (!MathUtils::fuzzyEqual(ins.scaleFactor.x, ins.scaleFactor.y)
-            || !MathUtils::fuzzyEqual(ins.scaleFactor.x, ins.scaleFactor.y)
-           )
-        {
-            m_messenger->emitWarning(
-                fmt::format("OnReadInsert('{}') - non-uniform scales aren't supported({}, {}, {})",
-                            ins.blockName, ins.scaleFactor.x, ins.scaleFactor.y, ins.scaleFactor.z
-                )
-            );
-        }
-
-        auto fnNonNull = [](double v) { return !MathUtils::fuzzyIsNull(v) ? v : 1.; };
-        const double avgScale = std::abs(fnNonNull((ins.scaleFactor.x + ins.scaleFactor.y + ins.scaleFactor.z) / 3.));
-        if (!MathUtils::fuzzyEqual(avgScale, 1.)) {
-            gp_Trsf trsf;
-            trsf.SetScaleFactor(avgScale);
-            BRepBuilderAPI_Transform brepTrsf(comp, trsf);
-            if (brepTrsf.IsDone()) {
-                comp = brepTrsf.Shape();
-            }
-            else {
-                m_messenger->emitWarning(
-                    fmt::format("OnReadInsert('{}') - scaling failed({}, {}, {})",
-                                ins.blockName, ins.scaleFactor.x, ins.scaleFactor.y, ins.scaleFactor.z
-                    )
-                );
-            }
-        }
-
-        gp_Trsf trsfRotZ;
-        if (!MathUtils::fuzzyIsNull(ins.rotationAngle))
-            trsfRotZ.SetRotation(gp::OZ(), ins.rotationAngle);
+    if (!MathUtils::fuzzyEqual(ins.scaleFactor.x, ins.scaleFactor.y)
+        || !MathUtils::fuzzyEqual(ins.scaleFactor.x, ins.scaleFactor.z)
+       )
+    {
+        m_messenger->emitWarning(
+            fmt::format("OnReadInsert('{}') - non-uniform scales aren't supported({}, {}, {})",
+                        ins.blockName, ins.scaleFactor.x, ins.scaleFactor.y, ins.scaleFactor.z
+            )
+        );
+    }
 
-        gp_Trsf trsfMove;
-        trsfMove.SetTranslation(this->toPnt(ins.insertPoint).XYZ());
+    auto fnNonNull = [](double v) { return !MathUtils::fuzzyIsNull(v) ? v : 1.; };
+    const double avgScale = std::abs(fnNonNull((ins.scaleFactor.x + ins.scaleFactor.y + ins.scaleFactor.z) / 3.));
+    const int blockShapeIndex = this->findBlockShape(ins.blockName, avgScale);
+    if (blockShapeIndex < 0)
+        return;
 
-        comp.Location(trsfRotZ * trsfMove);
-        this->addShape(comp);
-    }
+    gp_Trsf trsfRotZ;
+    if (!MathUtils::fuzzyIsNull(ins.rotationAngle))
+        trsfRotZ.SetRotation(gp::OZ(), ins.rotationAngle);
+
+    gp_Trsf trsfMove;
+    trsfMove.SetTranslation(this->toPnt(ins.insertPoint).XYZ());
+
+    // Block shape isn't copied, the insert only refers to it with some location
+    const TopLoc_Location location(trsfRotZ * trsfMove);
+    DxfReader::Entity entity;
+    entity.aci = m_ColorIndex;
+    entity.shape = m_vecBlockShape.at(blockShapeIndex).shape.Located(location);
+    entity.blockShapeIndex = blockShapeIndex;
+    entity.location = location;
+    this->addEntity(entity);
 }
 
 void DxfReader::Internal::OnReadDimension(const DxfCoords& s, const DxfCoords& e, const DxfCoords& point, double rotation)
@@ -844,7 +960,20 @@ gp_Pnt DxfReader::Internal::toPnt(const DxfCoords& coords) const
 
 void DxfReader::Internal::addShape(const TopoDS_Shape& shape)
 {
-    const Entity newEntity{ m_ColorIndex, shape };
+    DxfReader::Entity newEntity;
+    newEntity.aci = m_ColorIndex;
+    newEntity.shape = shape;
+    this->addEntity(newEntity);
+}
+
+void DxfReader::Internal::addEntity(const DxfReader::Entity& newEntity)
+{
+    // Entities of block definitions are indexed by block name, for fast lookup by inserts
+    if (this->SectionName() == "BLOCKS" && !this->BlockName().empty()) {
+        m_mapBlock[this->BlockName()].vecEntity.push_back(newEntity);
+        return;
+    }
+
     const std::string layerName = this->LayerName();
     auto itFound = m_layers.find(layerName);
     if (itFound != m_layers.end()) {
@@ -857,6 +986,235 @@ void DxfReader::Internal::addShape(const TopoDS_Shape& shape)
     }
 }
 
+OccHandle<Font_BRepFont> DxfReader::Internal::findFont(const std::string& fontName, double height, double widthScaling)
+{
+    auto key = std::make_tuple(fontName, height, widthScaling);
+    auto itFont = m_mapFont.find(key);
+    if (itFont != m_mapFont.end())
+        return itFont->second;
+
+    auto brepFont = makeOccHandle<Font_BRepFont>();
+    brepFont->SetWidthScaling(static_cast<float>(widthScaling));
+    if (!brepFont->Init(fontName.c_str(), Font_FA_Regular, height/*, Font_StrictLevel_Aliases*/)) {
+        m_messenger->emitWarning(fmt::format("Font_BRepFont is null for '{}'", fontName));
+        brepFont.Nullify(); // Cached anyway, so initialization isn't tried again for next texts
+    }
+
+    m_mapFont.insert({ std::move(key), brepFont });
+    return brepFont;
+}
+
+void DxfReader::Internal::addRecord(ShapeRecord record)
+{
+    // Shapes of block entities are required by INSERT entities during parsing, so they can't be
+    // deferred
+    const bool isBlockEntity = this->SectionName() == "BLOCKS" && !this->BlockName().empty();
+    if (!m_params.parallelBuild || isBlockEntity) {
+        std::string strError;
+        const TopoDS_Shape shape = this->buildShape(record, &strError);
+        if (strError.empty())
+            this->addShape(shape);
+        else
+            m_messenger->emitWarning(strError);
+
+        return;
+    }
+
+    // Add entity with null shape for now
+    this->addShape(TopoDS_Shape());
+    std::vector<DxfReader::Entity>& vecEntity = m_layers.at(this->LayerName());
+    m_vecDeferredShape.push_back({ std::move(record), &vecEntity, vecEntity.size() - 1 });
+}
+
+TopoDS_Shape DxfReader::Internal::buildShape(const ShapeRecord& record, std::string* ptrError) const
+{
+    if (auto line = std::get_if<LineRecord>(&record)) {
+        if (m_params.lightweightLines) {
+            MeshUtils::Polygon3dBuilder polygonBuilder(2);
+            polygonBuilder.setNode(1, line->p0);
+            polygonBuilder.setNode(2, line->p1);
+            polygonBuilder.finalize();
+            return BRepUtils::makeEdge(polygonBuilder.get());
+        }
+
+        return BRepBuilderAPI_MakeEdge(line->p0, line->p1).Edge();
+    }
+
+    if (auto polyline = std::get_if<PolylineRecord>(&record)) {
+        const std::vector<gp_Pnt>& vecNode = polyline->vecNode;
+        if (polyline->isPolyfaceMesh) {
+            TColgp_Array1OfPnt nodes(1, CppUtils::safeStaticCast<int>(vecNode.size()));
+            std::copy(vecNode.cbegin(), vecNode.cend(), nodes.begin());
+            const std::vector<Poly_Triangle>& vecTriangle = polyline->vecTriangle;
+            Poly_Array1OfTriangle triangles(1, CppUtils::safeStaticCast<int>(vecTriangle.size()));
+            std::copy(vecTriangle.cbegin(), vecTriangle.cend(), triangles.begin());
+            return BRepUtils::makeFace(new Poly_Triangulation(nodes, triangles));
+        }
+        else {
+            const int nodeCount = CppUtils::safeStaticCast<int>(vecNode.size() + (polyline->isClosed ? 1 : 0));
+            MeshUtils::Polygon3dBuilder polygonBuilder(nodeCount);
+            for (unsigned i = 0; i < vecNode.size(); ++i)
+                polygonBuilder.setNode(i + 1, vecNode.at(i));
+
+            if (polyline->isClosed)
+                polygonBuilder.setNode(nodeCount, vecNode.at(0));
+
+            polygonBuilder.finalize();
+            return BRepUtils::makeEdge(polygonBuilder.get());
+        }
+    }
+
+    if (auto circle = std::get_if<CircleRecord>(&record)) {
+        if (circle->arcEnds)
+            return BRepBuilderAPI_MakeEdge(circle->circle, circle->arcEnds->first, circle->arcEnds->second).Edge();
+        else
+            return BRepBuilderAPI_MakeEdge(circle->circle).Edge();
+    }
+
+    if (auto ellipse = std::get_if<EllipseRecord>(&record))
+        return BRepBuilderAPI_MakeEdge(ellipse->ellipse).Edge();
+
+    if (auto spline = std::get_if<SplineRecord>(&record)) {
+        // https://documentation.help/AutoCAD-DXF/WS1a9193826455f5ff18cb41610ec0a2e719-79e1.htm
+        try {
+            OccHandle<Geom_BSplineCurve> geom;
+            if (!spline->vecPole.empty())
+                geom = createSplineFromPolesAndKnots(*spline);
+            else if (!spline->vecFitPoint.empty())
+                geom = createInterpolationSpline(*spline);
+
+            if (geom.IsNull())
+                throw Standard_Failure("Geom_BSplineCurve object is null");
+
+            return BRepBuilderAPI_MakeEdge(geom).Edge();
+        }
+        catch (const Standard_Failure& err) {
+#ifdef MAYO_IO_DXF_DEBUG_TRACE
+            std::cout << "ERROR DxfReader::OnReadSpline() -- " << err.GetMessageString() << std::endl;
+#endif
+            *ptrError = fmt::format("DxfReader - Failed to create bspline({})", err.GetMessageString());
+            return {};
+        }
+    }
+
+    if (auto text = std::get_if<TextRecord>(&record)) {
+        Font_BRepTextBuilder brepTextBuilder;
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+        if (text->useTextFormatter) {
+            auto textFormat = makeOccHandle<Font_TextFormatter>();
+            textFormat->SetupAlignment(text->hAlign, text->vAlign);
+            textFormat->Append(text->str, *text->font->FTFont());
+            /* Font_TextFormatter computes weird ResultWidth() so wrapping is currently broken
+            if (text.acadHasColumnInfo && text.acadColumnInfo_Width > 0.) {
+                textFormat->SetWordWrapping(true);
+                textFormat->SetWrapping(text.acadColumnInfo_Width);
+            }
+            */
+            textFormat->Format();
+            return brepTextBuilder.Perform(*text->font, textFormat, text->location);
+        }
+#endif
+        return brepTextBuilder.Perform(*text->font, text->str, text->location, text->hAlign, text->vAlign);
+    }
+
+    return {};
+}
+
+void DxfReader::Internal::buildDeferredShapes(TaskProgress* progress)
+{
+    if (m_vecDeferredShape.empty())
+        return;
+
+    progress = progress ? progress : &TaskProgress::null();
+    const int count = CppUtils::safeStaticCast<int>(m_vecDeferredShape.size());
+    std::vector<TopoDS_Shape> vecShape(count);
+    std::vector<std::string> vecError(count);
+    std::atomic<int> builtCount = 0;
+    auto fnBuild = [&](int i) {
+        if (progress->isAbortRequested())
+            return;
+
+        vecShape.at(i) = this->buildShape(m_vecDeferredShape.at(i).record, &vecError.at(i));
+        progress->setValue(MathUtils::toPercent(++builtCount, 0, count));
+    };
+
+    // Texts are grouped by font, other entities are independent of each other
+    std::unordered_map<const Font_BRepFont*, std::vector<int>> mapFontTexts;
+    for (int i = 0; i < count; ++i) {
+        const auto text = std::get_if<TextRecord>(&m_vecDeferredShape.at(i).record);
+        if (text)
+            mapFontTexts[text->font.get()].push_back(i);
+    }
+
+    OSD_Parallel::For(0, count, [&](int i) {
+        if (!std::holds_alternative<TextRecord>(m_vecDeferredShape.at(i).record))
+            fnBuild(i);
+    });
+
+    std::vector<const std::vector<int>*> vecFontTexts;
+    for (const auto& [font, vecIndex] : mapFontTexts)
+        vecFontTexts.push_back(&vecIndex);
+
+    OSD_Parallel::For(0, static_cast<int>(vecFontTexts.size()), [&](int iFont) {
+        for (int i : *vecFontTexts.at(iFont))
+            fnBuild(i);
+    });
+
+    // Assign shapes to entities and report errors, in parsing order
+    for (int i = 0; i < count; ++i) {
+        const DeferredShape& deferred = m_vecDeferredShape.at(i);
+        deferred.ptrVecEntity->at(deferred.entityIndex).shape = vecShape.at(i);
+        if (!vecError.at(i).empty())
+            m_messenger->emitWarning(vecError.at(i));
+    }
+
+    m_vecDeferredShape.clear();
+}
+
+int DxfReader::Internal::findBlockShape(const std::string& blockName, double scale)
+{
+    auto itBlock = m_mapBlock.find(blockName);
+    if (itBlock == m_mapBlock.end())
+        return -1;
+
+    Block& block = itBlock->second;
+    for (const auto& [blockScale, index] : block.vecScaledShapeIndex) {
+        if (MathUtils::fuzzyEqual(blockScale, scale))
+            return index;
+    }
+
+    TopoDS_Shape comp = BRepUtils::makeEmptyCompound();
+    bool isEmpty = true;
+    for (const DxfReader::Entity& entity : block.vecEntity) {
+        if (!entity.shape.IsNull()) {
+            BRepUtils::addShape(&comp, entity.shape);
+            isEmpty = false;
+        }
+    }
+
+    if (isEmpty)
+        return -1;
+
+    if (!MathUtils::fuzzyEqual(scale, 1.)) {
+        gp_Trsf trsf;
+        trsf.SetScaleFactor(scale);
+        BRepBuilderAPI_Transform brepTrsf(comp, trsf);
+        if (brepTrsf.IsDone()) {
+            comp = brepTrsf.Shape();
+        }
+        else {
+            m_messenger->emitWarning(
+                fmt::format("OnReadInsert('{}') - scaling failed({})", blockName, scale)
+            );
+        }
+    }
+
+    const int index = CppUtils::safeStaticCast<int>(m_vecBlockShape.size());
+    m_vecBlockShape.push_back({ blockName, comp });
+    block.vecScaledShapeIndex.push_back({ scale, index });
+    return index;
+}
+
 TopoDS_Face DxfReader::Internal::makeFace(const Dxf_QuadBase& quad) const
 {
     const gp_Pnt p1 = this->toPnt(quad.corner1);
@@ -887,25 +1245,22 @@ TopoDS_Face DxfReader::Internal::makeFace(const Dxf_QuadBase& quad) const
 }
 
 // Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
-OccHandle<Geom_BSplineCurve> DxfReader::Internal::createSplineFromPolesAndKnots(const Dxf_SPLINE& spline)
+OccHandle<Geom_BSplineCurve> DxfReader::Internal::createSplineFromPolesAndKnots(const SplineRecord& spline)
 {
-    if (spline.weights.size() > spline.controlPoints.size())
+    if (spline.vecWeight.size() > spline.vecPole.size())
         return {};
 
-    const bool isPeriodic = (spline.flags & Dxf_SPLINE::Periodic) != 0;
+    const bool isPeriodic = spline.isPeriodic;
 
     // Handle poles
-    const auto iNumPoles = CppUtils::safeStaticCast<int>(spline.controlPoints.size());
+    const auto iNumPoles = CppUtils::safeStaticCast<int>(spline.vecPole.size());
     TColgp_Array1OfPnt occPoles(1, iNumPoles);
-    for (const DxfCoords& pnt : spline.controlPoints) {
-        const auto iPnt = CppUtils::safeStaticCast<int>(&pnt - &spline.controlPoints.front());
-        occPoles.ChangeValue(iPnt + 1) = gp_Pnt{pnt.x, pnt.y, pnt.z};
-    }
+    std::copy(spline.vecPole.cbegin(), spline.vecPole.cend(), occPoles.begin());
 
     // Handle knots and mults
-    const auto iNumKnots = CppUtils::safeStaticCast<int>(spline.knots.size());
+    const auto iNumKnots = CppUtils::safeStaticCast<int>(spline.vecKnot.size());
     TColStd_Array1OfReal occKnots(1, iNumKnots);
-    std::copy(spline.knots.cbegin(), spline.knots.cend(), occKnots.begin());
+    std::copy(spline.vecKnot.cbegin(), spline.vecKnot.cend(), occKnots.begin());
 
     const auto iNumUniqueKnots = BSplCLib::KnotsLength(occKnots, isPeriodic);
     TColStd_Array1OfReal occUniqueKnots(1, iNumUniqueKnots);
@@ -914,8 +1269,8 @@ OccHandle<Geom_BSplineCurve> DxfReader::Internal::createSplineFromPolesAndKnots(
 
     // Handle weights
     TColStd_Array1OfReal occWeights(1, iNumPoles);
-    if (spline.weights.size() == spline.controlPoints.size())
-        std::copy(spline.weights.cbegin(), spline.weights.cend(), occWeights.begin());
+    if (spline.vecWeight.size() == spline.vecPole.size())
+        std::copy(spline.vecWeight.cbegin(), spline.vecWeight.cend(), occWeights.begin());
     else
         std::fill(occWeights.begin(), occWeights.end(), 1.); // Non-rational
 
@@ -923,7 +1278,6 @@ OccHandle<Geom_BSplineCurve> DxfReader::Internal::createSplineFromPolesAndKnots(
     // Debug traces
     std::cout << std::endl << "createSplineFromPolesAndKnots()";
     std::cout << "\n    degree: " << spline.degree;
-    std::cout << "\n    flags: " << spline.flags;
     std::cout << "\n    isPeriodic: " << isPeriodic;
     std::cout << "\n    numPoles: " << iNumPoles;
 
@@ -941,8 +1295,6 @@ OccHandle<Geom_BSplineCurve> DxfReader::Internal::createSplineFromPolesAndKnots(
     for (int mult : occMults)
         std::cout << mult << ", ";
 
-    std::cout << "\n    numStartTangents: " << spline.startTangents.size();
-    std::cout << "\n    numEndTangents: " << spline.endTangents.size();
     std::cout << "\n    BSplCLib::NbPoles(): " << BSplCLib::NbPoles(spline.degree, isPeriodic, occMults);
     std::cout << std::endl;
 #endif
@@ -951,19 +1303,15 @@ OccHandle<Geom_BSplineCurve> DxfReader::Internal::createSplineFromPolesAndKnots(
 }
 
 // Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
-OccHandle<Geom_BSplineCurve> DxfReader::Internal::createInterpolationSpline(const Dxf_SPLINE& spline)
+OccHandle<Geom_BSplineCurve> DxfReader::Internal::createInterpolationSpline(const SplineRecord& spline)
 {
-    const auto iNumPoints = CppUtils::safeStaticCast<int>(spline.fitPoints.size());
+    const auto iNumPoints = CppUtils::safeStaticCast<int>(spline.vecFitPoint.size());
 
     // Handle poles
     auto fitpoints = makeOccHandle<TColgp_HArray1OfPnt>(1, iNumPoints);
-    for (const DxfCoords& pnt : spline.fitPoints) {
-        const auto iPnt = CppUtils::safeStaticCast<int>(&pnt - &spline.fitPoints.front());
-        fitpoints->ChangeValue(iPnt + 1) = gp_Pnt{pnt.x, pnt.y, pnt.z};
-    }
+    std::copy(spline.vecFitPoint.cbegin(), spline.vecFitPoint.cend(), fitpoints->ChangeArray1().begin());
 
-    const bool isPeriodic = (spline.flags & Dxf_SPLINE::Periodic) != 0;
-    GeomAPI_Interpolate interp(fitpoints, isPeriodic, Precision::Confusion());
+    GeomAPI_Interpolate interp(fitpoints, spline.isPeriodic, Precision::Confusion());
     interp.Perform();
     return interp.Curve();
 }
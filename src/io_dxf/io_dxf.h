@@ -9,6 +9,7 @@
 #include "../base/io_reader.h"
 #include "../base/io_single_format_factory.h"
 
+#include <TopLoc_Location.hxx>
 #include <TopoDS_Shape.hxx>
 #include <unordered_map>
 #include <string>
@@ -28,6 +29,8 @@ public:
         bool importAnnotations = true;
         bool groupLayers = true;
         std::string fontNameForTextObjects = "Arial";
+        bool parallelBuild = true;
+        bool lightweightLines = false;
     };
     Parameters& parameters() { return m_params; }
     const Parameters& constParameters() const { return m_params; }
@@ -42,8 +45,18 @@ private:
     struct Entity {
         int aci = 0;
         TopoDS_Shape shape;
+        int blockShapeIndex = -1; // Index in m_vecBlockShape if entity is a block insert
+        TopLoc_Location location; // Placement of the block insert
     };
+
+    // Shape of a block definition, shared by all the inserts of the block(with same scaling)
+    struct BlockShape {
+        std::string name;
+        TopoDS_Shape shape;
+    };
+
     std::unordered_map<std::string, std::vector<Entity>> m_layers;
+    std::vector<BlockShape> m_vecBlockShape;
     Parameters m_params;
 };
 
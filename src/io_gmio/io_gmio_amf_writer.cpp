@@ -10,14 +10,17 @@
 #include "../base/brep_utils.h"
 #include "../base/caf_utils.h"
 #include "../base/cpp_utils.h"
+#include "../base/io_system.h"
 #include "../base/triangulation_annex_data.h"
 #include "../base/math_utils.h"
 #include "../base/mesh_access.h"
+#include "../base/messenger.h"
 #include "../base/meta_enum.h"
 #include "../base/property_builtins.h"
 #include "../base/property_enumeration.h"
 #include "../base/string_conv.h"
 #include "../base/task_progress.h"
+#include "../base/text_id.h"
 #include "../base/unit_system.h"
 #include "../base/xcaf.h"
 
@@ -121,6 +124,8 @@ IO::Result IO::exportStl_gmio(ExportData data)
 }
 #endif // MAYO_HAVE_GMIO
 
+struct GmioAmfWriterI18N { MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::GmioAmfWriterI18N) };
+
 } // namespace
 
 class GmioAmfWriter::Properties : public PropertyGroup {
@@ -193,6 +198,10 @@ bool GmioAmfWriter::transfer(Span<const ApplicationItem> spanAppItem, TaskProgre
     m_vecMesh.clear();
     m_vecObject.clear();
     m_vecInstance.clear();
+    if (!System::isDeepExpanded(spanAppItem)) {
+        this->messenger()->emitError(GmioAmfWriterI18N::textIdTr("Model tree isn't completely built, some instances would be missing"));
+        return false;
+    }
 
     Material defaultMaterial = {};
     defaultMaterial.id = 0;
@@ -205,7 +214,8 @@ bool GmioAmfWriter::transfer(Span<const ApplicationItem> spanAppItem, TaskProgre
         auto it = mapLabelObjectId.find(label);
         return it != mapLabelObjectId.cend() ? it->second : -1;
     };
-    auto fnCreateObject = [&](const Tree<TDF_Label>& modelTree, TreeNodeId id) {
+    auto fnCreateObject = [&](const DocumentPtr& doc, TreeNodeId id) {
+        const Tree<TDF_Label>& modelTree = doc->modelTree();
         const TDF_Label nodeLabel = modelTree.nodeData(id);
         if (modelTree.nodeIsLeaf(id)) {
             int objectId = fnFindObjectId(nodeLabel);
@@ -234,7 +244,7 @@ bool GmioAmfWriter::transfer(Span<const ApplicationItem> spanAppItem, TaskProgre
                 absoluteName.erase(0, 1); // Remove starting '/'
                 Instance instance;
                 instance.objectId = objectId;
-                instance.trsf = XCaf::shapeAbsoluteLocation(modelTree, id);
+                instance.trsf = doc->modelTreeNodeAbsoluteLocation(id);
                 instance.name = absoluteName;
                 m_vecInstance.push_back(std::move(instance));
             }
@@ -244,13 +254,14 @@ bool GmioAmfWriter::transfer(Span<const ApplicationItem> spanAppItem, TaskProgre
     for (const ApplicationItem& appItem : spanAppItem) {
         const auto appItemIndex = &appItem - &spanAppItem.front();
         progress->setValue(MathUtils::toPercent(appItemIndex, 0, spanAppItem.size() - 1));
-        const Tree<TDF_Label>& modelTree = appItem.document()->modelTree();
+        const DocumentPtr doc = appItem.document();
+        const Tree<TDF_Label>& modelTree = doc->modelTree();
         if (appItem.isDocument()) {
-            traverseTree(modelTree, [&](TreeNodeId id) { fnCreateObject(modelTree, id); });
+            traverseTree(modelTree, [&](TreeNodeId id) { fnCreateObject(doc, id); });
         }
         else if (appItem.isDocumentTreeNode()) {
             traverseTree(appItem.documentTreeNode().id(), modelTree, [&](TreeNodeId id) {
-                fnCreateObject(modelTree, id);
+                fnCreateObject(doc, id);
             });
         }
     }
@@ -81,12 +81,86 @@ bool cafGenericWriteTransfer(CafWriterType& writer, Span<const ApplicationItem>
 
 namespace Private {
 
-std::mutex& cafGlobalMutex()
+void CafGlobalMutex::lock()
 {
-    static std::mutex mutex;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    ++m_exclusiveWaitingCount;
+    m_cond.wait(lock, [=]{ return !m_exclusiveOwned && m_sharedOwnerCount == 0; });
+    --m_exclusiveWaitingCount;
+    m_exclusiveOwned = true;
+}
+
+void CafGlobalMutex::unlock()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_exclusiveOwned = false;
+    }
+
+    m_cond.notify_all();
+}
+
+void CafGlobalMutex::lockShared(std::string_view staticVarsKey, const FunctionChangeStaticVariables& fnChangeStaticVars)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto fnCanOwn = [&]{
+        if (m_exclusiveOwned)
+            return false;
+
+        if (m_sharedOwnerCount == 0)
+            return true;
+
+        // Let pending exclusive owners go first, prevents their starvation
+        if (m_exclusiveWaitingCount > 0)
+            return false;
+
+        return staticVarsKey.empty()
+               || m_sharedStaticVarsKey.empty()
+               || staticVarsKey == m_sharedStaticVarsKey;
+    };
+    m_cond.wait(lock, fnCanOwn);
+    ++m_sharedOwnerCount;
+    if (!staticVarsKey.empty() && m_sharedStaticVarsKey.empty()) {
+        m_sharedStaticVarsKey = staticVarsKey;
+        m_sharedStaticVarsRollback = std::make_unique<OccStaticVariablesRollback>();
+        if (fnChangeStaticVars)
+            fnChangeStaticVars(m_sharedStaticVarsRollback.get());
+    }
+}
+
+void CafGlobalMutex::unlockShared()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_sharedOwnerCount;
+        if (m_sharedOwnerCount == 0) {
+            m_sharedStaticVarsRollback.reset(); // Restore static variables
+            m_sharedStaticVarsKey.clear();
+        }
+    }
+
+    m_cond.notify_all();
+}
+
+CafGlobalMutex& cafGlobalMutex()
+{
+    static CafGlobalMutex mutex;
     return mutex;
 }
 
+CafGlobalSharedLock::CafGlobalSharedLock(
+        std::string_view staticVarsKey,
+        const CafGlobalMutex::FunctionChangeStaticVariables& fnChangeStaticVars
+    )
+{
+    cafGlobalMutex().lockShared(staticVarsKey, fnChangeStaticVars);
+}
+
+CafGlobalSharedLock::~CafGlobalSharedLock()
+{
+    cafGlobalMutex().unlockShared();
+}
+
 OccHandle<XSControl_WorkSession> cafWorkSession(const STEPCAFControl_Reader& reader) {
     return reader.Reader().WS();
 }
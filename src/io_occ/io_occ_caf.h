@@ -13,11 +13,17 @@
 #include "../base/application_item.h"
 #include "../base/document_ptr.h"
 #include "../base/filepath.h"
+#include "../base/occ_static_variables_rollback.h"
 #include "../base/span.h"
 
 #include <Transfer_FinderProcess.hxx>
 #include <XSControl_WorkSession.hxx>
+#include <condition_variable>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <string_view>
 class IGESCAFControl_Reader;
 class STEPCAFControl_Reader;
 
@@ -31,10 +37,55 @@ class TaskProgress;
 namespace IO {
 namespace Private {
 
-std::mutex& cafGlobalMutex();
+// Mutex protecting OpenCascade global state used by CAF readers/writers(eg Interface_Static
+// variables)
+//
+// Exclusive ownership is provided by lock()/unlock()(so std::lock_guard can be used)
+// Shared ownership is provided by lockShared()/unlockShared(), shared owners can run concurrently
+// as long as they require the same values for the static variables. These values are applied by
+// the first shared owner and rolled back when the last shared owner releases the mutex
+class CafGlobalMutex {
+public:
+    // Function changing the OpenCascade static variables through some rollback object
+    using FunctionChangeStaticVariables = std::function<void(OccStaticVariablesRollback*)>;
+
+    void lock();
+    void unlock();
+
+    // 'staticVarsKey' identifies the values applied by 'fnChangeStaticVars'
+    // Empty 'staticVarsKey' means the owner doesn't depend on static variables and it's then
+    // compatible with any other shared owner
+    void lockShared(std::string_view staticVarsKey, const FunctionChangeStaticVariables& fnChangeStaticVars);
+    void unlockShared();
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_exclusiveOwned = false;
+    int m_exclusiveWaitingCount = 0;
+    int m_sharedOwnerCount = 0;
+    std::string m_sharedStaticVarsKey;
+    std::unique_ptr<OccStaticVariablesRollback> m_sharedStaticVarsRollback;
+};
+
+CafGlobalMutex& cafGlobalMutex();
+
+// Scoped shared ownership of cafGlobalMutex()
+class CafGlobalSharedLock {
+public:
+    CafGlobalSharedLock(
+        std::string_view staticVarsKey = {},
+        const CafGlobalMutex::FunctionChangeStaticVariables& fnChangeStaticVars = {}
+    );
+    ~CafGlobalSharedLock();
+
+    // Not copyable
+    CafGlobalSharedLock(const CafGlobalSharedLock&) = delete;
+    CafGlobalSharedLock& operator=(const CafGlobalSharedLock&) = delete;
+};
 
 #define MayoIO_CafGlobalScopedLock(name) \
-    [[maybe_unused]] std::lock_guard<std::mutex> name(Mayo::IO::Private::cafGlobalMutex());
+    [[maybe_unused]] std::lock_guard<Mayo::IO::Private::CafGlobalMutex> name(Mayo::IO::Private::cafGlobalMutex());
 
 OccHandle<XSControl_WorkSession> cafWorkSession(const IGESCAFControl_Reader& reader);
 OccHandle<XSControl_WorkSession> cafWorkSession(const STEPCAFControl_Reader& reader);
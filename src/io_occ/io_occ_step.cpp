@@ -22,6 +22,7 @@
 #include <Interface_Version.hxx>
 #include <STEPCAFControl_Controller.hxx>
 #include <fmt/format.h>
+#include <mutex>
 #include <stdexcept>
 
 namespace Mayo {
@@ -121,9 +122,14 @@ public:
 
 OccStepReader::OccStepReader()
 {
-    MayoIO_CafGlobalScopedLock(cafLock);
+    static std::once_flag initFlag;
+    std::call_once(initFlag, []{
+        MayoIO_CafGlobalScopedLock(cafLock);
+        STEPCAFControl_Controller::Init();
+    });
+
+    Private::CafGlobalSharedLock cafLock;
     m_reader = new(&m_readerStorage) STEPCAFControl_Reader();
-    STEPCAFControl_Controller::Init();
     m_reader->SetColorMode(true);
     m_reader->SetNameMode(true);
     m_reader->SetLayerMode(true);
@@ -140,9 +146,16 @@ OccStepReader::~OccStepReader()
 
 bool OccStepReader::readFile(const FilePath& filepath, TaskProgress* progress)
 {
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    // STEP parser is reentrant, so files read with identical parameters are parsed concurrently
+    Private::CafGlobalSharedLock cafLock(this->staticVariablesKey(), [=](OccStaticVariablesRollback* rollback) {
+        this->changeStaticVariables(rollback);
+    });
+#else
     MayoIO_CafGlobalScopedLock(cafLock);
     OccStaticVariablesRollback rollback;
     this->changeStaticVariables(&rollback);
+#endif
     return Private::cafReadFile(*m_reader, filepath, progress);
 }
 
@@ -172,6 +185,19 @@ void OccStepReader::applyProperties(const PropertyGroup* group)
     }
 }
 
+std::string OccStepReader::staticVariablesKey() const
+{
+    return fmt::format(
+        "step;{};{};{};{};{};{}",
+        int(m_params.productContext),
+        int(m_params.assemblyLevel),
+        int(m_params.preferredShapeRepresentation),
+        m_params.readShapeAspect,
+        m_params.readSubShapesNames,
+        int(m_params.encoding)
+    );
+}
+
 void OccStepReader::changeStaticVariables(OccStaticVariablesRollback* rollback) const
 {
     auto fnOccEncoding = [](Encoding code) {
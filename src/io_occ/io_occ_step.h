@@ -14,6 +14,7 @@
 #include <STEPCAFControl_Reader.hxx>
 #include <STEPCAFControl_Writer.hxx>
 
+#include <string>
 #include <type_traits>
 
 namespace Mayo {
@@ -99,6 +100,8 @@ public:
 
 private:
     void changeStaticVariables(OccStaticVariablesRollback* rollback) const;
+    // Identifies the values of static variables applied by changeStaticVariables()
+    std::string staticVariablesKey() const;
 
     class Properties;
     STEPCAFControl_Reader* m_reader = nullptr;
@@ -11,29 +11,21 @@
 #include "../base/cpp_utils.h"
 #include "../base/triangulation_annex_data.h"
 #include "../base/document.h"
+#include "../base/file_memory_map.h"
 #include "../base/filepath_conv.h"
-#include "../base/math_utils.h"
 #include "../base/mesh_utils.h"
 #include "../base/messenger.h"
-#include "../base/property_builtins.h"
-#include "../base/span.h"
 #include "../base/task_progress.h"
 #include "../base/tkernel_utils.h"
 
-#include <Quantity_Color.hxx>
-#include <Poly_Triangulation.hxx>
+#include <OSD_Parallel.hxx>
 #include <TDataStd_Name.hxx>
 
-#if __cpp_lib_to_chars
-#  include <charconv>
-#else
-#  include <cstdlib>
-#endif
-#include <array>
-#include <fstream>
-#include <locale>
-#include <string>
-#include <type_traits>
+#include <fast_float/fast_float.h>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <string_view>
 
 namespace Mayo {
 namespace IO {
@@ -42,126 +34,145 @@ struct OffReaderI18N { MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::OffReaderI18N) }
 
 namespace {
 
-const char* strEnd(std::string_view str)
-{
-    return str.data() + str.size();
-}
-
-std::string_view getWord(const std::string& strLine, std::string::size_type pos = 0)
-{
-    using IntType = std::string::size_type;
-    auto fnIsSpace = [](char ch) {
-        return std::isspace(ch, std::locale::classic());
-    };
+// Minimum size in bytes of a chunk of the OFF file body
+constexpr std::size_t MinChunkSize = 256 * 1024;
 
-    IntType wordStart = pos;
-    for (; wordStart < strLine.size() && fnIsSpace(strLine.at(wordStart)); ++wordStart);
+enum class ParseError {
+    None, NoVertexCoords, InconsistentFaceVertexCount, InvalidFaceVertexIndex
+};
 
-    IntType wordEnd = wordStart;
-    for (; wordEnd < strLine.size() && !fnIsSpace(strLine.at(wordEnd)) && strLine.at(wordEnd) != '#'; ++wordEnd);
+// Piece of the OFF file body made of complete lines
+struct BodyChunk {
+    std::string_view text;
+    int firstLineIndex = 0; // Index of the first data line, relative to the body
+    int lineCount = 0; // Count of data lines
+    int firstTriangleIndex = 0;
+    int triangleCount = 0;
+    ParseError error = ParseError::None;
+};
 
-    return std::string_view{ strLine.c_str() + wordStart, wordEnd - wordStart };
+bool isBlank(char ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\f' || ch == '\v';
 }
 
-template<unsigned N>
-std::array<std::string_view, N> getWords(const std::string& strLine, std::string::size_type pos = 0)
+// Returns the line starting at 'it'(without end-of-line character) and moves 'it' to the next line
+std::string_view nextLine(const char*& it, const char* end)
 {
-    std::array<std::string_view, N> arrayWord;
-    for (unsigned i = 0; i < N; ++i) {
-        const std::string::size_type offset = i > 0 ? strEnd(arrayWord[i - 1]) - strLine.data() : pos;
-        std::string_view word = getWord(strLine, offset);
-        if (!word.empty())
-            arrayWord[i] = word;
-        else
-            return arrayWord;
+    const char* lineStart = it;
+    auto eol = static_cast<const char*>(std::memchr(it, '\n', end - it));
+    if (eol) {
+        it = eol + 1;
+        return { lineStart, std::size_t(eol - lineStart) };
     }
 
-    return arrayWord;
+    it = end;
+    return { lineStart, std::size_t(end - lineStart) };
 }
 
-void getWords(const std::string& strLine, std::vector<std::string_view>& vecOutWord, std::string::size_type pos = 0)
+// Returns 'line' without leading blanks, or an empty string if 'line' doesn't contain data(ie it's
+// blank or a comment)
+std::string_view toDataLine(std::string_view line)
 {
-    vecOutWord.clear();
-    while (true) {
-        const std::string::size_type offset = !vecOutWord.empty() ? strEnd(vecOutWord.back()) - strLine.data() : pos;
-        std::string_view word = getWord(strLine, offset);
-        if (!word.empty())
-            vecOutWord.push_back(word);
-        else
-            return;
-    }
+    std::size_t pos = 0;
+    while (pos < line.size() && isBlank(line[pos]))
+        ++pos;
+
+    if (pos == line.size() || line[pos] == '#')
+        return {};
+
+    return line.substr(pos);
 }
 
-bool hasEmptyString(Span<const std::string_view> spanStr)
+// Finds the next data line starting at 'it'. Returns false if end is reached
+bool nextDataLine(const char*& it, const char* end, std::string_view* dataLine)
 {
-    for (std::string_view str : spanStr) {
-        if (str.empty())
+    while (it != end) {
+        *dataLine = toDataLine(nextLine(it, end));
+        if (!dataLine->empty())
             return true;
     }
 
     return false;
 }
 
-bool isAnyOf(std::string_view str, std::initializer_list<std::string_view> listCandidates)
+// Calls 'fn' for each data line contained in 'text'
+// Iteration stops as soon as 'fn' returns false
+template<typename Function>
+void foreachDataLine(std::string_view text, Function fn)
 {
-    for (std::string_view candidate : listCandidates) {
-        if (str == candidate)
-            return true;
+    const char* it = text.data();
+    const char* end = text.data() + text.size();
+    while (it != end) {
+        const std::string_view line = toDataLine(nextLine(it, end));
+        if (!line.empty() && !fn(line))
+            return;
     }
+}
 
-    return false;
+// Extracts the next word from 'line' and moves 'line' just after that word
+// A '#' character starts a comment which terminates the line
+std::string_view nextWord(std::string_view& line)
+{
+    std::size_t wordStart = 0;
+    while (wordStart < line.size() && isBlank(line[wordStart]))
+        ++wordStart;
+
+    std::size_t wordEnd = wordStart;
+    while (wordEnd < line.size() && !isBlank(line[wordEnd]) && line[wordEnd] != '#')
+        ++wordEnd;
+
+    const std::string_view word = line.substr(wordStart, wordEnd - wordStart);
+    line = word.empty() ? std::string_view{} : line.substr(wordEnd);
+    return word;
 }
 
 template<typename T>
 T strToNum(std::string_view str)
 {
-    static_assert(std::is_arithmetic_v<std::remove_cv_t<T>>, "Input template type must be arithmetic type");
     T num = {};
-    if (str.empty())
-        return num;
-
-#if __cpp_lib_to_chars
-    auto result = std::from_chars(str.data(), str.data() + str.size(), num);
-    if (result.ec != std::errc()) {
-        // TODO Handle error code
-        // throw std::runtime_error(std::make_error_code(err).message());
-    }
-#else
-    errno = 0;
-    num = std::strtod(str.data(), nullptr);
-    if (errno != 0) {
-        // TODO Handle error code
-        // throw std::runtime_error(std::strerror(errno));
-    }
-#endif
+    if constexpr(std::is_floating_point_v<T>)
+        fast_float::from_chars(str.data(), str.data() + str.size(), num);
+    else
+        std::from_chars(str.data(), str.data() + str.size(), num);
+
     return num;
 }
 
-void getNonCommentLine(std::istream& istr, std::string& strLine)
+unsigned strToColorComponent(std::string_view str)
 {
-    std::getline(istr >> std::ws, strLine);
-    while (!istr.eof() && !strLine.empty() && strLine.front() == '#')
-        std::getline(istr >> std::ws, strLine);
+    const double v = strToNum<double>(str);
+    return unsigned(v > 1. ? v : v * 255) & 0xFF;
 }
 
-std::uint32_t strToColorComponent(std::string_view str)
+Quantity_Color toColor(std::string_view strRed, std::string_view strGreen, std::string_view strBlue)
 {
-    const double v = strToNum<double>(str);
-    return unsigned(v > 1. ? v : v * 255);
+    return {
+        strToColorComponent(strRed) / 255.f,
+        strToColorComponent(strGreen) / 255.f,
+        strToColorComponent(strBlue) / 255.f,
+        TKernelUtils::preferredRgbColorType()
+    };
 }
 
-std::uint32_t toRgbaColor(Span<const std::string_view> spanWord)
+// Splits 'body' into 'count' chunks ending at line boundaries
+std::vector<BodyChunk> splitIntoChunks(std::string_view body, int count)
 {
-    const unsigned r = spanWord.size() > 0 ? strToColorComponent(spanWord[0]) : 0;
-    const unsigned g = spanWord.size() > 1 ? strToColorComponent(spanWord[1]) : 0;
-    const unsigned b = spanWord.size() > 2 ? strToColorComponent(spanWord[2]) : 0;
-    const unsigned a = spanWord.size() > 3 ? strToColorComponent(spanWord[3]) : 0;
-    const std::uint32_t color =
-            ((r << 24)   & 0xFF000000)
-            | ((g << 16) & 0x00FF0000)
-            | ((b << 8)  & 0x0000FF00)
-            | (a         & 0x000000FF);
-    return color;
+    std::vector<BodyChunk> vecChunk(count);
+    std::size_t chunkStart = 0;
+    for (int i = 0; i < count; ++i) {
+        std::size_t chunkEnd = i < count - 1 ? (body.size() / count) * (i + 1) : body.size();
+        chunkEnd = std::max(chunkEnd, chunkStart);
+        if (chunkEnd < body.size()) {
+            const std::size_t posEol = body.find('\n', chunkEnd);
+            chunkEnd = posEol != std::string_view::npos ? posEol + 1 : body.size();
+        }
+
+        vecChunk.at(i).text = body.substr(chunkStart, chunkEnd - chunkStart);
+        chunkStart = chunkEnd;
+    }
+
+    return vecChunk;
 }
 
 } // namespace
@@ -175,26 +186,24 @@ bool OffReader::readFile(const FilePath& filepath, TaskProgress* progress)
 
     // Reset internal data
     m_baseFilename = filepath.stem();
-    m_vecVertex.clear();
-    m_vecAllFacetIndex.clear();
-    m_vecFacet.clear();
+    m_mesh.Nullify();
+    m_vecNodeColor.clear();
 
-    std::ifstream ifs(filepath);
-    if (!ifs.is_open())
+    const FileMemoryMap fileMap(filepath);
+    if (!fileMap.isOpen())
         return fnError(OffReaderI18N::textIdTr("Can't open input file"));
 
-    std::string strLine;
+    const char* it = fileMap.contents().data();
+    const char* itEnd = it + fileMap.size();
+    std::string_view strLine;
 
     // Consume header keyword
-    {
-        getNonCommentLine(ifs, strLine);
-        if (!ifs.good())
-            return fnError(OffReaderI18N::textIdTr("Unexpected end of file"));
+    if (!nextDataLine(it, itEnd, &strLine))
+        return fnError(OffReaderI18N::textIdTr("Unexpected end of file"));
 
-        std::string_view headerKeyword = getWord(strLine);
-        if (!isAnyOf(headerKeyword, { "OFF", "COFF", "NOFF", "4OFF" }))
-            return fnError(OffReaderI18N::textIdTr("Wrong header keyword(should be [C][N][4]OFF"));
-    }
+    const std::string_view headerKeyword = nextWord(strLine);
+    if (headerKeyword != "OFF" && headerKeyword != "COFF" && headerKeyword != "NOFF" && headerKeyword != "4OFF")
+        return fnError(OffReaderI18N::textIdTr("Wrong header keyword(should be [C][N][4]OFF"));
 
     // Consume count of vertices/faces/edges
     int vertexCount = 0;
@@ -202,183 +211,168 @@ bool OffReader::readFile(const FilePath& filepath, TaskProgress* progress)
     {
         // Normally vertex/face/edge counts are specified on a dedicated line coming after OFF
         // But for some files they are wrongly specified on the line containing OFF token, eg "OFF 24 12 0"
-        const auto arrayStrFirstLine = getWords<3>(strLine);
-        if (!arrayStrFirstLine[1].empty() && !arrayStrFirstLine[2].empty()) {
-            vertexCount = strToNum<int>(arrayStrFirstLine[1]);
-            facetCount = strToNum<int>(arrayStrFirstLine[2]);
-        }
-        else {
-            if (!ifs.good())
+        std::string_view strVertexCount = nextWord(strLine);
+        std::string_view strFacetCount = nextWord(strLine);
+        if (strVertexCount.empty() || strFacetCount.empty()) {
+            if (!nextDataLine(it, itEnd, &strLine))
                 return fnError(OffReaderI18N::textIdTr("Unexpected end of file"));
 
-            getNonCommentLine(ifs, strLine);
-            const auto arrayStrCount = getWords<2>(strLine);
-            if (hasEmptyString(arrayStrCount))
+            strVertexCount = nextWord(strLine);
+            strFacetCount = nextWord(strLine);
+            if (strVertexCount.empty() || strFacetCount.empty())
                 return fnError(OffReaderI18N::textIdTr("No vertex or face count"));
-
-            vertexCount = strToNum<int>(arrayStrCount[0]);
-            facetCount = strToNum<int>(arrayStrCount[1]);
         }
-    }
-
-    // Helper function for progress report
-    auto fnUpdateProgress = [=]{
-        const auto total = vertexCount + facetCount;
-        const auto current = m_vecVertex.size() + m_vecFacet.size();
-        if (current % 100 || CppUtils::cmpGreaterEqual(current, total))
-            progress->setValue(MathUtils::toPercent(current, 0, total));
-    };
-
-    // Consume vertices
-    m_vecVertex.reserve(vertexCount);
-    while (!ifs.eof() && CppUtils::cmpLess(m_vecVertex.size(), vertexCount)) {
-        getNonCommentLine(ifs, strLine);
-        const auto arrayStrCoord = getWords<3>(strLine);
-        if (hasEmptyString(arrayStrCoord))
-            return fnError(OffReaderI18N::textIdTr("No vertex coordinates at current line"));
-
-        Vertex vertex = {};
-        vertex.coords.SetX(strToNum<double>(arrayStrCoord[0]));
-        vertex.coords.SetY(strToNum<double>(arrayStrCoord[1]));
-        vertex.coords.SetZ(strToNum<double>(arrayStrCoord[2]));
-
-        const auto arrayStrColor = getWords<4>(strLine, strEnd(arrayStrCoord.back()) - strLine.data());
-        vertex.hasColor = !arrayStrColor.front().empty();
-        if (vertex.hasColor)
-            vertex.color = toRgbaColor(arrayStrColor);
 
-        m_vecVertex.push_back(std::move(vertex));
-        fnUpdateProgress();
+        vertexCount = std::max(strToNum<int>(strVertexCount), 0);
+        facetCount = std::max(strToNum<int>(strFacetCount), 0);
     }
 
-    // Consume faces
-    m_vecAllFacetIndex.reserve(facetCount * 3);
-    m_vecFacet.reserve(facetCount);
-    std::vector<std::string_view> vecWord;
-    while (!ifs.eof() && CppUtils::cmpLess(m_vecFacet.size(), facetCount)) {
-        getNonCommentLine(ifs, strLine);
-        getWords(strLine, vecWord);
-        const Facet facet = { int(m_vecAllFacetIndex.size()), strToNum<int>(vecWord.front()) };
-        if (CppUtils::cmpLess((vecWord.size() + 1), facet.vertexCount))
-            return fnError(OffReaderI18N::textIdTr("Inconsistent vertex count of face"));
-
-        for (int i = 0; i < facet.vertexCount; ++i) {
-            const int facetVertexId = strToNum<int>(vecWord.at(i + 1));
-            m_vecAllFacetIndex.push_back(facetVertexId);
-        }
-
-#if 0
-        const bool facetHasColor = (vecWord.size() - 1 - facet.vertexCount) >= 3;
-        std::uint32_t facetColor = 0;
-        if (facetHasColor) {
-            const std::size_t colorComponentCount = vecWord.size() - (facet.vertexCount + 1);
-            facetColor = toRgbaColor({ &vecWord.at(facet.vertexCount + 1), colorComponentCount });
-            for (int i = 0; i < facet.vertexCount; ++i) {
-                const int ivertex = m_vecAllFacetIndex.at(facet.startIndexInArray + i);
-                Vertex& vertex = m_vecVertex.at(ivertex);
-            }
-        }
-#endif
-
-        m_vecFacet.push_back(std::move(facet));
-        fnUpdateProgress();
+    progress->setValue(5);
+
+    // Split file body into chunks then find index of the first data line of each chunk
+    const std::string_view body(it, itEnd - it);
+    const auto chunkCount = static_cast<int>(std::clamp<std::size_t>(
+        body.size() / MinChunkSize, 1, 4 * OSD_Parallel::NbLogicalProcessors()
+    ));
+    std::vector<BodyChunk> vecChunk = splitIntoChunks(body, chunkCount);
+    OSD_Parallel::For(0, chunkCount, [&](int iChunk) {
+        BodyChunk& chunk = vecChunk.at(iChunk);
+        foreachDataLine(chunk.text, [&](std::string_view) { ++chunk.lineCount; return true; });
+    });
+
+    int bodyLineCount = 0;
+    for (BodyChunk& chunk : vecChunk) {
+        chunk.firstLineIndex = bodyLineCount;
+        bodyLineCount += chunk.lineCount;
     }
 
-    return true;
-}
+    // Files could be truncated
+    vertexCount = std::min(vertexCount, bodyLineCount);
+    facetCount = std::min(facetCount, bodyLineCount - vertexCount);
+    if (vertexCount == 0 || facetCount == 0)
+        return true; // Point clouds aren't supported yet
 
-TDF_LabelSequence OffReader::transfer(DocumentPtr doc, TaskProgress* progress)
-{
-    if (m_vecVertex.empty())
-        return {};
+    progress->setValue(20);
+    if (progress->isAbortRequested())
+        return false;
 
-    TDF_Label entityLabel;
-    if (!m_vecAllFacetIndex.empty())
-        entityLabel = this->transferMesh(doc, progress);
-    else
-        entityLabel = this->transferPointCloud(doc, progress);
+    // Count triangles of the faces(polygons are triangulated as fans)
+    const int faceLineEnd = vertexCount + facetCount;
+    OSD_Parallel::For(0, chunkCount, [&](int iChunk) {
+        BodyChunk& chunk = vecChunk.at(iChunk);
+        if (chunk.firstLineIndex + chunk.lineCount <= vertexCount || chunk.firstLineIndex >= faceLineEnd)
+            return;
 
-    if (!entityLabel.IsNull()) {
-        TDataStd_Name::Set(entityLabel, filepathTo<TCollection_ExtendedString>(m_baseFilename));
-        return CafUtils::makeLabelSequence({ entityLabel });
-    }
+        int lineIndex = chunk.firstLineIndex;
+        foreachDataLine(chunk.text, [&](std::string_view line) {
+            if (lineIndex >= vertexCount) {
+                const int faceVertexCount = strToNum<int>(nextWord(line));
+                chunk.triangleCount += std::max(faceVertexCount - 2, 0);
+            }
 
-    return {};
-}
+            return ++lineIndex < faceLineEnd;
+        });
+    });
 
-TDF_Label OffReader::transferMesh(DocumentPtr doc, TaskProgress* progress)
-{
-    // Vertex and triangle count
-    const int vertexCount = CppUtils::safeStaticCast<int>(m_vecVertex.size());
     int triangleCount = 0;
-    for (const Facet& facet : m_vecFacet)
-        triangleCount += facet.vertexCount - 2;
+    for (BodyChunk& chunk : vecChunk) {
+        chunk.firstTriangleIndex = triangleCount;
+        triangleCount += chunk.triangleCount;
+    }
 
-    // Create mesh object
-    auto mesh = makeOccHandle<Poly_Triangulation>(vertexCount, triangleCount, false/*!hasUvNodes*/);
+    progress->setValue(30);
+    if (progress->isAbortRequested())
+        return false;
 
-    // Helper function for progress report
-    auto fnUpdateProgress = [=](int current) {
-        const auto total = vertexCount + triangleCount;
-        if (current % 100 || current >= total)
-            progress->setValue(MathUtils::toPercent(current, 0, total));
-    };
+    // Parse vertices and faces directly into the triangulation
+    auto mesh = makeOccHandle<Poly_Triangulation>(vertexCount, triangleCount, false/*!hasUvNodes*/);
+    m_vecNodeColor.assign(vertexCount, Quantity_Color(Quantity_NOC_BEIGE));
+    OSD_Parallel::For(0, chunkCount, [&](int iChunk) {
+        BodyChunk& chunk = vecChunk.at(iChunk);
+        if (chunk.firstLineIndex >= faceLineEnd)
+            return;
 
-    // Transfer vertices and prepare vertex colors
-    std::vector<Quantity_Color> vecVertexColor;
-    vecVertexColor.reserve(m_vecVertex.size());
-    for (const Vertex& vertex : m_vecVertex) {
-        const auto ivertex = Span_itemIndex(m_vecVertex, vertex);
-        MeshUtils::setNode(mesh, ivertex + 1, vertex.coords);
-        const std::uint32_t c = vertex.color;
-        if (vertex.hasColor) {
-            vecVertexColor.push_back(
-                        Quantity_Color{
-                            ((c & 0xFF000000) >> 24) / 255.f,
-                            ((c & 0x00FF0000) >> 16) / 255.f,
-                            ((c & 0x0000FF00) >> 8)  / 255.f,
-                            TKernelUtils::preferredRgbColorType()
-                        });
-        }
-        else {
-            vecVertexColor.push_back(Quantity_NOC_BEIGE);
-        }
+        int lineIndex = chunk.firstLineIndex;
+        int triangleIndex = chunk.firstTriangleIndex;
+        foreachDataLine(chunk.text, [&](std::string_view line) {
+            if (lineIndex < vertexCount) {
+                const std::string_view strX = nextWord(line);
+                const std::string_view strY = nextWord(line);
+                const std::string_view strZ = nextWord(line);
+                if (strX.empty() || strY.empty() || strZ.empty()) {
+                    chunk.error = ParseError::NoVertexCoords;
+                    return false;
+                }
+
+                const gp_Pnt pnt(strToNum<double>(strX), strToNum<double>(strY), strToNum<double>(strZ));
+                MeshUtils::setNode(mesh, lineIndex + 1, pnt);
+                const std::string_view strRed = nextWord(line);
+                if (!strRed.empty()) {
+                    const std::string_view strGreen = nextWord(line);
+                    const std::string_view strBlue = nextWord(line);
+                    m_vecNodeColor[lineIndex] = toColor(strRed, strGreen, strBlue);
+                }
+            }
+            else {
+                const int faceVertexCount = strToNum<int>(nextWord(line));
+                int faceVertex0 = 0;
+                int faceVertexPrev = 0;
+                for (int i = 0; i < faceVertexCount; ++i) {
+                    const std::string_view strIndex = nextWord(line);
+                    if (strIndex.empty()) {
+                        chunk.error = ParseError::InconsistentFaceVertexCount;
+                        return false;
+                    }
+
+                    const int faceVertex = strToNum<int>(strIndex) + 1;
+                    if (faceVertex < 1 || faceVertex > vertexCount) {
+                        chunk.error = ParseError::InvalidFaceVertexIndex;
+                        return false;
+                    }
+
+                    if (i == 0)
+                        faceVertex0 = faceVertex;
+                    else if (i >= 2)
+                        MeshUtils::setTriangle(mesh, ++triangleIndex, { faceVertex0, faceVertexPrev, faceVertex });
+
+                    faceVertexPrev = faceVertex;
+                }
+            }
 
-        fnUpdateProgress(ivertex);
-    }
+            return ++lineIndex < faceLineEnd;
+        });
+    });
 
-    // Transfer faces
-    int iTriangle = 0;
-    for (const Facet& facet: m_vecFacet) {
-        const int facet0 = m_vecAllFacetIndex.at(facet.startIndexInArray);
-        if (facet.vertexCount == 3) {
-            const int facet1 = m_vecAllFacetIndex.at(facet.startIndexInArray + 1);
-            const int facet2 = m_vecAllFacetIndex.at(facet.startIndexInArray + 2);
-            MeshUtils::setTriangle(mesh, iTriangle + 1, { facet0 + 1, facet1 + 1, facet2 + 1 });
-            ++iTriangle;
-        }
-        else if (facet.vertexCount > 3) {
-            for (int i = 1; i <= facet.vertexCount - 2; ++i) {
-                const int facetN = m_vecAllFacetIndex.at(facet.startIndexInArray + i);
-                const int facetM = m_vecAllFacetIndex.at(facet.startIndexInArray + i + 1);
-                MeshUtils::setTriangle(mesh, iTriangle + 1, { facet0 + 1, facetN + 1, facetM + 1 });
-                ++iTriangle;
-            }
+    for (const BodyChunk& chunk : vecChunk) {
+        switch (chunk.error) {
+        case ParseError::None:
+            break;
+        case ParseError::NoVertexCoords:
+            return fnError(OffReaderI18N::textIdTr("No vertex coordinates at current line"));
+        case ParseError::InconsistentFaceVertexCount:
+            return fnError(OffReaderI18N::textIdTr("Inconsistent vertex count of face"));
+        case ParseError::InvalidFaceVertexIndex:
+            return fnError(OffReaderI18N::textIdTr("Invalid vertex index in face"));
         }
-
-        fnUpdateProgress(vertexCount + iTriangle);
     }
 
-    // Insert mesh as a document entity
-    const TDF_Label entityLabel = doc->newEntityShapeLabel();
-    doc->xcaf().setShape(entityLabel, BRepUtils::makeFace(mesh)); // IMPORTANT: pure mesh part marker!
-    TriangulationAnnexData::Set(entityLabel, std::move(vecVertexColor));
-    return entityLabel;
+    m_mesh = mesh;
+    progress->setValue(100);
+    return true;
 }
 
-TDF_Label OffReader::transferPointCloud(DocumentPtr /*doc*/, TaskProgress* /*progress*/)
+TDF_LabelSequence OffReader::transfer(DocumentPtr doc, TaskProgress* /*progress*/)
 {
-    return {};
+    if (!m_mesh)
+        return {};
+
+    // Insert mesh as a document entity
+    const TDF_Label entityLabel = doc->newEntityShapeLabel();
+    doc->xcaf().setShape(entityLabel, BRepUtils::makeFace(m_mesh)); // IMPORTANT: pure mesh part marker!
+    TriangulationAnnexData::Set(entityLabel, std::move(m_vecNodeColor));
+    TDataStd_Name::Set(entityLabel, filepathTo<TCollection_ExtendedString>(m_baseFilename));
+    m_mesh.Nullify();
+    return CafUtils::makeLabelSequence({ entityLabel });
 }
 
 } // namespace IO
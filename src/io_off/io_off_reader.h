@@ -8,15 +8,18 @@
 
 #include "../base/io_reader.h"
 #include "../base/io_single_format_factory.h"
+#include "../base/occ_handle.h"
 
-#include <gp_Pnt.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Quantity_Color.hxx>
 #include <vector>
-#include <type_traits>
 
 namespace Mayo {
 namespace IO {
 
 // Reader for OFF file format
+// The file is memory-mapped and its body(vertices and faces) is split into chunks at line
+// boundaries, which are then parsed concurrently directly into the target triangulation
 class OffReader : public Reader {
 public:
     bool readFile(const FilePath& filepath, TaskProgress* progress) override;
@@ -26,24 +29,9 @@ public:
     static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup*) { return {}; }
 
 private:
-    TDF_Label transferMesh(DocumentPtr doc, TaskProgress* progress);
-    TDF_Label transferPointCloud(DocumentPtr doc, TaskProgress* progress);
-
-    struct Vertex {
-        gp_Pnt coords;
-        std::uint32_t color;
-        bool hasColor = false;
-    };
-
-    struct Facet {
-        int startIndexInArray;
-        int vertexCount;
-    };
-
     FilePath m_baseFilename;
-    std::vector<Vertex> m_vecVertex;
-    std::vector<int> m_vecAllFacetIndex;
-    std::vector<Facet> m_vecFacet;
+    OccHandle<Poly_Triangulation> m_mesh;
+    std::vector<Quantity_Color> m_vecNodeColor;
 };
 
 // Provides factory to create OffReader objects
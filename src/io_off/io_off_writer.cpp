@@ -7,9 +7,11 @@
 #include "io_off_writer.h"
 
 #include "../base/caf_utils.h"
+#include "../base/chunked_text_writer.h"
 #include "../base/document.h"
 #include "../base/label_data.h"
 #include "../base/io_system.h"
+#include "../base/math_utils.h"
 #include "../base/mesh_access.h"
 #include "../base/messenger.h"
 #include "../base/property_builtins.h"
@@ -18,8 +20,10 @@
 
 #include <Poly_Triangulation.hxx>
 
+#include <fmt/format.h>
+
+#include <algorithm>
 #include <fstream>
-#include <locale>
 #include <string>
 
 namespace Mayo {
@@ -30,6 +34,11 @@ struct OffWriterI18N { MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::OffWriterI18N) }
 bool OffWriter::transfer(Span<const ApplicationItem> appItems, TaskProgress* /*progress*/)
 {
     m_vecTreeNode.clear();
+    if (!System::isDeepExpanded(appItems)) {
+        this->messenger()->emitError(OffWriterI18N::textIdTr("Model tree isn't completely built, some instances would be missing"));
+        return false;
+    }
+
     m_vecTreeNode.reserve(appItems.size());
     System::traverseUniqueItems(appItems, [&](const DocumentTreeNode& treeNode) {
         if (treeNode.isLeaf())
@@ -47,70 +56,97 @@ bool OffWriter::writeFile(const FilePath& filepath, TaskProgress* progress)
         return false;
     }
 
-    fstr.imbue(std::locale::classic());
-    fstr << "OFF\n";
-
-    // Count vertices and facets
-    int vertexCount = 0;
-    int facetCount = 0;
+    // Record meshes along with vertex/facet offsets, this is the single visit of the meshes
+    struct MeshItem {
+        OccHandle<Poly_Triangulation> triangulation;
+        gp_Trsf trsf;
+        std::vector<Quantity_Color> vecNodeColor;
+        int64_t vertexOffset = 0;
+        int64_t facetOffset = 0;
+    };
+    std::vector<MeshItem> vecMeshItem;
+    int64_t vertexCount = 0;
+    int64_t facetCount = 0;
     for (const DocumentTreeNode& treeNode : m_vecTreeNode) {
         IMeshAccess_visitMeshes(treeNode, [&](const IMeshAccess& mesh) {
-            vertexCount += mesh.triangulation()->NbNodes();
-            facetCount += mesh.triangulation()->NbTriangles();
+            MeshItem item;
+            item.triangulation = mesh.triangulation();
+            item.trsf = mesh.location().Transformation();
+            const int nodeCount = item.triangulation->NbNodes();
+            if (nodeCount > 0 && mesh.nodeColor(0).has_value()) {
+                item.vecNodeColor.reserve(nodeCount);
+                for (int i = 0; i < nodeCount; ++i)
+                    item.vecNodeColor.push_back(mesh.nodeColor(i).value_or(Quantity_Color{}));
+            }
+
+            item.vertexOffset = vertexCount;
+            item.facetOffset = facetCount;
+            vertexCount += nodeCount;
+            facetCount += item.triangulation->NbTriangles();
+            vecMeshItem.push_back(std::move(item));
         });
     }
 
-    // Helper function for progress report
-    auto fnUpdateProgress = [=](int current) {
-        const auto total = vertexCount + facetCount;
-        if (current % 100 || current >= total)
-            progress->setValue(MathUtils::toPercent(current, 0, total));
+    // Helper function to find the mesh item containing global element 'index'
+    using MeshItemOffset = int64_t MeshItem::*;
+    auto fnFindMeshItem = [&](int64_t index, MeshItemOffset offset) {
+        auto it = std::upper_bound(
+            vecMeshItem.cbegin(), vecMeshItem.cend(), index,
+            [=](int64_t value, const MeshItem& item) { return value < item.*offset; }
+        );
+        return it != vecMeshItem.cbegin() ? it - 1 : it;
     };
 
-    fstr << vertexCount << " " << facetCount << " " << 0/*edgeCount*/ << "\n";
+    ChunkedTextWriter writer(fstr);
+    const int64_t elementCount = vertexCount + facetCount;
+    int64_t elementOffset = 0;
+    writer.setProgressFunction([&](int64_t itemsWritten) {
+        progress->setValue(MathUtils::toPercent(elementOffset + itemsWritten, int64_t(0), elementCount));
+        return !progress->isAbortRequested();
+    });
+
+    writer.write(fmt::format("OFF\n{} {} {}\n", vertexCount, facetCount, 0/*edgeCount*/));
+
     // Write vertices
-    int ivertex = 0;
-    for (const DocumentTreeNode& treeNode : m_vecTreeNode) {
-        IMeshAccess_visitMeshes(treeNode, [&](const IMeshAccess& mesh) {
-            const gp_Trsf& meshTrsf = mesh.location().Transformation();
-            const OccHandle<Poly_Triangulation>& triangulation = mesh.triangulation();
-            for (int i = 1; i <= triangulation->NbNodes(); ++i) {
-                const gp_Pnt pnt = triangulation->Node(i).Transformed(meshTrsf);
-                const std::optional<Quantity_Color> color = mesh.nodeColor(i - 1);
-                fstr << pnt.X() << " " << pnt.Y() << " " << pnt.Z();
-                if (color.has_value()) {
-                    //fstr << " " << int(color->Red()   * 255)
-                    //     << " " << int(color->Green() * 255)
-                    //     << " " << int(color->Blue()  * 255);
-                    fstr << " " << color->Red() << " " << color->Green() << " " << color->Blue();
+    const bool okVertices = writer.writeItems(vertexCount, [&](ChunkedTextWriter::Buffer& buff, int64_t first, int64_t last) {
+        auto out = fmt::appender(buff);
+        for (auto it = fnFindMeshItem(first, &MeshItem::vertexOffset); it != vecMeshItem.cend() && first < last; ++it) {
+            const int64_t itemLast = std::min(last, it->vertexOffset + it->triangulation->NbNodes());
+            for (; first < itemLast; ++first) {
+                const auto inode = static_cast<int>(first - it->vertexOffset);
+                const gp_Pnt pnt = it->triangulation->Node(inode + 1).Transformed(it->trsf);
+                fmt::format_to(out, "{:g} {:g} {:g}", pnt.X(), pnt.Y(), pnt.Z());
+                if (!it->vecNodeColor.empty()) {
+                    const Quantity_Color& color = it->vecNodeColor[inode];
+                    fmt::format_to(out, " {:g} {:g} {:g}", color.Red(), color.Green(), color.Blue());
                 }
 
-                fstr << "\n";
-                fnUpdateProgress(++ivertex);
+                buff.push_back('\n');
             }
-        });
-    }
+        }
+    });
+    if (!okVertices)
+        return progress->isAbortRequested(); // Abort isn't an error, only stream failure is
 
     // Write facets(triangles)
-    int offsetVertex = 0;
-    int ifacet = 0;
-    for (const DocumentTreeNode& treeNode : m_vecTreeNode) {
-        IMeshAccess_visitMeshes(treeNode, [&](const IMeshAccess& mesh) {
-            const OccHandle<Poly_Triangulation>& triangulation = mesh.triangulation();
-            for (int i = 1; i <= triangulation->NbTriangles(); ++i) {
-                const Poly_Triangle& tri = triangulation->Triangle(i);
-                fstr << "3 "
-                     << offsetVertex + tri.Value(1) - 1 << " "
-                     << offsetVertex + tri.Value(2) - 1 << " "
-                     << offsetVertex + tri.Value(3) - 1 << "\n";
-                fnUpdateProgress(vertexCount + (++ifacet));
+    elementOffset = vertexCount;
+    const bool okFacets = writer.writeItems(facetCount, [&](ChunkedTextWriter::Buffer& buff, int64_t first, int64_t last) {
+        auto out = fmt::appender(buff);
+        for (auto it = fnFindMeshItem(first, &MeshItem::facetOffset); it != vecMeshItem.cend() && first < last; ++it) {
+            const int64_t itemLast = std::min(last, it->facetOffset + it->triangulation->NbTriangles());
+            for (; first < itemLast; ++first) {
+                const auto itri = static_cast<int>(first - it->facetOffset);
+                const Poly_Triangle& tri = it->triangulation->Triangle(itri + 1);
+                fmt::format_to(
+                    out, "3 {} {} {}\n",
+                    it->vertexOffset + tri.Value(1) - 1,
+                    it->vertexOffset + tri.Value(2) - 1,
+                    it->vertexOffset + tri.Value(3) - 1
+                );
             }
-
-            offsetVertex += triangulation->NbNodes();
-        });
-    }
-
-    return true;
+        }
+    });
+    return okFacets || progress->isAbortRequested();
 }
 
 void OffWriter::applyProperties(const PropertyGroup*)
@@ -20,12 +20,48 @@
 #include "miniply.h"
 // TODO Move miniply library files into 3rdparty folder
 
+#include <OSD_Parallel.hxx>
 #include <Poly_Triangulation.hxx>
 #include <TDataStd_Name.hxx>
 
 namespace Mayo {
 namespace IO {
 
+namespace {
+
+// Helper to release memory allocated by vector 'vec'(clear() keeps the capacity)
+template<typename T> void freeVector(std::vector<T>& vec)
+{
+    std::vector<T>().swap(vec);
+}
+
+#if OCC_VERSION_HEX >= 0x070600
+// Starting from OpenCascade 7.6, storage of Poly_Triangulation is contiguous:
+//     - nodes are stored as gp_Vec3f when single-precision is enabled
+//     - normals are stored as gp_Vec3f
+//     - triangles are stored as Poly_Triangle, ie three integers
+// This allows miniply to extract data directly into the mesh without intermediate copy
+static_assert(sizeof(gp_Vec3f) == 3 * sizeof(float));
+static_assert(sizeof(Poly_Triangle) == 3 * sizeof(int));
+
+float* meshNodeCoordsData(const OccHandle<Poly_Triangulation>& mesh)
+{
+    return reinterpret_cast<float*>(mesh->InternalNodes().ChangeData());
+}
+
+float* meshNormalCoordsData(const OccHandle<Poly_Triangulation>& mesh)
+{
+    return reinterpret_cast<float*>(&mesh->InternalNormals().ChangeFirst());
+}
+
+int* meshTriangleIndicesData(const OccHandle<Poly_Triangulation>& mesh)
+{
+    return reinterpret_cast<int*>(&mesh->InternalTriangles().ChangeFirst());
+}
+#endif
+
+} // namespace
+
 bool PlyReader::readFile(const FilePath& filepath, TaskProgress* /*progress*/)
 {
     miniply::PLYReader reader(filepath.u8string().c_str());
@@ -35,10 +71,7 @@ bool PlyReader::readFile(const FilePath& filepath, TaskProgress* /*progress*/)
     // Reset internal data
     m_baseFilename = filepath.stem();
     m_nodeCount = 0;
-    m_vecNodeCoord.clear();
-    m_vecColorComponent.clear();
-    m_vecIndex.clear();
-    m_vecNormalCoord.clear();
+    this->clearBuffers();
     bool assumeTriangles = true;
 
     // Guess if PLY faces are triangles
@@ -49,6 +82,27 @@ bool PlyReader::readFile(const FilePath& filepath, TaskProgress* /*progress*/)
             assumeTriangles = faceElem->convert_list_to_fixed_size(faceElem->find_property("vertex_indices"), 3, faceIdxs);
     }
 
+#if OCC_VERSION_HEX >= 0x070600
+    // PLY data is a mesh(not a point cloud): extract data straight into the target mesh
+    // Note: nodes are extracted as 'float' by miniply, so single-precision storage loses nothing
+    if (reader.find_element(miniply::kPLYFaceElement) != miniply::kInvalidIndex) {
+        m_mesh = new Poly_Triangulation;
+        m_mesh->SetDoublePrecision(false);
+    }
+#endif
+
+    // Helper function returning the destination buffer where to extract triangle indices
+    auto fnTriangleIndicesData = [=](uint32_t triangleCount) -> int* {
+#if OCC_VERSION_HEX >= 0x070600
+        if (m_mesh) {
+            m_mesh->ResizeTriangles(CppUtils::safeStaticCast<int>(triangleCount), false/*toCopyOld*/);
+            return triangleCount > 0 ? meshTriangleIndicesData(m_mesh) : nullptr;
+        }
+#endif
+        m_vecIndex.resize(triangleCount * 3);
+        return m_vecIndex.data();
+    };
+
     bool okLoad = true;
     bool gotVerts = false;
     bool gotFaces = false;
@@ -61,13 +115,33 @@ bool PlyReader::readFile(const FilePath& filepath, TaskProgress* /*progress*/)
             }
 
             m_nodeCount = reader.num_rows();
-            m_vecNodeCoord.resize(m_nodeCount * 3);
-            reader.extract_properties(prop3Idxs, 3, miniply::PLYPropertyType::Float, m_vecNodeCoord.data());
-            if (reader.find_normal(prop3Idxs)) {
-                m_vecNormalCoord.resize(m_nodeCount * 3);
-                reader.extract_properties(prop3Idxs, 3, miniply::PLYPropertyType::Float, m_vecNormalCoord.data());
+            float* nodeCoords = nullptr;
+            float* normalCoords = nullptr;
+            uint32_t normalIdxs[3] = {};
+            const bool hasNormals = reader.find_normal(normalIdxs);
+#if OCC_VERSION_HEX >= 0x070600
+            if (m_mesh && m_nodeCount > 0) {
+                m_mesh->ResizeNodes(CppUtils::safeStaticCast<int>(m_nodeCount), false/*toCopyOld*/);
+                nodeCoords = meshNodeCoordsData(m_mesh);
+                if (hasNormals) {
+                    m_mesh->AddNormals();
+                    normalCoords = meshNormalCoordsData(m_mesh);
+                }
+            }
+#endif
+            if (!nodeCoords) {
+                m_vecNodeCoord.resize(m_nodeCount * 3);
+                nodeCoords = m_vecNodeCoord.data();
+                if (hasNormals) {
+                    m_vecNormalCoord.resize(m_nodeCount * 3);
+                    normalCoords = m_vecNormalCoord.data();
+                }
             }
 
+            reader.extract_properties(prop3Idxs, 3, miniply::PLYPropertyType::Float, nodeCoords);
+            if (hasNormals)
+                reader.extract_properties(normalIdxs, 3, miniply::PLYPropertyType::Float, normalCoords);
+
             if (reader.find_color(prop3Idxs)) {
                 m_vecColorComponent.resize(m_nodeCount * 3);
                 reader.extract_properties(prop3Idxs, 3, miniply::PLYPropertyType::UChar, m_vecColorComponent.data());
@@ -85,8 +159,8 @@ bool PlyReader::readFile(const FilePath& filepath, TaskProgress* /*progress*/)
                 break;
 
             if (assumeTriangles) {
-                m_vecIndex.resize(reader.num_rows() * 3);
-                reader.extract_properties(faceIdxs, 3, miniply::PLYPropertyType::Int, m_vecIndex.data());
+                int* indices = fnTriangleIndicesData(reader.num_rows());
+                reader.extract_properties(faceIdxs, 3, miniply::PLYPropertyType::Int, indices);
             }
             else {
                 uint32_t propIdx = 0;
@@ -100,12 +174,17 @@ bool PlyReader::readFile(const FilePath& filepath, TaskProgress* /*progress*/)
                 }
 
                 if (polys) {
-                    m_vecIndex.resize(reader.num_triangles(propIdx) * 3);
-                    reader.extract_triangles(propIdx, m_vecNodeCoord.data(), m_nodeCount, miniply::PLYPropertyType::Int, m_vecIndex.data());
+                    const float* nodeCoords = m_vecNodeCoord.data();
+#if OCC_VERSION_HEX >= 0x070600
+                    if (m_mesh && m_vecNodeCoord.empty())
+                        nodeCoords = m_nodeCount > 0 ? meshNodeCoordsData(m_mesh) : nullptr;
+#endif
+                    int* indices = fnTriangleIndicesData(reader.num_triangles(propIdx));
+                    reader.extract_triangles(propIdx, nodeCoords, m_nodeCount, miniply::PLYPropertyType::Int, indices);
                 }
                 else {
-                    m_vecIndex.resize(reader.num_rows() * 3);
-                    reader.extract_list_property(propIdx, miniply::PLYPropertyType::Int, m_vecIndex.data());
+                    int* indices = fnTriangleIndicesData(reader.num_rows());
+                    reader.extract_list_property(propIdx, miniply::PLYPropertyType::Int, indices);
                 }
             }
 
@@ -131,18 +210,35 @@ bool PlyReader::readFile(const FilePath& filepath, TaskProgress* /*progress*/)
         reader.next_element();
     } // endwhile
 
+#if OCC_VERSION_HEX >= 0x070600
+    // miniply extracts 0-based indices whereas Poly_Triangulation expects 1-based ones
+    if (m_mesh && m_mesh->NbTriangles() > 0) {
+        int* indices = meshTriangleIndicesData(m_mesh);
+        OSD_Parallel::For(0, 3 * m_mesh->NbTriangles(), [=](int i) { ++indices[i]; });
+    }
+
+    // No faces at all(eg empty 'face' element): handle nodes as point cloud
+    if (m_mesh && m_mesh->NbTriangles() == 0 && m_vecIndex.empty() && m_nodeCount > 0) {
+        const float* nodeCoords = meshNodeCoordsData(m_mesh);
+        m_vecNodeCoord.assign(nodeCoords, nodeCoords + 3 * m_nodeCount);
+        m_mesh.Nullify();
+    }
+#endif
+
     return okLoad;
 }
 
 TDF_LabelSequence PlyReader::transfer(DocumentPtr doc, TaskProgress* progress)
 {
     TDF_Label entityLabel;
-    if (!m_vecNodeCoord.empty() && !m_vecIndex.empty())
+    const bool hasMeshTriangles = m_mesh && m_mesh->NbTriangles() > 0;
+    if (m_nodeCount > 0 && (hasMeshTriangles || !m_vecIndex.empty()))
         entityLabel = this->transferMesh(doc, progress);
-
-    if (!m_vecNodeCoord.empty() && m_vecIndex.empty())
+    else if (!m_vecNodeCoord.empty())
         entityLabel = this->transferPointCloud(doc, progress);
 
+    this->clearBuffers();
+
     if (!entityLabel.IsNull()) {
         TDataStd_Name::Set(entityLabel, filepathTo<TCollection_ExtendedString>(m_baseFilename));
         return CafUtils::makeLabelSequence({ entityLabel });
@@ -153,48 +249,64 @@ TDF_LabelSequence PlyReader::transfer(DocumentPtr doc, TaskProgress* progress)
 
 TDF_Label PlyReader::transferMesh(DocumentPtr doc, TaskProgress* /*progress*/)
 {
-    // Create target mesh
-    const int triangleCount = CppUtils::safeStaticCast<int>(m_vecIndex.size() / 3);
-    auto mesh = makeOccHandle<Poly_Triangulation>(m_nodeCount, triangleCount, false/*hasUvNodes*/);
-    if (!m_vecNormalCoord.empty())
-        MeshUtils::allocateNormals(mesh);
+    OccHandle<Poly_Triangulation> mesh = m_mesh;
+    if (!mesh) {
+        // Nodes weren't extracted into the target mesh, copy them
+        const int triangleCount = CppUtils::safeStaticCast<int>(m_vecIndex.size() / 3);
+        mesh = makeOccHandle<Poly_Triangulation>(m_nodeCount, triangleCount, false/*hasUvNodes*/);
+        if (!m_vecNormalCoord.empty())
+            MeshUtils::allocateNormals(mesh);
+
+        const float* nodeCoords = m_vecNodeCoord.data();
+        OSD_Parallel::For(0, mesh->NbNodes(), [=](int i) {
+            const float* coords = nodeCoords + 3 * i;
+            MeshUtils::setNode(mesh, i + 1, gp_Pnt(coords[0], coords[1], coords[2]));
+        });
+
+        const float* normalCoords = m_vecNormalCoord.data();
+        if (!m_vecNormalCoord.empty()) {
+            OSD_Parallel::For(0, mesh->NbNodes(), [=](int i) {
+                const float* coords = normalCoords + 3 * i;
+                MeshUtils::setNormal(mesh, i + 1, { coords[0], coords[1], coords[2] });
+            });
+        }
 
-    // Copy nodes(vertices) into mesh
-    for (int i = 0; CppUtils::cmpLess(i, m_vecNodeCoord.size()); i += 3) {
-        const auto& vec = m_vecNodeCoord;
-        const gp_Pnt node = { vec.at(i), vec.at(i + 1), vec.at(i + 2) };
-        MeshUtils::setNode(mesh, (i / 3) + 1, node);
+        freeVector(m_vecNodeCoord);
+        freeVector(m_vecNormalCoord);
     }
 
-    // Copy triangles indices into mesh
-    for (int i = 0; CppUtils::cmpLess(i, m_vecIndex.size()); i += 3) {
-        const auto& vec = m_vecIndex;
-        const Poly_Triangle tri = { 1 + vec.at(i), 1 + vec.at(i + 1), 1 + vec.at(i + 2) };
-        MeshUtils::setTriangle(mesh, (i / 3) + 1, tri);
-    }
+    // Copy triangles indices(if not already extracted into mesh)
+    if (!m_vecIndex.empty()) {
+        const int triangleCount = CppUtils::safeStaticCast<int>(m_vecIndex.size() / 3);
+#if OCC_VERSION_HEX >= 0x070600
+        if (mesh->NbTriangles() != triangleCount)
+            mesh->ResizeTriangles(triangleCount, false/*toCopyOld*/);
+#endif
 
-    // Copy normals(optional) into mesh
-    for (int i = 0; CppUtils::cmpLess(i, m_vecNormalCoord.size()); i += 3) {
-        const auto& vec = m_vecNormalCoord;
-        const MeshUtils::Poly_Triangulation_NormalType n(vec.at(i), vec.at(i + 1), vec.at(i + 2));
-        MeshUtils::setNormal(mesh, (i / 3) + 1, n);
+        const int* indices = m_vecIndex.data();
+        OSD_Parallel::For(0, triangleCount, [=](int i) {
+            const int* tri = indices + 3 * i;
+            MeshUtils::setTriangle(mesh, i + 1, { 1 + tri[0], 1 + tri[1], 1 + tri[2] });
+        });
+        freeVector(m_vecIndex);
     }
 
-    // Copy colors(optional) into mesh
-    std::vector<Quantity_Color> vecColor;
-    for (int i = 0; CppUtils::cmpLess(i, m_vecColorComponent.size()); i += 3) {
-        const auto& vec = m_vecColorComponent;
-        const Quantity_Color color = {
-            vec.at(i) / 255., vec.at(i + 1) / 255., vec.at(i + 2) / 255.,
-            TKernelUtils::preferredRgbColorType()
-        };
-        vecColor.push_back(color);
-    }
+    // Convert colors(optional)
+    std::vector<Quantity_Color> vecColor(m_vecColorComponent.size() / 3);
+    const uint8_t* colorComponents = m_vecColorComponent.data();
+    const Quantity_TypeOfColor colorType = TKernelUtils::preferredRgbColorType();
+    OSD_Parallel::For(0, CppUtils::safeStaticCast<int>(vecColor.size()), [&](int i) {
+        const uint8_t* rgb = colorComponents + 3 * i;
+        vecColor[i] = Quantity_Color(rgb[0] / 255., rgb[1] / 255., rgb[2] / 255., colorType);
+    });
+
+    // Release reader buffers before insertion into the document, mesh is now owned by 'mesh'
+    this->clearBuffers();
 
     // Insert mesh as a document entity
     const TDF_Label entityLabel = doc->newEntityShapeLabel();
     doc->xcaf().setShape(entityLabel, BRepUtils::makeFace(mesh)); // IMPORTANT: pure mesh part marker!
-    TriangulationAnnexData::Set(entityLabel, vecColor);
+    TriangulationAnnexData::Set(entityLabel, std::move(vecColor));
     return entityLabel;
 }
 
@@ -239,5 +351,14 @@ TDF_Label PlyReader::transferPointCloud(DocumentPtr doc, TaskProgress* /*progres
     return entityLabel;
 }
 
+void PlyReader::clearBuffers()
+{
+    m_mesh.Nullify();
+    freeVector(m_vecNodeCoord);
+    freeVector(m_vecIndex);
+    freeVector(m_vecNormalCoord);
+    freeVector(m_vecColorComponent);
+}
+
 } // namespace IO
 } // namespace Mayo
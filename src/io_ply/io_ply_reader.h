@@ -8,7 +8,9 @@
 
 #include "../base/io_reader.h"
 #include "../base/io_single_format_factory.h"
+#include "../base/occ_handle.h"
 
+#include <Poly_Triangulation.hxx>
 #include <vector>
 
 namespace Mayo {
@@ -27,8 +29,13 @@ private:
     TDF_Label transferMesh(DocumentPtr doc, TaskProgress* progress);
     TDF_Label transferPointCloud(DocumentPtr doc, TaskProgress* progress);
 
+    // Releases memory of all intermediate buffers
+    void clearBuffers();
+
     FilePath m_baseFilename;
     uint32_t m_nodeCount = 0;
+    // Target mesh directly filled by miniply(OpenCascade >= 7.6 only, null otherwise)
+    OccHandle<Poly_Triangulation> m_mesh;
     std::vector<float> m_vecNodeCoord;
     std::vector<int> m_vecIndex;
     std::vector<float> m_vecNormalCoord;
@@ -7,6 +7,7 @@
 #include "io_ply_writer.h"
 
 #include "../base/caf_utils.h"
+#include "../base/chunked_text_writer.h"
 #include "../base/cpp_utils.h"
 #include "../base/document.h"
 #include "../base/label_data.h"
@@ -88,6 +89,10 @@ bool PlyWriter::transfer(Span<const ApplicationItem> appItems, TaskProgress* pro
     m_vecNode.clear();
     m_vecNodeColor.clear();
     m_vecFace.clear();
+    if (!System::isDeepExpanded(appItems)) {
+        this->messenger()->emitError(PlyWriterI18N::textIdTr("Model tree isn't completely built, some instances would be missing"));
+        return false;
+    }
 
     // TODO Investigate bad looking 3D mesh when defining vertex colors
     // TODO Investigate task abort issue
@@ -200,23 +205,47 @@ bool PlyWriter::writeFile(const FilePath& filepath, TaskProgress* progress)
         return true;
     };
 
+    if (!isBinary) {
+        // Format elements in parallel chunks, then write them in order
+        ChunkedTextWriter writer(fstr);
+        writer.setProgressFunction([&](int64_t itemsWritten) {
+            progress->setValue(MathUtils::toPercent(iElement + itemsWritten, int64_t(0), int64_t(elementCount)));
+            return !progress->isAbortRequested();
+        });
+
+        const bool okVertices = writer.writeItems(m_vecNode.size(), [&](ChunkedTextWriter::Buffer& buff, int64_t first, int64_t last) {
+            auto out = fmt::appender(buff);
+            for (int64_t i = first; i < last; ++i) {
+                const Vertex& node = m_vecNode[i];
+                fmt::format_to(out, "{:g} {:g} {:g}", node.x, node.y, node.z);
+                if (m_params.writeColors) {
+                    const Color& c = m_vecNodeColor[i];
+                    fmt::format_to(out, " {} {} {}", int(c.red), int(c.green), int(c.blue));
+                }
+
+                buff.push_back('\n');
+            }
+        });
+        if (!okVertices)
+            return progress->isAbortRequested(); // Abort isn't an error, only stream failure is
+
+        iElement = int(m_vecNode.size());
+        const bool okFaces = writer.writeItems(m_vecFace.size(), [&](ChunkedTextWriter::Buffer& buff, int64_t first, int64_t last) {
+            auto out = fmt::appender(buff);
+            for (int64_t i = first; i < last; ++i) {
+                const Face& face = m_vecFace[i];
+                fmt::format_to(out, "3 {} {} {}\n", face.v1, face.v2, face.v3);
+            }
+        });
+        return okFaces || progress->isAbortRequested();
+    }
+
     // Write vertices
     for (const Vertex& node : m_vecNode) {
         const auto inode = &node - &m_vecNode.front();
-        if (isBinary) {
-            fstr.write(reinterpret_cast<const char*>(&node.x), 12);
-            if (m_params.writeColors)
-                fstr.write(reinterpret_cast<const char*>(&m_vecNodeColor.at(inode).red), 3);
-        }
-        else {
-            fstr << node.x << " " << node.y << " " << node.z;
-            if (m_params.writeColors) {
-                const Color& c = m_vecNodeColor.at(inode);
-                fstr << " " << int(c.red) << " " << int(c.green) << " " << int(c.blue);
-            }
-
-            fstr << "\n";
-        }
+        fstr.write(reinterpret_cast<const char*>(&node.x), 12);
+        if (m_params.writeColors)
+            fstr.write(reinterpret_cast<const char*>(&m_vecNodeColor.at(inode).red), 3);
 
         if (!fnUpdateProgress())
             return true;
@@ -225,15 +254,9 @@ bool PlyWriter::writeFile(const FilePath& filepath, TaskProgress* progress)
     fstr.flush();
     // Write face indices
     for (const Face& face : m_vecFace) {
-        if (isBinary) {
-            const uint8_t indexCount = 3;
-            fstr.write(reinterpret_cast<const char*>(&indexCount), 1);
-            fstr.write(reinterpret_cast<const char*>(&face.v1), 12);
-        }
-        else {
-            fstr << "3 " << face.v1 << " " << face.v2 << " " << face.v3 << "\n";
-        }
-
+        const uint8_t indexCount = 3;
+        fstr.write(reinterpret_cast<const char*>(&indexCount), 1);
+        fstr.write(reinterpret_cast<const char*>(&face.v1), 12);
         if (!fnUpdateProgress())
             return true;
     }
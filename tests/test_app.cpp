@@ -13,12 +13,17 @@
 
 #include "../src/app/app_module.h"
 #include "../src/app/document_files_watcher.h"
+#include "../src/app/model_tree_item_model.h"
 #include "../src/app/qstring_utils.h"
 #include "../src/app/qtgui_utils.h"
 #include "../src/app/recent_files.h"
 #include "../src/app/theme.h"
+#include "../src/app/widget_model_tree_builder.h"
+#include "../src/base/application_item_selection_model.h"
 #include "../src/base/application.h"
 #include "../src/base/document.h"
+#include "../src/gui/gui_application.h"
+#include "../src/gui/gui_document.h"
 #include "../src/qtcommon/filepath_conv.h"
 #include "../src/qtcommon/qstring_conv.h"
 #include "../src/qtcommon/qtcore_utils.h"
@@ -31,8 +36,13 @@
 #include <QtGui/QPainter>
 #include <QtGui/QPixmap>
 #include <QtWidgets/QWidget>
+#include <QtTest/QAbstractItemModelTester>
 #include <QtTest/QSignalSpy>
 
+#include <BRepPrimAPI_MakeBox.hxx>
+#include <XCAFDoc_ShapeTool.hxx>
+#include <gsl/util>
+
 namespace Mayo {
 
 namespace {
@@ -64,6 +74,27 @@ RecentFile createRecentFile(const QPixmap& thumbnail)
     return rf;
 }
 
+// Adds in 'doc' an assembly made of 'instanceCount' instances of the same box
+TDF_Label addBoxAssembly(const DocumentPtr& doc, int instanceCount)
+{
+    const OccHandle<XCAFDoc_ShapeTool> shapeTool = doc->xcaf().shapeTool();
+    const TDF_Label labelBox = shapeTool->AddShape(BRepPrimAPI_MakeBox(10, 10, 10), false);
+    const TDF_Label labelAsm = shapeTool->NewShape();
+    for (int i = 0; i < instanceCount; ++i) {
+        gp_Trsf trsf;
+        trsf.SetTranslation(gp_Vec(i * 20., 0, 0));
+        shapeTool->AddComponent(labelAsm, labelBox, TopLoc_Location(trsf));
+    }
+
+    return labelAsm;
+}
+
+// Model tree builder not depending on the application theme(not created by unit tests)
+class TestModelTreeBuilder : public WidgetModelTreeBuilder {
+public:
+    QIcon itemIcon(const DocumentPtr&) const override { return {}; }
+};
+
 } // namespace
 
 void TestApp::DocumentFilesWatcher_test()
@@ -298,4 +329,149 @@ void TestApp::QtGuiUtils_test()
     QCOMPARE(QtGuiUtils::toQColor(occColorA), qtColorA);
 }
 
+void TestApp::GuiDocument_nodesVisible_test()
+{
+    auto app = makeOccHandle<Application>();
+    GuiApplication guiApp(app);
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    doc->addEntityTreeNode(addBoxAssembly(doc, 3));
+    GuiDocument* guiDoc = guiApp.findGuiDocument(doc);
+    QVERIFY(guiDoc != nullptr);
+
+    const TreeNodeId entityId = doc->entityTreeNodeId(0);
+    std::vector<TreeNodeId> vecRefId;
+    visitDirectChildren(entityId, doc->modelTree(), [&](TreeNodeId id) { vecRefId.push_back(id); });
+    QCOMPARE(vecRefId.size(), size_t(3));
+    const Span<const TreeNodeId> spanRefId = vecRefId;
+    QCOMPARE(guiDoc->nodeVisibleState(entityId), CheckState::On);
+
+    int signalCount = 0;
+    guiDoc->signalNodesVisibilityChanged.connectSlot([&](const GuiDocument::MapVisibilityByTreeNodeId&) {
+        ++signalCount;
+    });
+
+    // Hide one child, the parent becomes partially visible
+    guiDoc->setNodesVisible(spanRefId.subspan(0, 1), false);
+    QCOMPARE(signalCount, 1);
+    QCOMPARE(guiDoc->nodeVisibleState(vecRefId.at(0)), CheckState::Off);
+    QCOMPARE(guiDoc->nodeVisibleState(vecRefId.at(1)), CheckState::On);
+    QCOMPARE(guiDoc->nodeVisibleState(vecRefId.at(2)), CheckState::On);
+    QCOMPARE(guiDoc->nodeVisibleState(entityId), CheckState::Partially);
+
+    // Hide the other children with a single call, the parent becomes hidden
+    guiDoc->setNodesVisible(spanRefId.subspan(1), false);
+    QCOMPARE(signalCount, 2);
+    QCOMPARE(guiDoc->nodeVisibleState(vecRefId.at(1)), CheckState::Off);
+    QCOMPARE(guiDoc->nodeVisibleState(vecRefId.at(2)), CheckState::Off);
+    QCOMPARE(guiDoc->nodeVisibleState(entityId), CheckState::Off);
+
+    // Visible states are unchanged, no notification
+    guiDoc->setNodesVisible(spanRefId, false);
+    QCOMPARE(signalCount, 2);
+
+    // Show back one child, the parent is partially visible again
+    guiDoc->setNodesVisible(spanRefId.subspan(2, 1), true);
+    QCOMPARE(signalCount, 3);
+    QCOMPARE(guiDoc->nodeVisibleState(entityId), CheckState::Partially);
+
+    // Show a parent and one of its children in the same call, all nodes become visible
+    const TreeNodeId arrayNodeId[] = { vecRefId.at(0), entityId };
+    guiDoc->setNodesVisible(arrayNodeId, true);
+    QCOMPARE(signalCount, 4);
+    QCOMPARE(guiDoc->nodeVisibleState(entityId), CheckState::On);
+    for (TreeNodeId refId : vecRefId)
+        QCOMPARE(guiDoc->nodeVisibleState(refId), CheckState::On);
+}
+
+void TestApp::ModelTreeItemModel_test()
+{
+    auto app = makeOccHandle<Application>();
+    GuiApplication guiApp(app);
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    doc->addEntityTreeNode(addBoxAssembly(doc, 3));
+    const TreeNodeId entityId = doc->entityTreeNodeId(0);
+    GuiDocument* guiDoc = guiApp.findGuiDocument(doc);
+    QVERIFY(guiDoc != nullptr);
+
+    TestModelTreeBuilder builder;
+    ModelTreeItemModel model;
+    model.setGuiApplication(&guiApp);
+    model.setBuilders({ &builder });
+    builder.setItemModel(&model);
+    int visibilitySignalCount = 0;
+    guiDoc->signalNodesVisibilityChanged.connectSlot([&](const GuiDocument::MapVisibilityByTreeNodeId& mapNodeId) {
+        ++visibilitySignalCount;
+        model.refreshItemCheckStates(doc, mapNodeId);
+    });
+
+    model.appendDocument(doc);
+    model.appendEntity(doc, entityId);
+
+    // Row counts before and after fetchMore()
+    QCOMPARE(model.rowCount(), 1);
+    const QModelIndex indexDoc = model.index(0, 0);
+    QCOMPARE(model.rowCount(indexDoc), 1);
+    const QModelIndex indexEntity = model.index(0, 0, indexDoc);
+    QVERIFY(model.hasChildren(indexEntity));
+    QVERIFY(model.canFetchMore(indexEntity));
+    QCOMPARE(model.rowCount(indexEntity), 0);
+    model.fetchMore(indexEntity);
+    QVERIFY(!model.canFetchMore(indexEntity));
+    QCOMPARE(model.rowCount(indexEntity), 3);
+
+    // Parent/index round-trips
+    QCOMPARE(model.parent(indexDoc), QModelIndex());
+    QCOMPARE(model.parent(indexEntity), indexDoc);
+    QCOMPARE(model.indexOf(ApplicationItem(doc)), indexDoc);
+    QCOMPARE(model.indexOf(ApplicationItem(DocumentTreeNode(doc, entityId))), indexEntity);
+    QCOMPARE(model.data(indexEntity, ModelTreeItemModel::ItemTypeRole).toInt(), int(ModelTreeItemModel::ItemType_DocumentEntity));
+    std::vector<QModelIndex> vecIndexRef;
+    for (int row = 0; row < model.rowCount(indexEntity); ++row) {
+        const QModelIndex indexRef = model.index(row, 0, indexEntity);
+        QCOMPARE(model.parent(indexRef), indexEntity);
+        QCOMPARE(model.index(indexRef.row(), indexRef.column(), model.parent(indexRef)), indexRef);
+        const ApplicationItem appItem = model.applicationItem(indexRef);
+        QVERIFY(appItem.isDocumentTreeNode());
+        QCOMPARE(doc->modelTree().nodeParent(appItem.documentTreeNode().id()), entityId);
+        QCOMPARE(model.indexOf(appItem), indexRef);
+        vecIndexRef.push_back(indexRef);
+    }
+
+    // Consistency checks of the whole model, remaining items are fetched by the tester
+    QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+
+    // setData() on check state
+    QSignalSpy spyDataChanged(&model, &QAbstractItemModel::dataChanged);
+    QVERIFY(!model.setData(indexDoc, Qt::Unchecked, Qt::CheckStateRole));
+    QVERIFY(!model.setData(vecIndexRef.at(0), Qt::PartiallyChecked, Qt::CheckStateRole));
+    QVERIFY(!model.setData(vecIndexRef.at(0), Qt::Unchecked, Qt::DisplayRole));
+    QCOMPARE(spyDataChanged.count(), 0);
+    QVERIFY(model.setData(vecIndexRef.at(0), Qt::Unchecked, Qt::CheckStateRole));
+    QCOMPARE(visibilitySignalCount, 1);
+    QVERIFY(spyDataChanged.count() >= 2); // At least reference and entity items
+    QCOMPARE(model.data(vecIndexRef.at(0), Qt::CheckStateRole).toInt(), int(Qt::Unchecked));
+    QCOMPARE(model.data(vecIndexRef.at(1), Qt::CheckStateRole).toInt(), int(Qt::Checked));
+    QCOMPARE(model.data(indexEntity, Qt::CheckStateRole).toInt(), int(Qt::PartiallyChecked));
+
+    // Check state change of a selected item applies to all the selected items
+    const ApplicationItem arraySelectedItem[] = {
+        model.applicationItem(vecIndexRef.at(1)), model.applicationItem(vecIndexRef.at(2))
+    };
+    guiApp.selectionModel()->add(arraySelectedItem);
+    QVERIFY(model.setData(vecIndexRef.at(1), Qt::Unchecked, Qt::CheckStateRole));
+    QCOMPARE(visibilitySignalCount, 2);
+    QCOMPARE(model.data(vecIndexRef.at(2), Qt::CheckStateRole).toInt(), int(Qt::Unchecked));
+    QCOMPARE(model.data(indexEntity, Qt::CheckStateRole).toInt(), int(Qt::Unchecked));
+    guiApp.selectionModel()->clear();
+
+    // Removal of items
+    model.removeEntity(doc, entityId);
+    QCOMPARE(model.rowCount(indexDoc), 0);
+    QVERIFY(!model.indexOf(ApplicationItem(DocumentTreeNode(doc, entityId))).isValid());
+    model.removeDocument(doc);
+    QCOMPARE(model.rowCount(), 0);
+}
+
 } // namespace Mayo
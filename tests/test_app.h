@@ -31,6 +31,9 @@ private slots:
     void StringConv_test();
 
     void QtGuiUtils_test();
+
+    void GuiDocument_nodesVisible_test();
+    void ModelTreeItemModel_test();
 };
 
 } // namespace Mayo
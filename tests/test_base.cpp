@@ -12,9 +12,12 @@
 #include "test_base.h"
 
 #include "../src/base/application.h"
+#include "../src/base/application_item_selection_model.h"
+#include "../src/base/brep_mesh_cache.h"
 #include "../src/base/brep_utils.h"
 #include "../src/base/caf_utils.h"
 #include "../src/base/cpp_utils.h"
+#include "../src/base/document.h"
 #include "../src/base/enumeration.h"
 #include "../src/base/enumeration_fromenum.h"
 #include "../src/base/filepath.h"
@@ -32,7 +35,9 @@
 #include "../src/base/settings.h"
 #include "../src/base/string_conv.h"
 #include "../src/base/task_manager.h"
+#include "../src/base/task_thread_pool.h"
 #include "../src/base/tkernel_utils.h"
+#include "../src/base/triangulation_annex_data.h"
 #include "../src/base/unit.h"
 #include "../src/base/unit_system.h"
 #include "../src/io_dxf/io_dxf.h"
@@ -52,6 +57,8 @@
 #include <Interface_Static.hxx>
 #include <NCollection_String.hxx>
 #include <TopAbs_ShapeEnum.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
 
 #include <QtCore/QtDebug>
 #include <QtCore/QFile>
@@ -60,6 +67,7 @@
 #include <gsl/util>
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <clocale>
 #include <cmath>
 #include <climits>
@@ -69,6 +77,7 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <variant>
@@ -268,6 +277,147 @@ void TestBase::DocumentRefCount_test()
     QCOMPARE(doc->GetRefCount(), 1);
 }
 
+void TestBase::DocumentLazyModelTree_test()
+{
+    auto app = makeOccHandle<Application>();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+
+    // Assembly made of 3 instances of the same box
+    const OccHandle<XCAFDoc_ShapeTool> shapeTool = doc->xcaf().shapeTool();
+    const TDF_Label labelBox = shapeTool->AddShape(BRepPrimAPI_MakeBox(10, 10, 10), false);
+    const TDF_Label labelAsm = shapeTool->NewShape();
+    for (int i = 0; i < 3; ++i) {
+        gp_Trsf trsf;
+        trsf.SetTranslation(gp_Vec(i * 20., 0, 0));
+        shapeTool->AddComponent(labelAsm, labelBox, TopLoc_Location(trsf));
+    }
+
+    doc->addEntityTreeNode(labelAsm);
+    QCOMPARE(doc->entityCount(), 1);
+    doc->addEntityTreeNodeSequence(CafUtils::makeLabelSequence({ labelAsm }));
+    QCOMPARE(doc->entityCount(), 1); // Already an entity
+    auto fnNodeCount = [&]{
+        int count = 0;
+        traverseTree(doc->modelTree(), [&](TreeNodeId) { ++count; });
+        return count;
+    };
+
+    // Instances are not expanded
+    const TreeNodeId entityId = doc->entityTreeNodeId(0);
+    QCOMPARE(fnNodeCount(), 4);
+    const TreeNodeId firstRefId = doc->modelTree().nodeChildFirst(entityId);
+    QVERIFY(XCaf::isShapeReference(doc->modelTree().nodeData(firstRefId)));
+    QVERIFY(doc->isModelTreeNodeCollapsed(firstRefId));
+    QVERIFY(!DocumentTreeNode(doc, firstRefId).isLeaf());
+
+    // Expand single instance
+    std::vector<TreeNodeId> vecExpandedNodeId;
+    doc->signalModelTreeNodeExpanded.connectSlot([&](TreeNodeId id) { vecExpandedNodeId.push_back(id); });
+    doc->expandModelTreeNode(firstRefId);
+    QCOMPARE(fnNodeCount(), 5);
+    QCOMPARE(vecExpandedNodeId, std::vector<TreeNodeId>{ firstRefId });
+    QVERIFY(!doc->isModelTreeNodeCollapsed(firstRefId));
+    QCOMPARE(doc->modelTree().nodeData(doc->modelTree().nodeChildFirst(firstRefId)), labelBox);
+    doc->expandModelTreeNode(firstRefId);
+    QCOMPARE(fnNodeCount(), 5);
+    QCOMPARE(vecExpandedNodeId.size(), size_t(1)); // Already expanded, no signal
+
+    // Expand all
+    doc->deepExpandModelTree();
+    QCOMPARE(fnNodeCount(), 7);
+    QCOMPARE(vecExpandedNodeId.size(), size_t(3));
+    traverseTree(doc->modelTree(), [&](TreeNodeId id) {
+        QVERIFY(!doc->isModelTreeNodeCollapsed(id));
+    });
+
+    // Absolute locations of the box instances
+    int instanceIndex = 0;
+    visitDirectChildren(entityId, doc->modelTree(), [&](TreeNodeId refId) {
+        const TreeNodeId boxId = doc->modelTree().nodeChildFirst(refId);
+        const gp_XYZ pos = doc->modelTreeNodeAbsoluteLocation(boxId).Transformation().TranslationPart();
+        QCOMPARE(pos.X(), instanceIndex * 20.);
+        ++instanceIndex;
+    });
+    QCOMPARE(instanceIndex, 3);
+
+    // Destroying the assembly leaves deleted slots, tree gets compacted only on explicit request
+    doc->addEntityTreeNode(labelBox);
+    SignalEmitSpy spyCompacted(&doc->signalModelTreeCompacted);
+    doc->destroyEntity(entityId);
+    QCOMPARE(spyCompacted.count, 0);
+    QVERIFY(doc->modelTree().deletedNodeCount() > 0);
+    doc->compactModelTree();
+    QCOMPARE(spyCompacted.count, 1);
+    QCOMPARE(doc->entityCount(), 1);
+    QCOMPARE(doc->modelTree().lastNodeId(), TreeNodeId(1));
+    QCOMPARE(doc->modelTree().deletedNodeCount(), size_t(0));
+    QCOMPARE(doc->entityLabel(0), labelBox);
+}
+
+void TestBase::ApplicationItemSelectionModel_test()
+{
+    auto app = makeOccHandle<Application>();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    std::vector<ApplicationItem> vecItem;
+    for (TreeNodeId id = 1; id <= 100; ++id)
+        vecItem.push_back(DocumentTreeNode(doc, id));
+
+    ApplicationItemSelectionModel selectionModel;
+    SignalEmitSpy spyChanged(&selectionModel.signalChanged);
+
+    // Bulk add emits a single signal, duplicates are ignored
+    selectionModel.add(vecItem);
+    selectionModel.add(vecItem);
+    QCOMPARE(spyChanged.count, 1);
+    QCOMPARE(selectionModel.selectedItems().size(), vecItem.size());
+    QVERIFY(selectionModel.isSelected(vecItem.front()));
+    QVERIFY(selectionModel.isSelected(ApplicationItem(DocumentTreeNode(doc, 50))));
+    QVERIFY(!selectionModel.isSelected(ApplicationItem(DocumentTreeNode(doc, 101))));
+    QVERIFY(!selectionModel.isSelected(ApplicationItem(doc)));
+
+    // Bulk remove keeps insertion order of the remaining items
+    const std::vector<ApplicationItem> vecEvenItem = { vecItem.at(1), vecItem.at(3), vecItem.at(5) };
+    selectionModel.remove(vecEvenItem);
+    QCOMPARE(spyChanged.count, 2);
+    QCOMPARE(selectionModel.selectedItems().size(), vecItem.size() - 3);
+    QVERIFY(!selectionModel.isSelected(vecItem.at(3)));
+    QVERIFY(selectionModel.selectedItems()[0] == vecItem.at(0));
+    QVERIFY(selectionModel.selectedItems()[1] == vecItem.at(2));
+    QVERIFY(selectionModel.selectedItems()[2] == vecItem.at(4));
+
+    // Replace emits a single signal with both added and removed items
+    selectionModel.replace(vecEvenItem);
+    QCOMPARE(spyChanged.count, 3);
+    QCOMPARE(selectionModel.selectedItems().size(), vecEvenItem.size());
+    for (const ApplicationItem& item : vecEvenItem)
+        QVERIFY(selectionModel.isSelected(item));
+
+    QVERIFY(!selectionModel.isSelected(vecItem.at(0)));
+
+    selectionModel.change({ &vecItem.at(0), 1 }, { &vecItem.at(1), 1 });
+    QCOMPARE(spyChanged.count, 4);
+    QVERIFY(selectionModel.isSelected(vecItem.at(0)));
+    QVERIFY(!selectionModel.isSelected(vecItem.at(1)));
+
+    // Remap changes identifiers without signal, items remapped to invalid ones are dropped
+    selectionModel.remap([&](const ApplicationItem& item) {
+        const TreeNodeId id = item.documentTreeNode().id();
+        return id == 1 ? ApplicationItem() : ApplicationItem(DocumentTreeNode(doc, id + 1000));
+    });
+    QCOMPARE(spyChanged.count, 4);
+    QCOMPARE(selectionModel.selectedItems().size(), size_t(2));
+    QVERIFY(selectionModel.isSelected(DocumentTreeNode(doc, 1004)));
+    QVERIFY(selectionModel.isSelected(DocumentTreeNode(doc, 1006)));
+    QVERIFY(!selectionModel.isSelected(vecItem.at(3)));
+
+    selectionModel.clear();
+    QCOMPARE(spyChanged.count, 5);
+    QVERIFY(selectionModel.selectedItems().empty());
+    QVERIFY(!selectionModel.isSelected(vecItem.at(0)));
+}
+
 void TestBase::CppUtils_toggle_test()
 {
     bool v = false;
@@ -725,6 +875,134 @@ void TestBase::IO_bugGitHub258_test()
     QCOMPARE(triangulation->NbTriangles(), 12);
 }
 
+void TestBase::IO_dxfBlockText_test()
+{
+    // TEXT entities within block definitions must be built while parsing, as blocks are instantiated
+    // by INSERT entities before deferred shapes are built
+    auto app = makeOccHandle<Application>();
+    DocumentPtr doc = app->newDocument();
+    const bool okImport = m_ioSystem->importInDocument()
+                              .targetDocument(doc)
+                              .withFilepath("tests/inputs/block_text.dxf")
+                              .execute();
+    QVERIFY(okImport);
+    QVERIFY(doc->entityCount() > 0);
+
+    // Glyphs of texts are faces. Text outside of the block is located far from the inserts
+    int blockTextFaceCount = 0;
+    int layerTextFaceCount = 0;
+    for (int i = 0; i < doc->entityCount(); ++i) {
+        const TopoDS_Shape shape = doc->xcaf().shape(doc->entityLabel(i));
+        for (TopExp_Explorer expl(shape, TopAbs_FACE); expl.More(); expl.Next()) {
+            const TopExp_Explorer explVertex(expl.Current(), TopAbs_VERTEX);
+            if (!explVertex.More())
+                continue;
+
+            const gp_Pnt pnt = BRep_Tool::Pnt(TopoDS::Vertex(explVertex.Current()));
+            if (pnt.X() < 50.)
+                ++blockTextFaceCount;
+            else
+                ++layerTextFaceCount;
+        }
+    }
+
+    QVERIFY(blockTextFaceCount > 0);
+    QVERIFY(layerTextFaceCount > 0);
+}
+
+void TestBase::IO_multiFileImportSingleThreadPool_test()
+{
+    // Multi-file import run from a task must not stall when the pool has a single thread: stages
+    // of the import pipeline are then executed by the importing thread itself
+    TaskThreadPool pool(1);
+    TaskManager taskMgr(&pool);
+    const std::vector<FilePath> vecFilepath = {
+        "tests/inputs/cube.stla", "tests/inputs/cube.ply", "tests/inputs/cube.off", "tests/inputs/cube.step"
+    };
+    auto app = makeOccHandle<Application>();
+    DocumentPtr doc = app->newDocument();
+    std::atomic<int> postProcessCount = 0;
+    bool okImport = false;
+    const TaskId taskId = taskMgr.newTask([&](TaskProgress* progress) {
+        okImport = m_ioSystem->importInDocument()
+                .targetDocument(doc)
+                .withFilepaths(vecFilepath)
+                .withEntityPostProcess([&](TDF_Label, const FilePath&, TaskProgress*) { ++postProcessCount; })
+                .withEntityPostProcessRequiredIf([](IO::Format) { return true; })
+                .withTaskProgress(progress)
+                .withThreadPool(&pool)
+                .execute();
+    });
+
+    taskMgr.run(taskId, TaskAutoDestroy::Off);
+    QVERIFY(taskMgr.waitForDone(taskId, 30000));
+    QVERIFY(okImport);
+    QCOMPARE(doc->entityCount(), int(vecFilepath.size()));
+    QCOMPARE(postProcessCount.load(), int(vecFilepath.size()));
+}
+
+void TestBase::IO_exportCollapsedModelTree_test()
+{
+    auto app = makeOccHandle<Application>();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+
+    // Assembly made of 2 instances of the same box, instances are not expanded
+    const OccHandle<XCAFDoc_ShapeTool> shapeTool = doc->xcaf().shapeTool();
+    const TDF_Label labelBox = shapeTool->AddShape(BRepPrimAPI_MakeBox(10, 10, 10), false);
+    const TDF_Label labelAsm = shapeTool->NewShape();
+    gp_Trsf trsf;
+    shapeTool->AddComponent(labelAsm, labelBox, TopLoc_Location(trsf));
+    trsf.SetTranslation(gp_Vec(20., 0, 0));
+    shapeTool->AddComponent(labelAsm, labelBox, TopLoc_Location(trsf));
+    doc->addEntityTreeNode(labelAsm);
+    const ApplicationItem docItem(doc);
+    QVERIFY(!IO::System::isDeepExpanded(Span<const ApplicationItem>(&docItem, 1)));
+
+    // Writers relying on the model tree must fail instead of skipping collapsed instances
+    auto fnExport = [&](const FilePath& filepath, IO::Format format) {
+        return m_ioSystem->exportApplicationItems()
+                .targetFile(filepath)
+                .targetFormat(format)
+                .withItem(doc)
+                .execute();
+    };
+    QVERIFY(!fnExport("tests/outputs/collapsed_assembly.off", IO::Format_OFF));
+    QVERIFY(!fnExport("tests/outputs/collapsed_assembly.ply", IO::Format_PLY));
+
+    IO::System::deepExpandItems(Span<const ApplicationItem>(&docItem, 1));
+    QVERIFY(IO::System::isDeepExpanded(Span<const ApplicationItem>(&docItem, 1)));
+    QVERIFY(fnExport("tests/outputs/collapsed_assembly.off", IO::Format_OFF));
+    QVERIFY(fnExport("tests/outputs/collapsed_assembly.ply", IO::Format_PLY));
+}
+
+void TestBase::IO_concurrentStepImport_benchmark()
+{
+    QFETCH(int, fileCount);
+
+    // Import the same STEP file 'fileCount' times, STEP parsing of the files should scale with
+    // count of threads
+    const std::vector<FilePath> vecFilepath(fileCount, "tests/inputs/cube.step");
+    auto app = makeOccHandle<Application>();
+    QBENCHMARK {
+        DocumentPtr doc = app->newDocument();
+        const bool okImport = m_ioSystem->importInDocument()
+                .targetDocument(doc)
+                .withFilepaths(vecFilepath)
+                .execute();
+        QVERIFY(okImport);
+        QCOMPARE(doc->entityCount(), fileCount);
+        app->closeDocument(doc);
+    }
+}
+
+void TestBase::IO_concurrentStepImport_benchmark_data()
+{
+    QTest::addColumn<int>("fileCount");
+    for (int count : { 1, 2, 4, 8, 16 })
+        QTest::newRow(std::to_string(count).c_str()) << count;
+}
+
 void TestBase::DoubleToString_test()
 {
     const std::locale frLocale = getFrLocale();
@@ -777,6 +1055,64 @@ void TestBase::BRepUtils_test()
     }
 }
 
+void TestBase::BRepMeshCache_test()
+{
+    const FilePath dirCache = std_filesystem::temp_directory_path() / "mayo_test_brep_mesh_cache";
+    std_filesystem::remove_all(dirCache);
+    auto _ = gsl::finally([=]{ std_filesystem::remove_all(dirCache); });
+
+    const FilePath sourceFilepath = "tests/inputs/cube.step";
+    OccBRepMeshParameters params;
+    params.Deflection = 0.1;
+    params.Angle = 0.5;
+
+    BRepMeshCache cache(dirCache);
+    const TopoDS_Shape shapeMeshed = BRepPrimAPI_MakeBox(25, 25, 25);
+    BRepMesh_IncrementalMesh mesher(shapeMeshed, params.Deflection, false, params.Angle);
+    const std::string key = BRepMeshCache::key(sourceFilepath, params, shapeMeshed);
+    QVERIFY(!key.empty());
+    QVERIFY(cache.store(key, shapeMeshed));
+
+    // Identical shape from same file and parameters gets its faces triangulated from cache
+    const TopoDS_Shape shapeRestored = BRepPrimAPI_MakeBox(25, 25, 25);
+    QCOMPARE(BRepMeshCache::key(sourceFilepath, params, shapeRestored), key);
+    QVERIFY(cache.restore(key, shapeRestored));
+    int faceCount = 0;
+    for (TopExp_Explorer expMeshed(shapeMeshed, TopAbs_FACE), expRestored(shapeRestored, TopAbs_FACE);
+         expMeshed.More() && expRestored.More();
+         expMeshed.Next(), expRestored.Next())
+    {
+        TopLoc_Location loc;
+        const auto triMeshed = BRep_Tool::Triangulation(TopoDS::Face(expMeshed.Current()), loc);
+        const auto triRestored = BRep_Tool::Triangulation(TopoDS::Face(expRestored.Current()), loc);
+        QVERIFY(!triMeshed.IsNull());
+        QVERIFY(!triRestored.IsNull());
+        QCOMPARE(triRestored->NbNodes(), triMeshed->NbNodes());
+        QCOMPARE(triRestored->NbTriangles(), triMeshed->NbTriangles());
+        // Edges get their polygons on the restored triangulation
+        for (TopExp_Explorer expEdge(expRestored.Current(), TopAbs_EDGE); expEdge.More(); expEdge.Next()) {
+            const TopoDS_Edge& edge = TopoDS::Edge(expEdge.Current());
+            QVERIFY(!BRep_Tool::PolygonOnTriangulation(edge, triRestored, loc).IsNull());
+        }
+
+        ++faceCount;
+    }
+
+    QCOMPARE(faceCount, 6);
+
+    // Key depends on mesh parameters and on the shape
+    OccBRepMeshParameters paramsOther = params;
+    paramsOther.Deflection = 0.2;
+    QVERIFY(BRepMeshCache::key(sourceFilepath, paramsOther, shapeMeshed) != key);
+    QVERIFY(BRepMeshCache::key(sourceFilepath, params, BRepPrimAPI_MakeBox(40, 40, 40)) != key);
+    QVERIFY(!cache.restore(BRepMeshCache::key(sourceFilepath, paramsOther, shapeMeshed), shapeMeshed));
+
+    // Eviction honors maximum size
+    cache.setMaxSize(0);
+    cache.evict();
+    QVERIFY(!cache.restore(key, BRepPrimAPI_MakeBox(25, 25, 25)));
+}
+
 void TestBase::CafUtils_test()
 {
     // TODO Add CafUtils::labelTag() test for multi-threaded safety
@@ -965,6 +1301,40 @@ void TestBase::MeshUtils_test()
              double(boxDx * boxDy * boxDz));
     QCOMPARE(MeshUtils::triangulationArea(polyTriBox),
              double(2 * boxDx * boxDy + 2 * boxDy * boxDz + 2 * boxDx * boxDz));
+
+    // Fused metrics
+    auto fnFuzzyEqual = [](double lhs, double rhs) {
+        return std::abs(lhs - rhs) <= 1e-9 * std::max({ 1., std::abs(lhs), std::abs(rhs) });
+    };
+    const double boxVolume = boxDx * boxDy * boxDz;
+    const MeshUtils::TriangulationMetrics metrics = MeshUtils::triangulationMetrics(polyTriBox);
+    QVERIFY(fnFuzzyEqual(std::abs(metrics.signedVolume), boxVolume));
+    QVERIFY(fnFuzzyEqual(metrics.centroid.X(), boxDx / 2.));
+    QVERIFY(fnFuzzyEqual(metrics.centroid.Y(), boxDy / 2.));
+    QVERIFY(fnFuzzyEqual(metrics.centroid.Z(), boxDz / 2.));
+    QVERIFY(fnFuzzyEqual(metrics.inertia.Value(1, 1), boxVolume * (boxDy * boxDy + boxDz * boxDz) / 12.));
+    QVERIFY(fnFuzzyEqual(metrics.inertia.Value(2, 2), boxVolume * (boxDx * boxDx + boxDz * boxDz) / 12.));
+    QVERIFY(fnFuzzyEqual(metrics.inertia.Value(3, 3), boxVolume * (boxDx * boxDx + boxDy * boxDy) / 12.));
+    QVERIFY(std::abs(metrics.inertia.Value(1, 2)) <= 1e-9 * metrics.inertia.Value(1, 1));
+    QVERIFY(!metrics.boundingBox.IsVoid());
+    QVERIFY(fnFuzzyEqual(metrics.boundingBox.CornerMax().X(), boxDx));
+    QVERIFY(fnFuzzyEqual(metrics.boundingBox.CornerMax().Z(), boxDz));
+
+    // Metrics cached by TriangulationAnnexData, which holds the cached triangulation
+    auto app = makeOccHandle<Application>();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    const TriangulationAnnexDataPtr annexData = TriangulationAnnexData::Set(doc->newEntityLabel());
+    const int refCount = polyTriBox->GetRefCount();
+    QCOMPARE(annexData->triangulationMetrics(polyTriBox).area, metrics.area);
+    QCOMPARE(annexData->triangulationMetrics(polyTriBox).signedVolume, metrics.signedVolume);
+    QCOMPARE(polyTriBox->GetRefCount(), refCount + 1);
+
+    // Another triangulation replaces the cached one
+    auto polyTriCopy = makeOccHandle<Poly_Triangulation>(polyTriBox);
+    QCOMPARE(annexData->triangulationMetrics(polyTriCopy).area, metrics.area);
+    QCOMPARE(polyTriBox->GetRefCount(), refCount);
+    QCOMPARE(polyTriCopy->GetRefCount(), 2);
 }
 
 void TestBase::MeshUtils_test_data()
@@ -1205,6 +1575,99 @@ void TestBase::LibTask_test()
     QCOMPARE(vecProgressRec.back().value, 100);
 }
 
+void TestBase::LibTask_threadPool_test()
+{
+    // Nested tasks waiting for each other must not deadlock even if the pool has a single thread
+    TaskThreadPool pool(1);
+    QCOMPARE(pool.maxThreadCount(), 1);
+    TaskManager taskMgr(&pool);
+    std::atomic<int> subTaskDoneCount = 0;
+    const TaskId taskId = taskMgr.newTask([&](TaskProgress*) {
+        TaskManager subTaskMgr(&pool);
+        std::vector<TaskId> vecSubTaskId;
+        for (int i = 0; i < 10; ++i)
+            vecSubTaskId.push_back(subTaskMgr.newTask([&](TaskProgress*) { ++subTaskDoneCount; }));
+
+        for (TaskId subTaskId : vecSubTaskId)
+            subTaskMgr.run(subTaskId, TaskAutoDestroy::Off, TaskPriority::Background);
+
+        for (TaskId subTaskId : vecSubTaskId)
+            subTaskMgr.waitForDone(subTaskId);
+    });
+
+    taskMgr.run(taskId, TaskAutoDestroy::Off);
+    QVERIFY(taskMgr.waitForDone(taskId, 10000));
+    QCOMPARE(subTaskDoneCount.load(), 10);
+}
+
+void TestBase::LibTask_concurrentProgress_test()
+{
+    // Sub-progresses updated concurrently must sum up exactly, with throttled notifications
+    TaskManager taskMgr;
+    std::atomic<int> taskProgressValue = -1;
+    const TaskId taskId = taskMgr.newTask([&](TaskProgress* progress) {
+        constexpr int subTaskCount = 8;
+        std::vector<std::thread> vecThread;
+        for (int i = 0; i < subTaskCount; ++i) {
+            vecThread.emplace_back([=]{
+                TaskProgress subProgress(progress, 100. / subTaskCount);
+                for (int j = 0; j < 10000; ++j)
+                    subProgress.setValue(j / 100);
+            });
+        }
+
+        for (std::thread& t : vecThread)
+            t.join();
+
+        // Checked by the main thread, QtTest macros can't be used within the task
+        taskProgressValue = progress->value();
+    });
+
+    std::atomic<int> progressSignalCount = 0;
+    std::atomic<int> lastPct = -1;
+    taskMgr.signalProgressChanged.connectSlot([&](TaskId, int pct) {
+        ++progressSignalCount;
+        lastPct = pct;
+    });
+
+    taskMgr.run(taskId);
+    taskMgr.waitForDone(taskId);
+    QCOMPARE(taskProgressValue.load(), 100);
+    QCOMPARE(lastPct.load(), 100);
+    QVERIFY(progressSignalCount.load() <= 102);
+}
+
+void TestBase::LibTask_flushPendingProgress_test()
+{
+    // Last throttled progress value must be emitted even if the task doesn't progress anymore
+    TaskManager taskMgr;
+    std::atomic<bool> isValueSet = false;
+    std::atomic<bool> isFlushDone = false;
+    const TaskId taskId = taskMgr.newTask([&](TaskProgress* progress) {
+        progress->setValue(10);
+        progress->setValue(20); // Throttled
+        isValueSet = true;
+        while (!isFlushDone)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+
+    std::atomic<int> lastPct = -1;
+    taskMgr.signalProgressChanged.connectSlot([&](TaskId, int pct) { lastPct = pct; });
+    taskMgr.run(taskId, TaskAutoDestroy::Off);
+    while (!isValueSet)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    const int pctBeforeFlush = lastPct;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2 * 1000 / TaskProgress::NotifyMaxRate));
+    taskMgr.flushPendingProgress();
+    const int pctAfterFlush = lastPct;
+    isFlushDone = true;
+    taskMgr.waitForDone(taskId);
+    QCOMPARE(pctBeforeFlush, 10);
+    QCOMPARE(pctAfterFlush, 20);
+    QCOMPARE(lastPct.load(), 100);
+}
+
 void TestBase::LibTree_test()
 {
     const TreeNodeId nullptrId = 0;
@@ -1256,6 +1719,32 @@ void TestBase::LibTree_test()
         std::sort(vecTreeNodeIdVisited.begin(), vecTreeNodeIdVisited.end());
         QCOMPARE(vecTreeNodeIdVisited, vecTreeNodeId);
     }
+
+    {   // Removal, reuse of deleted slots and compaction
+        const TreeNodeId n1 = tree.appendChild(nullptrId, "1");
+        const TreeNodeId n1_1 = tree.appendChild(n1, "1-1");
+        tree.removeRoot(n0);
+        QCOMPARE(tree.nodeCount(), size_t(2));
+        QCOMPARE(tree.deletedNodeCount(), size_t(5));
+        int unorderCount = 0;
+        traverseTree_unorder(tree, [&](TreeNodeId) { ++unorderCount; });
+        QCOMPARE(unorderCount, 2);
+
+        const TreeNodeId n2 = tree.appendChild(nullptrId, "2");
+        QVERIFY(n2 <= 5); // Slot reused
+        QCOMPARE(tree.lastNodeId(), TreeNodeId(7));
+        QCOMPARE(tree.nodeData(n2), std::string("2"));
+        QVERIFY(tree.nodeIsLeaf(n2));
+
+        const std::vector<TreeNodeId> vecOldToNewId = tree.compact();
+        QCOMPARE(tree.lastNodeId(), TreeNodeId(3));
+        QCOMPARE(tree.deletedNodeCount(), size_t(0));
+        QCOMPARE(vecOldToNewId.at(n0_1), nullptrId);
+        QCOMPARE(tree.nodeParent(vecOldToNewId.at(n1_1)), vecOldToNewId.at(n1));
+        std::string strPreOrder;
+        traverseTree_preOrder(tree, [&](TreeNodeId id) { strPreOrder += " " + tree.nodeData(id); });
+        QCOMPARE(strPreOrder, " 1 1-1 2");
+    }
 }
 
 void TestBase::Span_test()
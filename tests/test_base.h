@@ -18,6 +18,8 @@ class TestBase : public QObject {
 private slots:
     void Application_test();
     void DocumentRefCount_test();
+    void DocumentLazyModelTree_test();
+    void ApplicationItemSelectionModel_test();
 
     void CppUtils_toggle_test();
     void CppUtils_safeStaticCast_test();
@@ -49,11 +51,17 @@ private slots:
     void IO_bugGitHub166_test();
     void IO_bugGitHub166_test_data();
     void IO_bugGitHub258_test();
+    void IO_dxfBlockText_test();
+    void IO_multiFileImportSingleThreadPool_test();
+    void IO_exportCollapsedModelTree_test();
+    void IO_concurrentStepImport_benchmark();
+    void IO_concurrentStepImport_benchmark_data();
 
     void DoubleToString_test();
     void StringConv_test();
 
     void BRepUtils_test();
+    void BRepMeshCache_test();
 
     void CafUtils_test();
 
@@ -78,6 +86,9 @@ private slots:
     void UnitSystem_test_data();
 
     void LibTask_test();
+    void LibTask_threadPool_test();
+    void LibTask_concurrentProgress_test();
+    void LibTask_flushPendingProgress_test();
     void LibTree_test();
 
     void Span_test();